@@ -0,0 +1,99 @@
+#include <assert.h>
+#include "animation.h"
+#include "assets.h"
+#include "renderer.h"
+#include "myc.h"
+
+//Clip definitions. Frame counts are the number of frames each animation plays, which may be
+// fewer than exist on disk (e.g. cone has 16 frames, but only loops the first 12).
+static AnimationClip clips[CLIP_COUNT] = {
+	[CLIP_MAGNET] = { "magnet", ASSET_MAGNET_01, 8 },
+	[CLIP_DISK] = { "disk", ASSET_DISK_01, 12 },
+	[CLIP_DISK_BLUE] = { "disk-blue", ASSET_DISK_BLUE_01, 12 },
+	[CLIP_VIRUS] = { "virus", ASSET_VIRUS_01, 6 },
+	[CLIP_BUG] = { "bug", ASSET_BUG_01, 6 },
+	[CLIP_CD] = { "cd", ASSET_CD_01, 4 },
+	[CLIP_CONE] = { "cone", ASSET_CONE_01, 12 },
+	[CLIP_KEYBOSS] = { "keyboss", ASSET_KEYBOSS_01, 12 },
+	[CLIP_KEYBOSS_MINI] = { "keyboss-mini", ASSET_KEYBOSS_MINI_01, 2 },
+	[CLIP_EXP] = { "exp", ASSET_EXP_01, 6 },
+
+	[CLIP_COIN] = { "coin", ASSET_COIN_01, 12 },
+	[CLIP_CHERRIES] = { "cherries", ASSET_CHERRIES_01, 2 },
+	[CLIP_GRAPE] = { "grape", ASSET_GRAPE_01, 2 },
+	[CLIP_PINEAPPLE] = { "pineapple", ASSET_PINEAPPLE_01, 2 },
+	[CLIP_POWERUP] = { "powerup", ASSET_POWERUP, 1 },
+	[CLIP_POWERUP_DOUBLE] = { "powerup-double", ASSET_POWERUP_DOUBLE_01, 2 },
+	[CLIP_POWERUP_TRIPLE] = { "powerup-triple", ASSET_POWERUP_TRIPLE_01, 2 },
+	[CLIP_POWERUP_FAN] = { "powerup-fan", ASSET_POWERUP_FAN, 1 },
+	[CLIP_BATTERY_PACK] = { "battery-pack", ASSET_BATTERY_PACK_01, 2 },
+
+	[CLIP_SHOT_NEON] = { "shot-neon", ASSET_SHOT_NEON_01, 2 },
+
+	[CLIP_MIKE] = { "mike", ASSET_MIKE_01, 8 },
+	[CLIP_MIKE_FACING] = { "mike-facing", ASSET_MIKE_FACING_01, 8 },
+	[CLIP_MIKE_LEAN_LEFT] = { "mike-lean-left", ASSET_MIKE_LEAN_LEFT_01, 8 },
+	[CLIP_MIKE_LEAN_RIGHT] = { "mike-lean-right", ASSET_MIKE_LEAN_RIGHT_01, 8 },
+	[CLIP_MIKE_SHOOT] = { "mike-shoot", ASSET_MIKE_SHOOT_01, 2 },
+	[CLIP_MIKE_SHOOT_LEFT] = { "mike-shoot-left", ASSET_MIKE_SHOOT_LEFT_01, 2 },
+	[CLIP_MIKE_SHOOT_RIGHT] = { "mike-shoot-right", ASSET_MIKE_SHOOT_RIGHT_01, 2 },
+	[CLIP_MIKE_SHADES] = { "mike-shades", ASSET_MIKE_SHADES_01, 13 },
+	[CLIP_MIKE_SHOCK] = { "mike-shock", ASSET_MIKE_SHOCK, 3 },		//mike-shock, mike-shock2, mike-shock3
+	[CLIP_SLEEP] = { "sleep", ASSET_SLEEP_01, 8 }
+};
+
+const AnimationClip *getClip(ClipId id) {
+	assert(id >= 0 && id < CLIP_COUNT);
+	return &clips[id];
+}
+
+//For clips named in data files. NULL when there's no such clip.
+const AnimationClip *findClip(const char *name) {
+	for(int i=0; i < CLIP_COUNT; i++) {
+		if(strcmp(clips[i].name, name) == 0) return &clips[i];
+	}
+	return NULL;
+}
+
+const Sprite *clipFrame(const AnimationClip *clip, int frame, AssetVersion version) {
+	assert(frame >= 1 && frame <= clip->frameCount);
+	return &clip->frames[version][frame - 1];
+}
+
+//Solid pixels of a frame (every version of it shares them).
+const Mask *clipFrameMask(const AnimationClip *clip, int frame) {
+	assert(frame >= 1 && frame <= clip->frameCount);
+	return getAssetMask(clip->firstFrame + frame - 1);
+}
+
+void shutdownAnimations() {
+	for(int i=0; i < CLIP_COUNT; i++) {
+		for(int v=0; v < ASSET_VERSIONS; v++) {
+			free(clips[i].frames[v]);
+			clips[i].frames[v] = NULL;
+		}
+	}
+}
+
+void initAnimations() {
+	for(int i=0; i < CLIP_COUNT; i++) {
+		AnimationClip *clip = &clips[i];
+		if(clip->frameCount < 1 || clip->firstFrame + clip->frameCount > ASSET_COUNT)
+			fatalError("Animation clip runs past the end of the Asset register", clip->name);
+
+		//Build every version up front, so animation and render passes only index into them.
+		for(int v=0; v < ASSET_VERSIONS; v++) {
+			clip->frames[v] = malloc(sizeof(Sprite) * clip->frameCount);
+
+			for(int f=0; f < clip->frameCount; f++) {
+				AssetHandle handle = clip->firstFrame + f;
+				if(getTextureHandle(handle, v) == NULL) {
+					Sprite none = { };
+					clip->frames[v][f] = none;
+				}else{
+					clip->frames[v][f] = makeHandleSprite(handle, v);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "assets.h"
+#include "renderer.h"
+
+typedef enum {
+	//Enemies
+	CLIP_MAGNET,
+	CLIP_DISK,
+	CLIP_DISK_BLUE,
+	CLIP_VIRUS,
+	CLIP_BUG,
+	CLIP_CD,
+	CLIP_CONE,
+	CLIP_KEYBOSS,
+	CLIP_KEYBOSS_MINI,
+	CLIP_EXP,
+
+	//Items
+	CLIP_COIN,
+	CLIP_CHERRIES,
+	CLIP_GRAPE,
+	CLIP_PINEAPPLE,
+	CLIP_POWERUP,
+	CLIP_POWERUP_DOUBLE,
+	CLIP_POWERUP_TRIPLE,
+	CLIP_POWERUP_FAN,
+	CLIP_BATTERY_PACK,
+
+	//Weapons
+	CLIP_SHOT_NEON,
+
+	//Player
+	CLIP_MIKE,
+	CLIP_MIKE_FACING,
+	CLIP_MIKE_LEAN_LEFT,
+	CLIP_MIKE_LEAN_RIGHT,
+	CLIP_MIKE_SHOOT,
+	CLIP_MIKE_SHOOT_LEFT,
+	CLIP_MIKE_SHOOT_RIGHT,
+	CLIP_MIKE_SHADES,
+	CLIP_MIKE_SHOCK,
+	CLIP_SLEEP,
+
+	CLIP_COUNT
+} ClipId;
+
+//A run of consecutive assets (e.g. disk-01.png to disk-12.png), resolved once at init into
+// ready-to-draw Sprites for every AssetVersion. Frames are numbered from 1, as the files are.
+typedef struct {
+	char* name;
+	AssetId firstFrame;
+	int frameCount;
+	Sprite *frames[ASSET_VERSIONS];		//sprite texture is NULL where the version wasn't built.
+} AnimationClip;
+
+extern const AnimationClip *getClip(ClipId id);
+extern const AnimationClip *findClip(const char *name);
+extern const Sprite *clipFrame(const AnimationClip *clip, int frame, AssetVersion version);
+extern const Mask *clipFrameMask(const AnimationClip *clip, int frame);
+extern void initAnimations();
+extern void shutdownAnimations();
+
+#endif
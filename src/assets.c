@@ -3,48 +3,123 @@
 #include "assets.h"
 #include "common.h"
 #include "renderer.h"
+#include "atlas.h"
+#include "assetsource.h"
+#include "mqpak.h"
+#include "trace.h"
 
+//An image version waiting to be packed. Only versions with pixels of their own are packed - the
+// rest are drawn from the default version's pixels (see isModulatedVersion).
 typedef struct {
-	char* filename;
-	bool makeHitVersion;
-	bool makeShadowVersion;
-	bool makeSuperVersion;
-	bool makeAlphaVersion;
-	bool isBackground;
-} AssetDef;
+	SDL_Surface *surface;
+	AssetHandle handle;
+	AssetVersion version;
+	int order;
+} AtlasEntry;
+
+//Open-addressing (linear probe) hash index from key to register position. We keep the full
+// hash alongside each slot so probing only falls back to strcmp on a genuine hash match.
+typedef struct {
+	char* key;
+	unsigned hash;
+	int value;
+} IndexSlot;
 
 typedef struct {
-	char* filename;
-	int volume;
-} SoundDef;
+	IndexSlot *slots;
+	unsigned mask;
+} AssetIndex;
 
 static char* assetPath;
 static Asset *assets;
 static int assetCount;
+static AssetIndex assetIndex;
 static SoundAsset *sounds;
 static int soundCount;
+static AssetIndex soundIndex;
 static MusicAsset *music;
 static int musicCount;
+static AssetIndex musicIndex;
 static const int MUSIC_VOLUME = 100;
+static const int ATLAS_PAGE_SIZE = 1024;
+static AtlasEntry *atlasEntries;
+static int atlasEntryCount;
+static Pak assetPak;			//mapped for as long as the sounds and music read from it.
+static AtlasPage *atlasPages;
+static int atlasPageCount;
+
+static unsigned hashKey(const char *key) {
+	//FNV-1a (32-bit).
+	unsigned hash = 2166136261u;
+	while(*key) {
+		hash ^= (unsigned char)*key++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void makeIndex(AssetIndex *index, int count) {
+	//Keep the load factor at or below 50%, so probe sequences stay short.
+	unsigned size = 16;
+	while(size < (unsigned)count * 2) size <<= 1;
+
+	index->slots = calloc(size, sizeof(IndexSlot));
+	index->mask = size - 1;
+}
+
+static void indexInsert(AssetIndex *index, char *key, int value) {
+	unsigned hash = hashKey(key);
+	unsigned i = hash & index->mask;
+
+	//Find a free slot (duplicate keys keep their first registration, as the old linear scan did).
+	while(index->slots[i].key != NULL) {
+		if(index->slots[i].hash == hash && strcmp(index->slots[i].key, key) == 0) return;
+		i = (i + 1) & index->mask;
+	}
+
+	IndexSlot slot = { key, hash, value };
+	index->slots[i] = slot;
+}
+
+static int indexFind(AssetIndex *index, const char *key) {
+	unsigned hash = hashKey(key);
+	unsigned i = hash & index->mask;
+
+	while(index->slots[i].key != NULL) {
+		if(index->slots[i].hash == hash && strcmp(index->slots[i].key, key) == 0)
+			return index->slots[i].value;
+		i = (i + 1) & index->mask;
+	}
+
+	return -1;
+}
+
+static void freeIndex(AssetIndex *index) {
+	free(index->slots);
+	index->slots = NULL;
+	index->mask = 0;
+}
 
 MusicAsset getMusic(char *path) {
-	//Loop through register until key is found, or we've exhausted the array's iteration.
-	for(int i=0; i < musicCount; i++) {
-		if(strcmp(music[i].key, path) == 0)			//if strings match.
-			return music[i];
+	int i = indexFind(&musicIndex, path);
+	if(i < 0) {
+		fatalError("Could not find Asset in register", path);
+		MusicAsset none = { };
+		return none;
 	}
 
-	fatalError("Could not find Asset in register", path);
+	return music[i];
 }
 
 SoundAsset getSound(char *path) {
-	//Loop through register until key is found, or we've exhausted the array's iteration.
-	for(int i=0; i < soundCount; i++) {
-		if(strcmp(sounds[i].key, path) == 0)			//if strings match.
-			return sounds[i];
+	int i = indexFind(&soundIndex, path);
+	if(i < 0) {
+		fatalError("Could not find Asset in register", path);
+		SoundAsset none = { };
+		return none;
 	}
 
-	fatalError("Could not find Asset in register", path);
+	return sounds[i];
 }
 
 SDL_Surface* reloadSurface(char* path) {
@@ -53,446 +128,418 @@ SDL_Surface* reloadSurface(char* path) {
     return IMG_Load(absPath);
 }
 
-static Asset makeAsset(AssetDef definition) {
-	assert(renderer != NULL);
-
-	char *absPath = combineStrings(assetPath, definition.filename);
-	//Check existence on file system.
-	if(!fileExists(absPath))
+//A whole text file from the assets folder (e.g. weapons.csv), NUL-terminated. Free it with SDL_free.
+char *loadDataFile(char *path) {
+	char *absPath = combineStrings(assetPath, path);
+	char *data = SDL_LoadFile(absPath, NULL);
+	if(data == NULL) {
 		fatalError("Could not find Asset on disk", absPath);
+		exit(1);
+	}
 
-	//Load file from disk.
-	SDL_Surface *original = IMG_Load(absPath);
-//	SDL_Surface *original = SDL_ConvertSurface(unoptimised, SDL_PIXELFORMAT_ABGR8888, 0);
 	free(absPath);
+	return data;
+}
+
+static void queueAtlasEntry(SDL_Surface *surface, AssetHandle handle, AssetVersion version) {
+	//Images arrive in whatever order the loaders finish them, so order by register position instead.
+	AtlasEntry entry = { surface, handle, version, handle * ASSET_VERSIONS + version };
+	atlasEntries[atlasEntryCount++] = entry;
+}
 
+//Versions that are the default pixels drawn differently, so need no pixels of their own.
+static bool isModulatedVersion(AssetDef definition, AssetVersion version) {
+	return
+		(version == ASSET_SHADOW && definition.makeShadowVersion) ||
+		(version == ASSET_ALPHA && definition.makeAlphaVersion);
+}
+
+static DrawState makeDrawState(int red, int green, int blue, int alpha) {
+	DrawState state = { { red, green, blue, alpha }, SDL_BLENDMODE_BLEND };
+	return state;
+}
+
+//Decoding is shared across a pool of loader threads, which post each finished image back to the
+// main thread. Texture work stays on the main thread, as the renderer isn't thread-safe.
+typedef struct {
+	const AssetDef *definitions;
+	DecodedImage *images;
+	int count;
+	SDL_atomic_t nextImage;
+	SDL_mutex *lock;
+	SDL_cond *imageReady;
+	int *readyQueue;		//room for every image, so posting never waits.
+	int readyCount;
+} ImageLoader;
+
+static const int MAX_LOADER_THREADS = 16;
+
+static double elapsedMilliseconds(Uint64 since) {
+	return (double)(SDL_GetPerformanceCounter() - since) * 1000 / SDL_GetPerformanceFrequency();
+}
+
+static int loaderThread(void *data) {
+	ImageLoader *loader = data;
+
+	int i;
+	while((i = SDL_AtomicAdd(&loader->nextImage, 1)) < loader->count) {
+		char *absPath = combineStrings(assetPath, loader->definitions[i].filename);
+		if(fileExists(absPath)) {
+			traceBegin("decode image");
+			loader->images[i] = decodeImage(absPath, loader->definitions[i]);
+			traceEnd("decode image");
+		}else{
+			loader->images[i].missing = true;
+		}
+		free(absPath);
+
+		SDL_LockMutex(loader->lock);
+		loader->readyQueue[loader->readyCount++] = i;
+		SDL_CondSignal(loader->imageReady);
+		SDL_UnlockMutex(loader->lock);
+	}
+
+	return 0;
+}
+
+static Asset makeAsset(AssetDef definition, AssetHandle handle, DecodedImage *image) {
 	Asset asset = {	definition.filename	};
 
-	//Build initial texture and assign.
-	SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, original);
+	if(image->original == NULL) {
+		char *absPath = combineStrings(assetPath, definition.filename);
+		fatalError(image->missing ? "Could not find Asset on disk" : "Could not load Asset", absPath);
+		free(absPath);
+		return asset;
+	}
+	asset.size = makeCoord(image->original->w, image->original->h);
+	asset.mask = makeMask(image->original);
+
+	for(int v=0; v < ASSET_VERSIONS; v++) asset.states[v] = makeDrawState(255, 255, 255, 255);
 
-	//Darken background elements to provide contrast with foreground.
-	//A hint of blue is added for atmosphere.
-	if(definition.isBackground) {
-		SDL_SetTextureColorMod(texture, 164, 164, 164);
+	//Darken background elements to provide contrast with foreground. A hint of blue is added for atmosphere.
+	if(definition.isBackground) asset.states[ASSET_DEFAULT] = makeDrawState(164, 164, 164, 255);
+	asset.states[ASSET_SHADOW] = makeDrawState(0, 0, 0, ALPHA_SHADOWS ? 225 : 255);
+	asset.states[ASSET_ALPHA] = makeDrawState(255, 255, 255, 96);
+
+	//Only versions with per-pixel changes need packing alongside the default.
+	queueAtlasEntry(image->original, handle, ASSET_DEFAULT);
+	if(image->super != NULL) {
+		queueAtlasEntry(image->super, handle, ASSET_SUPER);
+	}
+	if(image->hit != NULL) {
+		queueAtlasEntry(image->hit, handle, ASSET_HIT);
 	}
 
-	asset.textures[ASSET_DEFAULT] = texture;
+	return asset;
+}
 
-	//IMPORTANT: Some of our colourisation calls are destructive to the original surface asset,
-	// so the order they're done in is significant. We should try to change these to SDL
-	// modulation calls instead, which operate on textures, not the surface.
+static int compareAtlasEntries(const void *a, const void *b) {
+	const AtlasEntry *entryA = a;
+	const AtlasEntry *entryB = b;
 
-	//If the definition calls for it, also add a 'hit' variant.
-	if(definition.makeAlphaVersion) {
-		SDL_Texture *alphaTexture = SDL_CreateTextureFromSurface(renderer, original);
-		SDL_SetTextureBlendMode(alphaTexture, SDL_BLENDMODE_BLEND);
-		SDL_SetTextureAlphaMod(alphaTexture, 96);
-		asset.textures[ASSET_ALPHA] = alphaTexture;
+	//Tallest first packs a skyline far tighter; fall back to load order to keep it deterministic.
+	if(entryA->surface->h != entryB->surface->h) return entryB->surface->h - entryA->surface->h;
+	return entryA->order - entryB->order;
+}
+
+static void packAtlas() {
+	assert(renderer != NULL);
+
+	//Respect the renderer's texture limit, if it has one.
+	int pageWidth = ATLAS_PAGE_SIZE, pageHeight = ATLAS_PAGE_SIZE;
+	SDL_RendererInfo info;
+	if(SDL_GetRendererInfo(renderer, &info) == 0) {
+		if(info.max_texture_width > 0 && info.max_texture_width < pageWidth) pageWidth = info.max_texture_width;
+		if(info.max_texture_height > 0 && info.max_texture_height < pageHeight) pageHeight = info.max_texture_height;
 	}
-	if(definition.makeShadowVersion) {
-		SDL_Texture *shadowTexture = SDL_CreateTextureFromSurface(renderer, original);
-		SDL_SetTextureColorMod(shadowTexture, 0, 0, 0);
-		if(ALPHA_SHADOWS) {
-			SDL_SetTextureAlphaMod(shadowTexture, 225);
+
+	qsort(atlasEntries, atlasEntryCount, sizeof(AtlasEntry), compareAtlasEntries);
+
+	//First fit across the open pages, opening a new page when none has room.
+	int *entryPages = malloc(sizeof(int) * atlasEntryCount);
+	SDL_Rect *entryRects = malloc(sizeof(SDL_Rect) * atlasEntryCount);
+	for(int i=0; i < atlasEntryCount; i++) {
+		AtlasEntry *entry = &atlasEntries[i];
+		entryPages[i] = -1;
+
+		for(int p=0; p < atlasPageCount && entryPages[i] < 0; p++) {
+			if(atlasInsert(&atlasPages[p], entry->surface, &entryRects[i])) entryPages[i] = p;
 		}
-		asset.textures[ASSET_SHADOW] = shadowTexture;
+		if(entryPages[i] >= 0) continue;
+
+		atlasPages = realloc(atlasPages, sizeof(AtlasPage) * (atlasPageCount + 1));
+		makeAtlasPage(&atlasPages[atlasPageCount], pageWidth, pageHeight);
+
+		if(!atlasInsert(&atlasPages[atlasPageCount], entry->surface, &entryRects[i]))
+			fatalError("Asset is too large for an atlas page", assets[entry->handle].key);
+		entryPages[i] = atlasPageCount++;
 	}
-	if(definition.makeSuperVersion) {
-		colouriseSprite(original, makeColour(0,0,8,255), COLOURISE_ADDITIVE);
-		SDL_Texture *superTexture = SDL_CreateTextureFromSurface(renderer, original);
-		asset.textures[ASSET_SUPER] = superTexture;
+
+	//Upload the pages, and point every Asset version at its page and rect.
+	for(int p=0; p < atlasPageCount; p++) finishAtlasPage(&atlasPages[p]);
+	for(int i=0; i < atlasEntryCount; i++) {
+		AtlasEntry *entry = &atlasEntries[i];
+		assets[entry->handle].textures[entry->version] = atlasPages[entryPages[i]].texture;
+		assets[entry->handle].sources[entry->version] = entryRects[i];
+
+		SDL_FreeSurface(entry->surface);
 	}
-	if(definition.makeHitVersion) {
-		colouriseSprite(original, makeColour(128,0,0,255), COLOURISE_ADDITIVE);
-		SDL_Texture *hitTexture = SDL_CreateTextureFromSurface(renderer, original);
-		asset.textures[ASSET_HIT] = hitTexture;
+
+	//Modulated versions draw the default pixels, so they point at the same place.
+	double sharedBytes = 0;
+	for(int i=0; i < assetCount; i++) {
+		for(int v=0; v < ASSET_VERSIONS; v++) {
+			if(!isModulatedVersion(imageDefinitions[i], v)) continue;
+
+			assets[i].textures[v] = assets[i].textures[ASSET_DEFAULT];
+			assets[i].sources[v] = assets[i].sources[ASSET_DEFAULT];
+			sharedBytes += assets[i].size.x * assets[i].size.y * 4;
+		}
 	}
 
-	//Free up RAM used for original surface object.
-#if !defined(_WIN32)
-	free(original);
-#endif
+	double textureBytes = 0;
+	for(int p=0; p < atlasPageCount; p++) textureBytes += (double)atlasPages[p].width * atlasPages[p].height * 4;
+	SDL_Log("Atlas textures use %.1fMB over %d pages. Shadow and alpha versions are drawn from shared pixels, "
+			"rather than %.1fMB of copies.", textureBytes / (1024 * 1024), atlasPageCount, sharedBytes / (1024 * 1024));
 
-	return asset;
+	free(entryPages);
+	free(entryRects);
+	free(atlasEntries);
+	atlasEntries = NULL;
+	atlasEntryCount = 0;
 }
 
-SDL_Texture *getTexture(char *path) {
-	return getTextureVersion(path, ASSET_DEFAULT);
+SDL_Texture *getTextureHandle(AssetHandle handle, AssetVersion version) {
+	assert(handle >= 0 && handle < assetCount);
+	return assets[handle].textures[version];
+}
+SDL_Rect getAssetSource(AssetHandle handle, AssetVersion version) {
+	assert(handle >= 0 && handle < assetCount);
+	return assets[handle].sources[version];
+}
+DrawState getDrawState(AssetHandle handle, AssetVersion version) {
+	assert(handle >= 0 && handle < assetCount);
+	return assets[handle].states[version];
+}
+Coord getAssetSize(AssetHandle handle) {
+	assert(handle >= 0 && handle < assetCount);
+	return assets[handle].size;
+}
+const Mask *getAssetMask(AssetHandle handle) {
+	assert(handle >= 0 && handle < assetCount);
+	return &assets[handle].mask;
 }
-SDL_Texture *getTextureVersion(char *path, AssetVersion version) {
-	return getAsset(path).textures[version];
+AssetHandle getAssetHandle(char *path) {
+	int i = indexFind(&assetIndex, path);
+	if(i < 0) fatalError("Could not find Asset in register", path);
+
+	return i < 0 ? ASSET_HANDLE_NONE : i;
 }
 Asset getAsset(char *path) {
-	//Loop through register until key is found, or we've exhausted the array's iteration.
-	for(int i=0; i < assetCount; i++) {
-		if(strcmp(assets[i].key, path) == 0)			//if strings match.
-			return assets[i];
+	AssetHandle handle = getAssetHandle(path);
+	if(handle == ASSET_HANDLE_NONE) {
+		Asset none = { };
+		return none;
 	}
 
-	fatalError("Could not find Asset in register", path);
+	return assets[handle];
 }
 
 void shutdownAssets() {
 	free(assetPath);
+	for(int i=0; i < assetCount; i++) freeMask(&assets[i].mask);
 	free(assets);
+	freeIndex(&assetIndex);
+
+	for(int i=0; i < atlasPageCount; i++) freeAtlasPage(&atlasPages[i]);
+	free(atlasPages);
+	atlasPages = NULL;
+	atlasPageCount = 0;
 
 	for(int i=0; i < soundCount; i++) Mix_FreeChunk(sounds[i].sound);
 	for(int i=0; i < musicCount; i++) Mix_FreeMusic(music[i].music);
 
 	free(sounds);
+	free(music);
+	freeIndex(&soundIndex);
+	freeIndex(&musicIndex);
+
+	//Only once nothing is streaming from it.
+	closePak(&assetPak);
 }
 
-static void loadImages() {
-	//Define assets to be loaded.
-	AssetDef definitions[] = {
-		// HUD
-        { "text-keyface.png", false, false, false, false, false },
-		{ "text-coins.png", false, false, false, false, false },
-		{ "text-treats.png", false, false, false, false, false },
-		{ "text-bonus.png", false, false, false, false, false },
-		{ "text-score.png", false, false, false, false, false },
-		{ "health-bar.png", false, false, false, false, false },
-		{ "health-bar-bg.png", false, false, false, false, false },
-		{ "text-laser-upgraded.png", false, true, false, false, false },
-		{ "text-full-power.png", false, true, false, false, false },
-		{ "top-score.png", false, false, false, false, false },
-		{ "insert-coin-0.png", false, false, false, false, false },
-		{ "insert-coin-1.png", false, false, false, false, false },
-		{ "insert-coin-dim-0.png", false, false, false, false, false },
-		{ "insert-coin-dim-1.png", false, false, false, false, false },
-		{ "font-x.png", false, true, false, false, false },
-		{ "font-00.png", false, true, false, false, false },
-		{ "font-01.png", false, true, false, false, false },
-		{ "font-02.png", false, true, false, false, false },
-		{ "font-03.png", false, true, false, false, false },
-		{ "font-04.png", false, true, false, false, false },
-		{ "font-05.png", false, true, false, false, false },
-		{ "font-06.png", false, true, false, false, false },
-		{ "font-07.png", false, true, false, false, false },
-		{ "font-08.png", false, true, false, false, false },
-		{ "font-09.png", false, true, false, false, false },
-		{ "warning.png", false, false, false, false, false },
-        { "hud-powerup.png", false, false, false, false, false },
-        { "hud-powerup-double.png", false, false, false, false, false },
-        { "hud-powerup-triple.png", false, false, false, false, false },
-        { "hud-powerup-fan.png", false, false, false, false, false },
-        { "battery.png", true, true, true, true, false },
-        { "battery-half.png", true, true, true, true, false },
-        { "battery-low-01.png", true, true, true, true, false },
-        { "battery-low-02.png", true, true, true, true, false },
-        { "battery-none.png", false, false, true, false, false },
-        { "battery-none-01.png", false, false, true, false, false },
-        { "battery-none-02.png", false, false, true, false, false },
-        { "life.png", false, false, false, false, false },
-        { "life-half.png", false, false, false, false, false },
-        { "life-none.png", false, false, false, false, false },
-        { "level-1.png", false, false, false, false, false },
-        { "game-over.png", false, false, false, false, false },
-        { "title.png", false, false, false, false, false },
-        { "lm-presents.png", false, false, false, false, false },
-
-        // Items
-        { "coin-01.png", false, true, false, true, false },
-        { "coin-02.png", false, true, false, true, false },
-        { "coin-03.png", false, true, false, true, false },
-        { "coin-04.png", false, true, false, true, false },
-        { "coin-05.png", false, true, false, true, false },
-        { "coin-06.png", false, true, false, true, false },
-        { "coin-07.png", false, true, false, true, false },
-        { "coin-08.png", false, true, false, true, false },
-        { "coin-09.png", false, true, false, true, false },
-        { "coin-10.png", false, true, false, true, false },
-        { "coin-11.png", false, true, false, true, false },
-        { "coin-12.png", false, true, false, true, false },
-        { "powerup.png", false, true, false, false, false },
-		{ "powerup-double.png", false, true, false, false, false },
-		{ "powerup-double-01.png", false, true, false, false, false },
-		{ "powerup-double-02.png", false, true, false, false, false },
-		{ "powerup-double-x2.png", false, true, false, false, false },
-		{ "powerup-triple.png", false, true, false, false, false },
-		{ "powerup-triple-01.png", false, true, false, false, false },
-		{ "powerup-triple-02.png", false, true, false, false, false },
-		{ "powerup-triple-x2.png", false, true, false, false, false },
-		{ "powerup-fan.png", false, true, false, false, false },
-		{ "grape-01.png", false, true, false, false, false },
-		{ "grape-02.png", false, true, false, false, false },
-		{ "grapes.png", false, true, false, false, false },
-		{ "pineapple.png", false, true, false, false, false },
-		{ "pineapple-01.png", false, true, false, false, false },
-		{ "pineapple-02.png", false, true, false, false, false },
-		{ "battery-pack.png", false, true, false, false, false },
-		{ "battery-pack-01.png", false, true, false, false, false },
-		{ "battery-pack-02.png", false, true, false, false, false },
-        { "cherries.png", false, true, false, false, false },
-        { "cherries-01.png", false, true, false, false, false },
-        { "cherries-02.png", false, true, false, false, false },
-
-		// Platforms
-        { "base-chip.png", false, false, false, false, true },
-		{ "base-resistor.png", false, false, false, false, true },
-		{ "base-resistor-2.png", false, false, false, false, true },
-		{ "base-large.png", false, false, false, false, true },
-		{ "base-large-chip.png", false, false, false, false, true },
-		{ "base-large-resistor.png", false, false, false, false, true },
-		{ "base-large-terminal.png", false, false, false, false, true },
-		{ "base-large-n.png", false, false, false, false, true },
-		{ "base-large-e.png", false, false, false, false, true },
-		{ "base-large-s.png", false, false, false, false, true },
-		{ "base-large-w.png", false, false, false, false, true },
-		{ "base-large-ne.png", false, false, false, false, true },
-		{ "base-large-nw.png", false, false, false, false, true },
-		{ "base-large-se.png", false, false, false, false, true },
-		{ "base-large-sw.png", false, false, false, false, true },
-		{ "base-large-chip-n.png", false, false, false, false, true },
-		{ "base-large-chip-e.png", false, false, false, false, true },
-		{ "base-large-chip-s.png", false, false, false, false, true },
-		{ "base-large-chip-w.png", false, false, false, false, true },
-
-		// Background
-		{ "star-bright.png", false, false, false, false, true },
-		{ "star-dim.png", false, false, false, false, false },
-		{ "star-dark.png", false, false, false, false, false },
-		{ "planet-01.png", false, false, false, false, true },
-		{ "planet-02.png", false, false, false, false, true },
-		{ "planet-03.png", false, false, false, false, true },
-		{ "planet-04.png", false, false, false, false, true },
-
-		// Misc
-        { "super-streak.png", false, false, false, false, false },
-        { "super-fleck.png", false, false, false, false, false },
-        { "key-a.png", true, true, false, false, false },
-		{ "virus-shot.png", false, true, false, false, false },
-		{ "shot-blue-01.png", false, true},
-		{ "shot-blue-02.png", false, true},
-		{ "shot-neon-01.png", false, true},
-		{ "shot-neon-02.png", false, true},
-		{ "shot-aqua.png", false, true, false, false, false },
-		{ "shot-orange.png", false, true, false, false, false },
-		{ "speech-entry.png", false, false, false, false, false },
-		{ "speech-coin.png", false, false, false, false, false },
-
-        // Explosions
-        { "exp-01.png", false, true, false, false, false },
-        { "exp-02.png", false, true, false, false, false },
-        { "exp-03.png", false, true, false, false, false },
-        { "exp-04.png", false, true, false, false, false },
-        { "exp-05.png", false, true, false, false, false },
-        { "exp-06.png", false, true, false, false, false },
-
-		// Enemies
-		{ "virus-01.png", true, true, false, false, false },
-		{ "virus-02.png", true, true, false, false, false },
-		{ "virus-03.png", true, true, false, false, false },
-		{ "virus-04.png", true, true, false, false, false },
-		{ "virus-05.png", true, true, false, false, false },
-		{ "virus-06.png", true, true, false, false, false },
-		{ "bug-01.png", true, true, false, false, false },
-		{ "bug-02.png", true, true, false, false, false },
-		{ "bug-03.png", true, true, false, false, false },
-		{ "bug-04.png", true, true, false, false, false },
-		{ "bug-05.png", true, true, false, false, false },
-		{ "bug-06.png", true, true, false, false, false },
-		{ "cd-01.png", true, true, false, false, false },
-		{ "cd-02.png", true, true, false, false, false },
-		{ "cd-03.png", true, true, false, false, false },
-		{ "cd-04.png", true, true, false, false, false },
-		{ "disk-01.png", true, true, false, false, false },
-		{ "disk-02.png", true, true, false, false, false },
-		{ "disk-03.png", true, true, false, false, false },
-		{ "disk-04.png", true, true, false, false, false },
-		{ "disk-05.png", true, true, false, false, false },
-		{ "disk-06.png", true, true, false, false, false },
-		{ "disk-07.png", true, true, false, false, false },
-		{ "disk-08.png", true, true, false, false, false },
-		{ "disk-09.png", true, true, false, false, false },
-		{ "disk-10.png", true, true, false, false, false },
-		{ "disk-11.png", true, true, false, false, false },
-		{ "disk-12.png", true, true, false, false, false },
-		{ "cone-01.png", true, true, false, false, false },
-		{ "cone-02.png", true, true, false, false, false },
-		{ "cone-03.png", true, true, false, false, false },
-		{ "cone-04.png", true, true, false, false, false },
-		{ "cone-05.png", true, true, false, false, false },
-		{ "cone-06.png", true, true, false, false, false },
-		{ "cone-07.png", true, true, false, false, false },
-		{ "cone-08.png", true, true, false, false, false },
-		{ "cone-09.png", true, true, false, false, false },
-		{ "cone-10.png", true, true, false, false, false },
-		{ "cone-11.png", true, true, false, false, false },
-		{ "cone-12.png", true, true, false, false, false },
-		{ "cone-13.png", true, true, false, false, false },
-		{ "cone-14.png", true, true, false, false, false },
-		{ "cone-15.png", true, true, false, false, false },
-		{ "cone-16.png", true, true, false, false, false },
-		{ "disk-blue-01.png", true, true, false, false, false },
-		{ "disk-blue-02.png", true, true, false, false, false },
-		{ "disk-blue-03.png", true, true, false, false, false },
-		{ "disk-blue-04.png", true, true, false, false, false },
-		{ "disk-blue-05.png", true, true, false, false, false },
-		{ "disk-blue-06.png", true, true, false, false, false },
-		{ "disk-blue-07.png", true, true, false, false, false },
-		{ "disk-blue-08.png", true, true, false, false, false },
-		{ "disk-blue-09.png", true, true, false, false, false },
-		{ "disk-blue-10.png", true, true, false, false, false },
-		{ "disk-blue-11.png", true, true, false, false, false },
-		{ "disk-blue-12.png", true, true, false, false, false },
-        { "keyboss-mini-01.png", false, false, false, false, false },
-        { "keyboss-mini-02.png", false, false, false, false, false },
-        { "keyboss-01.png", true, true, false, false, false },
-        { "keyboss-02.png", true, true, false, false, false },
-        { "keyboss-03.png", true, true, false, false, false },
-        { "keyboss-04.png", true, true, false, false, false },
-        { "keyboss-05.png", true, true, false, false, false },
-        { "keyboss-06.png", true, true, false, false, false },
-        { "keyboss-07.png", true, true, false, false, false },
-        { "keyboss-08.png", true, true, false, false, false },
-        { "keyboss-09.png", true, true, false, false, false },
-        { "keyboss-10.png", true, true, false, false, false },
-        { "keyboss-11.png", true, true, false, false, false },
-        { "keyboss-12.png", true, true, false, false, false },
-        { "magnet-01.png", true, true, false, false, false },
-        { "magnet-02.png", true, true, false, false, false },
-        { "magnet-03.png", true, true, false, false, false },
-        { "magnet-04.png", true, true, false, false, false },
-        { "magnet-05.png", true, true, false, false, false },
-        { "magnet-06.png", true, true, false, false, false },
-        { "magnet-07.png", true, true, false, false, false },
-        { "magnet-08.png", true, true, false, false, false },
-
-        // Player
-        { "sleep-01.png", false, true, false, false, false },
-        { "sleep-02.png", false, true, false, false, false },
-		{ "sleep-03.png", false, true, false, false, false },
-		{ "sleep-04.png", false, true, false, false, false },
-		{ "sleep-05.png", false, true, false, false, false },
-		{ "sleep-06.png", false, true, false, false, false },
-		{ "sleep-07.png", false, true, false, false, false },
-		{ "sleep-08.png", false, true, false, false, false },
-		{ "mike-shades-01.png", false, true, false, false, false },
-        { "mike-shades-02.png", false, true, false, false, false },
-        { "mike-shades-03.png", false, true, false, false, false },
-        { "mike-shades-04.png", false, true, false, false, false },
-        { "mike-shades-05.png", false, true, false, false, false },
-        { "mike-shades-06.png", false, true, false, false, false },
-        { "mike-shades-07.png", false, true, false, false, false },
-        { "mike-shades-08.png", false, true, false, false, false },
-        { "mike-shades-09.png", false, true, false, false, false },
-        { "mike-shades-10.png", false, true, false, false, false },
-        { "mike-shades-11.png", false, true, false, false, false },
-        { "mike-shades-12.png", false, true, false, false, false },
-        { "mike-shades-13.png", false, true, false, false, false },
-        { "mike-fright-left.png", false, true, false, false, false },
-        { "mike-fright-right.png", false, true, false, false, false },
-		{ "mike-facing-01.png", true, true, true, true, false },
-		{ "mike-facing-02.png", true, true, true, true, false },
-		{ "mike-facing-03.png", true, true, true, true, false },
-		{ "mike-facing-04.png", true, true, true, true, false },
-		{ "mike-facing-05.png", true, true, true, true, false },
-		{ "mike-facing-06.png", true, true, true, true, false },
-		{ "mike-facing-07.png", true, true, true, true, false },
-		{ "mike-facing-08.png", true, true, true, true, false },
-		{ "mike-01.png", true, true, true, true, false },
-		{ "mike-02.png", true, true, true, true, false },
-		{ "mike-03.png", true, true, true, true, false },
-		{ "mike-04.png", true, true, true, true, false },
-		{ "mike-05.png", true, true, true, true, false },
-		{ "mike-06.png", true, true, true, true, false },
-		{ "mike-07.png", true, true, true, true, false },
-		{ "mike-08.png", true, true, true, true, false },
-		{ "mike-lean-left-01.png", true, true, false, true, false },
-		{ "mike-lean-left-02.png", true, true, false, true, false },
-		{ "mike-lean-left-03.png", true, true, false, true, false },
-		{ "mike-lean-left-04.png", true, true, false, true, false },
-		{ "mike-lean-left-05.png", true, true, false, true, false },
-		{ "mike-lean-left-06.png", true, true, false, true, false },
-		{ "mike-lean-left-07.png", true, true, false, true, false },
-		{ "mike-lean-left-08.png", true, true, false, true, false },
-		{ "mike-lean-right-01.png", true, true, false, true, false },
-		{ "mike-lean-right-02.png", true, true, false, true, false },
-		{ "mike-lean-right-03.png", true, true, false, true, false },
-		{ "mike-lean-right-04.png", true, true, false, true, false },
-		{ "mike-lean-right-05.png", true, true, false, true, false },
-		{ "mike-lean-right-06.png", true, true, false, true, false },
-		{ "mike-lean-right-07.png", true, true, false, true, false },
-		{ "mike-lean-right-08.png", true, true, false, true, false },
-		{ "mike-shoot-evil-01.png", true, true, false, true, false },
-		{ "mike-shoot-evil-02.png", true, true, false, true, false },
-		{ "mike-shoot-01.png", true, true, false, true, false },
-		{ "mike-shoot-02.png", true, true, false, true, false },
-		{ "mike-shoot-left-01.png", true, true, false, true, false },
-		{ "mike-shoot-left-02.png", true, true, false, true, false },
-		{ "mike-shoot-right-01.png", true, true, false, true, false },
-		{ "mike-shoot-right-02.png", true, true, false, true, false },
-		{ "mike-shock.png", false, true, false, true, false },
-		{ "mike-shock2.png", false, true, false, true, false },
-		{ "mike-shock3.png", false, true, false, true, false },
-	};
+//Decodes on a pool of loader threads. The main thread registers each image as it arrives.
+static int loadLooseImages() {
+	ImageLoader loader = { imageDefinitions, calloc(assetCount, sizeof(DecodedImage)), assetCount };
+	loader.lock = SDL_CreateMutex();
+	loader.imageReady = SDL_CreateCond();
+	loader.readyQueue = malloc(sizeof(int) * assetCount);
+
+	int threadCount = SDL_GetCPUCount();
+	if(threadCount > MAX_LOADER_THREADS) threadCount = MAX_LOADER_THREADS;
+	if(threadCount > assetCount) threadCount = assetCount;
+	SDL_Thread *threads[MAX_LOADER_THREADS];
+	int startedThreads = 0;
+	for(int i=0; i < threadCount; i++) {
+		threads[startedThreads] = SDL_CreateThread(loaderThread, "image loader", &loader);
+		if(threads[startedThreads] != NULL) startedThreads++;
+	}
+	//Fall back to decoding everything here if no thread could be started.
+	if(startedThreads == 0) loaderThread(&loader);
+
+	for(int taken=0; taken < assetCount; taken++) {
+		SDL_LockMutex(loader.lock);
+		while(loader.readyCount == taken) SDL_CondWait(loader.imageReady, loader.lock);
+		int i = loader.readyQueue[taken];
+		SDL_UnlockMutex(loader.lock);
+
+		assets[i] = makeAsset(imageDefinitions[i], i, &loader.images[i]);
+	}
+
+	double decodeWork = 0;
+	for(int i=0; i < startedThreads; i++) SDL_WaitThread(threads[i], NULL);
+	for(int i=0; i < assetCount; i++) decodeWork += loader.images[i].decodeMs;
+	SDL_Log("Decoding used %.1fms of loader time.", decodeWork);
+
+	free(loader.images);
+	free(loader.readyQueue);
+	SDL_DestroyCond(loader.imageReady);
+	SDL_DestroyMutex(loader.lock);
+
+	return startedThreads > 0 ? startedThreads : 1;
+}
 
+//Wraps a version's mapped pixels without copying them. Atlas packing only ever reads them, so
+// the read-only mapping is safe to hand over.
+static SDL_Surface *mapPakSurface(const PakImage *image, AssetVersion version) {
+	if(image->pixels[version] == 0) return NULL;
+
+	void *pixels = (void *)pakData(&assetPak, image->pixels[version]);
+	return SDL_CreateRGBSurfaceWithFormatFrom(pixels, image->width, image->height, 32, image->width * 4, SDL_PIXELFORMAT_ARGB8888);
+}
+
+//Whether a packed file is still as it was when packed. One that's missing (a pack-only install)
+// can't have been edited since, so it passes.
+static bool pakSourceUnchanged(const char *filename, PakSource packed) {
+	char *path = combineStrings(assetPath, filename);
+	PakSource current;
+	bool unchanged = !readPakSource(path, &current) ||
+			(current.size == packed.size && current.modified == packed.modified);
+	free(path);
+	return unchanged;
+}
+
+//A pack built from a different manifest, or from files that have since been edited, would hand out
+// the wrong pixels or sounds, so it has to match ours exactly.
+static bool pakMatchesManifest() {
+	const PakHeader *header = assetPak.header;
+	if(header->imageCount != ASSET_COUNT || header->soundCount != (Uint32)soundDefinitionCount ||
+			header->musicCount != (Uint32)musicDefinitionCount) return false;
+
+	for(int i=0; i < ASSET_COUNT; i++) {
+		const PakImage *image = &assetPak.images[i];
+		if(strcmp(image->key, imageDefinitions[i].filename) != 0) return false;
+		if(image->flags != pakImageFlags(imageDefinitions[i])) return false;
+		if(!pakSourceUnchanged(image->key, image->source)) return false;
+	}
+	for(int i=0; i < soundDefinitionCount; i++) {
+		if(strcmp(assetPak.sounds[i].key, soundDefinitions[i].filename) != 0) return false;
+		if(!pakSourceUnchanged(assetPak.sounds[i].key, assetPak.sounds[i].source)) return false;
+	}
+	for(int i=0; i < musicDefinitionCount; i++) {
+		if(strcmp(assetPak.music[i].key, musicDefinitions[i]) != 0) return false;
+		if(!pakSourceUnchanged(assetPak.music[i].key, assetPak.music[i].source)) return false;
+	}
+
+	return true;
+}
+
+static void loadPakImages() {
+	for(int i=0; i < assetCount; i++) {
+		const PakImage *image = &assetPak.images[i];
+		DecodedImage mapped = {
+			mapPakSurface(image, ASSET_DEFAULT),
+			mapPakSurface(image, ASSET_SUPER),
+			mapPakSurface(image, ASSET_HIT)
+		};
+		assets[i] = makeAsset(imageDefinitions[i], i, &mapped);
+	}
+}
+
+static void loadImages() {
 	//Infer asset path from current directory.
 	char* workingPath = SDL_GetBasePath();
 	char assetsFolder[] = "assets/";
 	assetPath = combineStrings(workingPath, assetsFolder);
 
-	//Allocate memory to Asset register.
-	assetCount = sizeof(definitions) / sizeof(AssetDef);
+	//Allocate memory to Asset register, and room for every version it could ask for.
+	assetCount = ASSET_COUNT;
 	assets = malloc(sizeof(Asset) * assetCount);
+	atlasEntries = malloc(sizeof(AtlasEntry) * assetCount * ASSET_VERSIONS);
+
+	//Prefer the pre-decoded pack (see mq-pack), and fall back to the loose files for development.
+	Uint64 started = SDL_GetPerformanceCounter();
+	char *pakPath = combineStrings(assetPath, PAK_FILENAME);
+	if(openPak(&assetPak, pakPath) && !pakMatchesManifest()) {
+		SDL_Log("%s is out of date with assets.csv or the asset files, so loose files will be used. Rebuild it with mq-pack.", pakPath);
+		closePak(&assetPak);
+	}
 
-	//Build and load each Asset into the register.
-	for(int i=0; i < assetCount; i++) {
-		assets[i] = makeAsset(definitions[i]);
+	if(assetPak.data != NULL) {
+		loadPakImages();
+		SDL_Log("Mapped %d images from %s in %.1fms.", assetCount, pakPath, elapsedMilliseconds(started));
+	}else{
+		int threads = loadLooseImages();
+		SDL_Log("Decoded %d images in %.1fms on %d loader threads.", assetCount, elapsedMilliseconds(started), threads);
 	}
+	free(pakPath);
+
+	//Index the register by filename.
+	makeIndex(&assetIndex, assetCount);
+	for(int i=0; i < assetCount; i++) indexInsert(&assetIndex, assets[i].key, i);
+
+	//Pack every version into a handful of shared textures.
+	started = SDL_GetPerformanceCounter();
+	packAtlas();
+	SDL_Log("Packed and uploaded %d atlas pages in %.1fms.", atlasPageCount, elapsedMilliseconds(started));
+}
+
+//Reads from the pack where there is one (the data stays mapped, so it needn't be copied).
+static SDL_RWops *openSoundData(const PakBlob *blobs, int index, const char *filename) {
+	if(assetPak.data != NULL) {
+		const PakBlob *blob = &blobs[index];
+		return SDL_RWFromConstMem(pakData(&assetPak, blob->offset), (int)blob->size);
+	}
+
+	char* path = combineStrings(assetPath, filename);
+	SDL_RWops *data = SDL_RWFromFile(path, "rb");
+	if(data == NULL) fatalError("Could not find Asset on disk", path);
+	free(path);
+	return data;
 }
 
 static void loadSounds() {
-	const int SOUND_VOLUME = 12;
-
-	SoundDef defs[] = {
-		{ "boss-blow.wav", SOUND_VOLUME * 4 },
-		{ "mike-die.wav", SOUND_VOLUME * 4 },
-		{ "intro-presents.wav", SOUND_VOLUME * 2 },
-		{ "warning.wav", SOUND_VOLUME * 2.25 },
-		{ "Powerup9.wav", SOUND_VOLUME * 4 },
-		{ "Powerup8.wav", SOUND_VOLUME * 4 },
-		{ "loss.wav", SOUND_VOLUME * 5 },
-		{ "Pickup_Coin4.wav", (int)ceil(SOUND_VOLUME * 1.5) },
-		{ "Pickup_Coin14.wav", (int)ceil(SOUND_VOLUME * 1.5) },
-		{ "Pickup_Coin34.wav", SOUND_VOLUME },
-		{ "Pickup_Coin34b.wav", (int)ceil(SOUND_VOLUME * 2.5) },
-		{ "ping.wav", (int)ceil(SOUND_VOLUME * 2) },
-		{ "ping2.wav", (int)ceil(SOUND_VOLUME * 2) },
-		{ "warp.wav", SOUND_VOLUME },
-		{ "start.wav", SOUND_VOLUME },
-		{ "Hit_Hurt10.wav", (int)ceil(SOUND_VOLUME * 3) },		// When we get hit.
-		{ "Hit_Hurt18.wav", (int)ceil(SOUND_VOLUME * 3) },		// When we get hit.
-		{ "Hit_Hurt9.wav", SOUND_VOLUME },
-		{ "Laser_Shoot34.wav", SOUND_VOLUME },					// Enemy shot
-		{ "Laser_Shoot18.wav", SOUND_VOLUME / 1.5 },			// Player shot.
-		{ "Laser_Shoot5.wav", SOUND_VOLUME / 4 },
-		{ "Explosion14.wav", SOUND_VOLUME },
-		{ "Explosion3.wav", SOUND_VOLUME },
-		{ "Explosion2.wav", SOUND_VOLUME },
-		{ "Explosion.wav", SOUND_VOLUME }
-	};
-
-	soundCount = sizeof(defs) / sizeof(SoundDef);
+	soundCount = soundDefinitionCount;
 	sounds = malloc(sizeof(SoundAsset) * soundCount);
+	makeIndex(&soundIndex, soundCount);
 
 	for(int i=0; i < soundCount; i++) {
-		//Load music.
-		char* path = combineStrings(assetPath, defs[i].filename);
-		Mix_Chunk* chunk = Mix_LoadWAV(path);
-		if(!chunk) fatalError("Could not find Asset on disk", path);
+		const SoundDef *def = &soundDefinitions[i];
+
+		//Load sound.
+		Mix_Chunk* chunk = Mix_LoadWAV_RW(openSoundData(assetPak.sounds, i, def->filename), 1);
+		if(!chunk) fatalError("Could not load Asset", def->filename);
 
 		//Reduce volume if called for.
-		if(defs[i].volume < SDL_MIX_MAXVOLUME) Mix_VolumeChunk(chunk, defs[i].volume);
+		if(def->volume < SDL_MIX_MAXVOLUME) Mix_VolumeChunk(chunk, def->volume);
 
 		//Add to register
 		SoundAsset snd = {
-			defs[i].filename,
+			def->filename,
 			chunk
 		};
 		sounds[i] = snd;
+		indexInsert(&soundIndex, snd.key, i);
 	}
 }
 
@@ -500,31 +547,24 @@ static void loadSounds() {
 //TODO: Stop 'tic' static on end of sound loop.
 
 static void loadMusic() {
-	char* defs[] = {
-		"tension.ogg",
-		"intro-battle-3.ogg",
-		"level-01c.ogg",
-		"title.ogg",
-		"win-shorter.ogg"
-	};
-
-	musicCount = sizeof(defs) / sizeof(char*);
+	musicCount = musicDefinitionCount;
 	music = malloc(sizeof(MusicAsset) * musicCount);
+	makeIndex(&musicIndex, musicCount);
 
 	for(int i=0; i < musicCount; i++) {
-		//Load music.
-		char* path = combineStrings(assetPath, defs[i]);
-		Mix_Music* chunk = Mix_LoadMUS(path);
-		if(!chunk) fatalError("Could not find Asset on disk", path);
+		//Load music (streamed, so its data has to stay open until it's freed).
+		Mix_Music* chunk = Mix_LoadMUS_RW(openSoundData(assetPak.music, i, musicDefinitions[i]), 1);
+		if(!chunk) fatalError("Could not load Asset", musicDefinitions[i]);
 
 		Mix_VolumeMusic(MUSIC_VOLUME);
 
 		//Add to register
 		MusicAsset snd = {
-			defs[i],
+			musicDefinitions[i],
 			chunk
 		};
 		music[i] = snd;
+		indexInsert(&musicIndex, snd.key, i);
 	}
 }
 
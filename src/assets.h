@@ -2,6 +2,9 @@
 #define ASSETS_H
 
 #include "mysdl.h"
+#include "common.h"
+#include "assetids.h"
+#include "mask.h"
 
 #define ASSET_VERSIONS 5
 typedef enum {
@@ -12,12 +15,30 @@ typedef enum {
 	ASSET_ALPHA = 4
 } AssetVersion;
 
+//How a version's pixels are drawn. Versions that only differ by modulation (e.g. shadows) share
+// the default version's pixels, and get their look from this at draw time.
+typedef struct {
+	SDL_Color modulation;		//colour and alpha mod.
+	SDL_BlendMode blendMode;
+} DrawState;
+
+//Every version lives somewhere on a shared atlas page, so a texture alone isn't enough to draw
+// it - always pair it with the matching source rect and draw state.
 typedef struct {
 	char* key;
-	SDL_Texture* texture;
 	SDL_Texture* textures[ASSET_VERSIONS];
+	SDL_Rect sources[ASSET_VERSIONS];
+	DrawState states[ASSET_VERSIONS];
+	Coord size;			//shared by all versions.
+	Mask mask;			//solid pixels, also shared (hit versions only recolour).
 } Asset;
 
+//Stable index into the Asset register. Register order follows assets.csv, so every generated
+// AssetId (e.g. ASSET_VIRUS_SHOT) is a valid handle. Names only known at runtime can be
+// resolved once with getAssetHandle.
+typedef int AssetHandle;
+#define ASSET_HANDLE_NONE -1
+
 typedef struct {
 	char* key;
 	Mix_Chunk* sound;
@@ -29,10 +50,15 @@ typedef struct {
 } MusicAsset;
 
 extern SDL_Surface* reloadSurface(char* path);
+extern char *loadDataFile(char *path);
 extern void initAssets();
-extern SDL_Texture *getTexture(char *path);
-extern SDL_Texture *getTextureVersion(char *path, AssetVersion version);
 extern Asset getAsset(char *path);
+extern AssetHandle getAssetHandle(char *path);
+extern SDL_Texture *getTextureHandle(AssetHandle handle, AssetVersion version);
+extern SDL_Rect getAssetSource(AssetHandle handle, AssetVersion version);
+extern DrawState getDrawState(AssetHandle handle, AssetVersion version);
+extern Coord getAssetSize(AssetHandle handle);
+extern const Mask *getAssetMask(AssetHandle handle);
 extern void shutdownAssets();
 extern SoundAsset getSound(char *path);
 extern MusicAsset getMusic(char *path);
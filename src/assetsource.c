@@ -0,0 +1,75 @@
+#include "myc.h"
+#include "assetsource.h"
+#include "pixels.h"
+
+//Image definitions (generated from assets.csv, in AssetId order).
+const AssetDef imageDefinitions[ASSET_COUNT] = {
+#include "assetdefs.h"
+};
+
+#define SOUND_VOLUME 12
+
+const SoundDef soundDefinitions[] = {
+	{ "boss-blow.wav", SOUND_VOLUME * 4 },
+	{ "mike-die.wav", SOUND_VOLUME * 4 },
+	{ "intro-presents.wav", SOUND_VOLUME * 2 },
+	{ "warning.wav", SOUND_VOLUME * 2.25 },
+	{ "Powerup9.wav", SOUND_VOLUME * 4 },
+	{ "Powerup8.wav", SOUND_VOLUME * 4 },
+	{ "loss.wav", SOUND_VOLUME * 5 },
+	{ "Pickup_Coin4.wav", SOUND_VOLUME * 3 / 2 },
+	{ "Pickup_Coin14.wav", SOUND_VOLUME * 3 / 2 },
+	{ "Pickup_Coin34.wav", SOUND_VOLUME },
+	{ "Pickup_Coin34b.wav", SOUND_VOLUME * 5 / 2 },
+	{ "ping.wav", SOUND_VOLUME * 2 },
+	{ "ping2.wav", SOUND_VOLUME * 2 },
+	{ "warp.wav", SOUND_VOLUME },
+	{ "start.wav", SOUND_VOLUME },
+	{ "Hit_Hurt10.wav", SOUND_VOLUME * 3 },		// When we get hit.
+	{ "Hit_Hurt18.wav", SOUND_VOLUME * 3 },		// When we get hit.
+	{ "Hit_Hurt9.wav", SOUND_VOLUME },
+	{ "Laser_Shoot34.wav", SOUND_VOLUME },					// Enemy shot
+	{ "Laser_Shoot18.wav", SOUND_VOLUME / 1.5 },			// Player shot.
+	{ "Laser_Shoot5.wav", SOUND_VOLUME / 4 },
+	{ "Explosion14.wav", SOUND_VOLUME },
+	{ "Explosion3.wav", SOUND_VOLUME },
+	{ "Explosion2.wav", SOUND_VOLUME },
+	{ "Explosion.wav", SOUND_VOLUME }
+};
+const int soundDefinitionCount = sizeof(soundDefinitions) / sizeof(SoundDef);
+
+char* const musicDefinitions[] = {
+	"tension.ogg",
+	"intro-battle-3.ogg",
+	"level-01c.ogg",
+	"title.ogg",
+	"win-shorter.ogg"
+};
+const int musicDefinitionCount = sizeof(musicDefinitions) / sizeof(char*);
+
+static const Colour SUPER_TINT = { 0, 0, 8, 255 };
+static const Colour HIT_TINT = { 128, 0, 0, 255 };
+
+//Safe to call from any thread, so failures are only recorded here - reporting is up to the caller.
+DecodedImage decodeImage(const char *path, AssetDef definition) {
+	Uint64 started = SDL_GetPerformanceCounter();
+	DecodedImage image = { };
+
+	//Load file from disk, and normalise it to the atlas pixel format.
+	SDL_Surface *loaded = IMG_Load(path);
+	if(loaded == NULL) return image;
+	image.original = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(loaded);
+	if(image.original == NULL) return image;
+
+	//The hit version is built on top of the super one where there is one, as it always has been.
+	if(definition.makeSuperVersion) {
+		image.super = colouriseSprite(image.original, SUPER_TINT, COLOURISE_ADDITIVE);
+	}
+	if(definition.makeHitVersion) {
+		image.hit = colouriseSprite(image.super != NULL ? image.super : image.original, HIT_TINT, COLOURISE_ADDITIVE);
+	}
+
+	image.decodeMs = (double)(SDL_GetPerformanceCounter() - started) * 1000 / SDL_GetPerformanceFrequency();
+	return image;
+}
@@ -0,0 +1,43 @@
+#ifndef ASSETSOURCE_H
+#define ASSETSOURCE_H
+
+//Asset definitions, and the decoding that turns a source image into its pixel versions. Shared
+// by the game's loose-file loader and the mq-pack tool, so both build exactly the same pixels.
+
+#include "mysdl.h"
+#include <stdbool.h>
+#include "assetids.h"
+
+typedef struct {
+	char* filename;
+	bool makeHitVersion;
+	bool makeShadowVersion;
+	bool makeSuperVersion;
+	bool makeAlphaVersion;
+	bool isBackground;
+} AssetDef;
+
+typedef struct {
+	char* filename;
+	int volume;
+} SoundDef;
+
+//Pixels decoded for one definition. Shadow and alpha versions are made by page modulation, so
+// only the colourised versions need pixels of their own.
+typedef struct {
+	SDL_Surface *original;
+	SDL_Surface *super;
+	SDL_Surface *hit;
+	bool missing;			//not on disk at all, rather than undecodable.
+	double decodeMs;
+} DecodedImage;
+
+extern const AssetDef imageDefinitions[ASSET_COUNT];
+extern const SoundDef soundDefinitions[];
+extern const int soundDefinitionCount;
+extern char* const musicDefinitions[];
+extern const int musicDefinitionCount;
+
+extern DecodedImage decodeImage(const char *path, AssetDef definition);
+
+#endif
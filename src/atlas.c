@@ -0,0 +1,134 @@
+#include <assert.h>
+#include "atlas.h"
+#include "renderer.h"
+#include "myc.h"
+
+//Transparent gap kept to the right of and below each image, so rotated or scaled draws never
+// sample a neighbour's pixels.
+static const int ATLAS_PADDING = 1;
+
+void makeAtlasPage(AtlasPage *page, int width, int height) {
+	page->width = width;
+	page->height = height;
+
+	//There can never be more skyline segments than columns, so this never needs to grow.
+	page->nodes = malloc(sizeof(SkylineNode) * (width + 1));
+	page->nodeCount = 1;
+	SkylineNode ground = { 0, 0, width };
+	page->nodes[0] = ground;
+
+	page->surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+	page->texture = NULL;
+	if(page->surface == NULL) fatalError("Could not create atlas page", SDL_GetError());
+}
+
+//Returns the y position a rect would rest at if its left edge sat on the given node, or -1.
+static int skylineFit(AtlasPage *page, int index, int width, int height) {
+	int x = page->nodes[index].x;
+	if(x + width > page->width) return -1;
+
+	int y = 0;
+	int remaining = width;
+	for(int i = index; remaining > 0; i++) {
+		if(page->nodes[i].y > y) y = page->nodes[i].y;
+		if(y + height > page->height) return -1;
+		remaining -= page->nodes[i].width;
+	}
+
+	return y;
+}
+
+static void removeNode(AtlasPage *page, int index) {
+	memmove(&page->nodes[index], &page->nodes[index + 1], sizeof(SkylineNode) * (page->nodeCount - index - 1));
+	page->nodeCount--;
+}
+
+static void skylineAdd(AtlasPage *page, int index, int x, int y, int width, int height) {
+	//Raise the skyline over the new rect.
+	memmove(&page->nodes[index + 1], &page->nodes[index], sizeof(SkylineNode) * (page->nodeCount - index));
+	SkylineNode node = { x, y + height, width };
+	page->nodes[index] = node;
+	page->nodeCount++;
+
+	//Trim (or drop) the segments it now covers.
+	for(int i = index + 1; i < page->nodeCount; i++) {
+		SkylineNode *previous = &page->nodes[i - 1];
+		SkylineNode *current = &page->nodes[i];
+		int overlap = previous->x + previous->width - current->x;
+		if(overlap <= 0) break;
+
+		current->x += overlap;
+		current->width -= overlap;
+		if(current->width > 0) break;
+
+		removeNode(page, i);
+		i--;
+	}
+
+	//Merge neighbours left at the same height.
+	for(int i = 0; i < page->nodeCount - 1; i++) {
+		if(page->nodes[i].y == page->nodes[i + 1].y) {
+			page->nodes[i].width += page->nodes[i + 1].width;
+			removeNode(page, i + 1);
+			i--;
+		}
+	}
+}
+
+bool atlasInsert(AtlasPage *page, SDL_Surface *image, SDL_Rect *placed) {
+	assert(page->surface != NULL);
+
+	int width = image->w + ATLAS_PADDING;
+	int height = image->h + ATLAS_PADDING;
+
+	//Bottom-left rule: pick the lowest resting place, preferring the narrower segment on ties.
+	int bestIndex = -1, bestY = 0, bestWidth = 0;
+	for(int i=0; i < page->nodeCount; i++) {
+		int y = skylineFit(page, i, width, height);
+		if(y < 0) continue;
+
+		if(bestIndex < 0 || y < bestY || (y == bestY && page->nodes[i].width < bestWidth)) {
+			bestIndex = i;
+			bestY = y;
+			bestWidth = page->nodes[i].width;
+		}
+	}
+	if(bestIndex < 0) return false;
+
+	SDL_Rect rect = { page->nodes[bestIndex].x, bestY, image->w, image->h };
+	skylineAdd(page, bestIndex, rect.x, rect.y, width, height);
+
+	//Straight pixel copy - we don't want the image blended onto the (transparent) page.
+	SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE);
+	SDL_Rect target = rect;
+	SDL_BlitSurface(image, NULL, page->surface, &target);
+
+	*placed = rect;
+	return true;
+}
+
+SDL_Texture *finishAtlasPage(AtlasPage *page) {
+	assert(renderer != NULL);
+
+	page->texture = SDL_CreateTextureFromSurface(renderer, page->surface);
+	if(page->texture == NULL) fatalError("Could not upload atlas page", SDL_GetError());
+	SDL_SetTextureBlendMode(page->texture, SDL_BLENDMODE_BLEND);
+
+	//Packing is finished, so the CPU-side copy and skyline are no longer needed.
+	SDL_FreeSurface(page->surface);
+	page->surface = NULL;
+	free(page->nodes);
+	page->nodes = NULL;
+
+	return page->texture;
+}
+
+void freeAtlasPage(AtlasPage *page) {
+	if(page->surface != NULL) SDL_FreeSurface(page->surface);
+	if(page->texture != NULL) SDL_DestroyTexture(page->texture);
+	free(page->nodes);
+
+	page->surface = NULL;
+	page->texture = NULL;
+	page->nodes = NULL;
+}
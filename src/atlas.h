@@ -0,0 +1,27 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "mysdl.h"
+#include <stdbool.h>
+
+//One horizontal segment of the skyline: the lowest free row over [x, x + width).
+typedef struct {
+	int x, y, width;
+} SkylineNode;
+
+//A single atlas texture. Images are packed bottom-left against a skyline and copied into the
+// page surface; finishAtlasPage then uploads it once all images are in.
+typedef struct {
+	int width, height;
+	SkylineNode *nodes;
+	int nodeCount;
+	SDL_Surface *surface;
+	SDL_Texture *texture;
+} AtlasPage;
+
+extern void makeAtlasPage(AtlasPage *page, int width, int height);
+extern bool atlasInsert(AtlasPage *page, SDL_Surface *image, SDL_Rect *placed);
+extern SDL_Texture *finishAtlasPage(AtlasPage *page);
+extern void freeAtlasPage(AtlasPage *page);
+
+#endif
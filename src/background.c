@@ -4,24 +4,10 @@
 #include "renderer.h"
 #include "assets.h"
 #include "common.h"
-
-typedef struct {
-	Coord origin;
-	Sprite sprite;
-	double speed;
-} Planet;
-
-typedef struct {
-	char map[10][20];							//Vertical rectangle (width / 2, height + 1/3)
-	Coord origin;
-	Sprite sprite;
-} Platform;
-
-typedef struct {
-	Coord position;
-	int layer;
-	int brightness;
-} Star;
+#include "trace.h"
+#include "pool.h"
+#include "background.h"
+#include "game.h"
 
 typedef enum {
 	TILE_NULL = 0,
@@ -31,56 +17,43 @@ typedef enum {
 	TILE_EAST = 8
 } TileDirection;
 
-double bgOffset;
-bool showBackground;
-bool staticBackground;
 static const double SCROLL_SPEED = 0.5;			//TODO: Should be in FPS.
 
 //PLANETS
-#define MAX_PLANETS 10
-static Planet planets[MAX_PLANETS];
-static long lastPlanetTime;
-static double nextPlanetSpawnSeconds;
 static int PLANET_SPAWN_MIN_SECONDS = 5;
 static int PLANET_SPAWN_MAX_SECONDS = 15;
-static int planetInc;
 static int PLANET_SPEED_MIN = 6;				//will /10
 static int PLANET_SPEED_MAX = 6;
 static int PLANET_BOUND = 32;
 
 //PLATFORMS
-#define MAX_PLATFORMS 3
-static long lastPlatformTime;
-static double nextPlatformSpawnSeconds;
 static int PLATFORM_SPAWN_MIN_SECONDS = 10;
 static int PLATFORM_SPAWN_MAX_SECONDS = 20;
 static double PLATFORM_SCROLL_SPEED = 0.7;
 static const int PLATFORM_SCALE = 2;
-static Platform platforms[MAX_PLATFORMS];
-static int platformInc;
-static Sprite baseSprite;
 static const int PLATFORM_TILE_SIZE = 20;
 static const int PLATFORM_SEED_X = 3;
 static const int PLATFORM_SEED_Y = 3;
 
 //STARS
-#define MAX_STARS 64
-static bool starsBegun = false;
 static int STAR_DELAY = 150;	//lower is greater.
-static Star stars[MAX_STARS];
-static long lastStarTime = 0;
-static int starInc = 0;
-
-static bool invalidPlanet(Planet* planet) {
-	return
-		planet->speed == 0 ||
-		planet->origin.y - PLANET_BOUND > screenBounds.y;
+#define INITIAL_STARS 40
+static const AssetId STAR_ASSETS[] = { ASSET_STAR_DARK, ASSET_STAR_DIM, ASSET_STAR_BRIGHT };		//by layer
+
+//PLANETS
+static const AssetId PLANET_ASSETS[] = { ASSET_PLANET_01, ASSET_PLANET_02, ASSET_PLANET_03, ASSET_PLANET_04 };
+
+//Render side: one canvas per platform slot, recomposed whenever the slot's serial changes.
+static SDL_Texture *platformTextures[MAX_PLATFORMS];
+static long platformTextureSerials[MAX_PLATFORMS];
+
+//Whether a live planet has scrolled off the bottom of the screen.
+static bool invalidPlanet(const Planet* planet) {
+	return planet->origin.y - PLANET_BOUND > screenBounds.y;
 }
 
-static bool invalidPlatform(Platform* platform) {
-	return
-		platform->origin.x == 0 ||
-		platform->origin.y - (PLATFORM_SEED_Y * PLATFORM_SCALE * PLATFORM_TILE_SIZE) > screenBounds.y;
+static bool invalidPlatform(const Platform* platform) {
+	return platform->origin.y - (PLATFORM_SEED_Y * PLATFORM_SCALE * PLATFORM_TILE_SIZE) > screenBounds.y;
 }
 
 SDL_Texture* createPlatformTexture() {
@@ -93,97 +66,106 @@ SDL_Texture* createPlatformTexture() {
 	);
 }
 
-bool skipClutter() {
+bool skipClutter(const GameContext *game) {
     //Don't do planet, platform rendering, or star scrolling for static backgrounds.
-    return staticBackground || (
-        gameState != STATE_GAME &&
-        gameState != STATE_GAME_OVER &&
-        gameState != STATE_LEVEL_COMPLETE);
+    return game->background.staticBackground || (
+        game->state != STATE_GAME &&
+        game->state != STATE_GAME_OVER &&
+        game->state != STATE_LEVEL_COMPLETE);
 }
 
-void foregroundRenderFrame() {
-    if(skipClutter()) return;
+//Composes a platform's tiles onto its slot's canvas, reusing the canvas from the last platform in that slot.
+static SDL_Texture* composePlatform(int slot, const Platform *platform) {
+	traceInstant("composePlatform", NULL, 0);
 
-	//Draw 'base' platforms.
-	for(int i=0; i < MAX_PLATFORMS; i++) {
-		//Skip null platforms.
-		if(invalidPlatform(&platforms[i])) continue;
-
-		Coord parallaxOrigin = parallax(platforms[i].origin, PARALLAX_PAN, PARALLAX_LAYER_PLATFORM, PARALLAX_X, PARALLAX_ADDITIVE);
-		drawSpriteAbs(platforms[i].sprite, parallaxOrigin);
+	if(platformTextures[slot] == NULL) {
+		platformTextures[slot] = createPlatformTexture();
+		SDL_SetTextureBlendMode(platformTextures[slot], SDL_BLENDMODE_BLEND);
 	}
-}
+	SDL_Texture* canvas = platformTextures[slot];
 
-void backgroundRenderFrame() {
+	//Change renderer context to output onto the tilemap (drawing anything still queued first).
+	flushSprites();
+	SDL_SetRenderTarget(renderer, canvas);
 
+	//Make transparent (initially)
 	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
 	SDL_RenderClear(renderer);
 
-	if(!showBackground) {
-		return;
-	}
+	for(int x=0; x < PLATFORM_TILES_X; x++) {
+		for(int y=0; y < PLATFORM_TILES_Y; y++) {
+			if(platform->tiles[x][y] == ASSET_HANDLE_NONE) continue;
 
-	//Draw nebulous background.
-//	Sprite s = makeSprite(getTexture("bg.png"), zeroCoord(), SDL_FLIP_VERTICAL);
-//	drawSpriteAbsRotated2(s, zeroCoord(), 0, 2);
-
-	//Display an initial screen of stars.
-	if(!starsBegun) {
-		for(int i=0; i < 40; i++) {
-			Star star = {
-				makeCoord(
-					randomMq(0, screenBounds.x),
-					randomMq(0, screenBounds.y)
-				),
-				randomMq(0, 2),		//layer
-				randomMq(0, 2),		//brightness
+			SDL_Rect destination  = {
+					x * PLATFORM_TILE_SIZE, y * PLATFORM_TILE_SIZE,
+					PLATFORM_TILE_SIZE, PLATFORM_TILE_SIZE
 			};
-			stars[i++] = star;
+			Sprite baseSprite = makeHandleSprite(platform->tiles[x][y], ASSET_DEFAULT);
+
+			copySpriteNow(baseSprite, destination);
 		}
-		starsBegun = true;
 	}
 
-	//Spawn stars based on designated density.
-	if(timer(&lastStarTime, STAR_DELAY)) {
-		Star star = {
-			makeCoord(
-				randomMq(0, screenBounds.x),  //spawn across the width of the screen
-				0
-			),
-			randomMq(0, 2),		//layer
-			randomMq(0, 2),		//brightness
-		};
+	//Restore renderer context back to the window canvas.
+	SDL_SetRenderTarget(renderer, renderBuffer);
+	platformTextureSerials[slot] = platform->serial;
+
+	return canvas;
+}
+
+void foregroundRenderFrame(const GameContext *game) {
+    if(skipClutter(game)) return;
+
+	const Platform *platforms = game->background.platforms;
+
+	//Draw 'base' platforms.
+	FOR_EACH_SLOT_IN_ORDER(&game->background.platformPool, i) {
+		SDL_Texture* canvas = platformTextureSerials[i] == platforms[i].serial && platformTextures[i] != NULL ?
+			platformTextures[i] :
+			composePlatform(i, &platforms[i]);
+
+		Coord parallaxOrigin = parallax(game, platforms[i].origin, PARALLAX_PAN, PARALLAX_LAYER_PLATFORM, PARALLAX_X, PARALLAX_ADDITIVE);
+		drawSpriteAbs(makeSprite(canvas, zeroCoord(), SDL_FLIP_NONE), parallaxOrigin);
+	}
+}
 
-		starInc = starInc == MAX_STARS ? 0 : starInc++;
-		stars[starInc++] = star;
+void backgroundRenderFrame(const GameContext *game) {
+	const BackgroundContext *background = &game->background;
+
+	clearBackground(makeColour(0, 0, 0, 0));
+
+	if(!background->showBackground) {
+		return;
 	}
 
+	//Draw nebulous background.
+//	Sprite s = makeSprite(getTexture("bg.png"), zeroCoord(), SDL_FLIP_VERTICAL);
+//	drawSpriteAbsRotated2(s, zeroCoord(), 0, 2);
+
 	//Render stars.
 	for(int i=0; i < MAX_STARS; i++) {
-		Sprite sprite = makeSprite(getTexture(
-			stars[i].layer == 0 ? "star-dark.png" : stars[i].layer == 1 ? "star-dim.png" : "star-bright.png"
-		), zeroCoord(), SDL_FLIP_NONE);
+		Sprite sprite = makeHandleSprite(STAR_ASSETS[background->stars[i].layer], ASSET_DEFAULT);
 
-		Coord parallaxOrigin = parallax(stars[i].position, PARALLAX_PAN, PARALLAX_LAYER_STAR, PARALLAX_X, PARALLAX_ADDITIVE);
+		Coord parallaxOrigin = parallax(game, background->stars[i].position, PARALLAX_PAN, PARALLAX_LAYER_STAR, PARALLAX_X, PARALLAX_ADDITIVE);
 
 		drawSprite(sprite, parallaxOrigin);
 	}
 
-    if(skipClutter()) return;
+    if(skipClutter(game)) return;
 
     //We show two large textures, one after the other, to create a seamless scroll. Once the first texture
 	// moves out of the viewport, however, we snap it back to the top.
 
 	//Render planets.
-	for(int i=0; i < MAX_PLANETS; i++) {
-		//Skip null planets.
-		if(invalidPlanet(&planets[i])) continue;
-		Coord parallaxOrigin = parallax(planets[i].origin, PARALLAX_PAN, PARALLAX_LAYER_PLANET, PARALLAX_X, PARALLAX_ADDITIVE);
-		drawSpriteAbs(planets[i].sprite, parallaxOrigin);
+	FOR_EACH_SLOT_IN_ORDER(&background->planetPool, i) {
+		Coord parallaxOrigin = parallax(game, background->planets[i].origin, PARALLAX_PAN, PARALLAX_LAYER_PLANET, PARALLAX_X, PARALLAX_ADDITIVE);
+		drawSpriteAbs(background->planets[i].sprite, parallaxOrigin);
 	}
 }
 
-Platform makePlatform(Coord origin) {
+Platform makePlatform(GameContext *game, Coord origin) {
+	traceInstant("makePlatform", NULL, 0);
+
 	//Hardcoded seedmap
 	int seedMap[3][3] = {
 			{ 1, 1, 1 },
@@ -198,41 +180,24 @@ Platform makePlatform(Coord origin) {
 //		}
 //	}
 
-	//Create tile map canvas texture.
-	SDL_Texture* canvas = createPlatformTexture();
-
-	//Change renderer context to output onto the tilemap.
-	SDL_SetRenderTarget(renderer, canvas);
-
-	//Make transparent (initially)
-	SDL_SetTextureBlendMode(canvas, SDL_BLENDMODE_BLEND);
-	SDL_RenderFillRect(renderer, NULL);
-
 	Platform p;
 	p.origin = origin;
-
-	//Local variables.
-	Coord tileSize = makeCoord(PLATFORM_TILE_SIZE, PLATFORM_TILE_SIZE);
-
-	//Get base asset.
+	p.serial = ++game->background.platformSerial;
 
 	//Replicate the tile across the screen area, operating on seed map to scale.
 	int xTile = 0;
-	for(double x=0; x < PLATFORM_SEED_X * PLATFORM_SCALE; x += 1 / (double)PLATFORM_SCALE, xTile += tileSize.x){
+	for(double x=0; x < PLATFORM_SEED_X * PLATFORM_SCALE; x += 1 / (double)PLATFORM_SCALE, xTile++){
 		int yTile = 0;
-		for(double y=0; y < PLATFORM_SEED_Y * PLATFORM_SCALE; y += 1 / (double)PLATFORM_SCALE, yTile += tileSize.y) {
+		for(double y=0; y < PLATFORM_SEED_Y * PLATFORM_SCALE; y += 1 / (double)PLATFORM_SCALE, yTile++) {
+			p.tiles[xTile][yTile] = ASSET_HANDLE_NONE;
 			if(!seedMap[(int)floor(x)][(int)floor(y)]) continue;
-			SDL_Rect destination  = {
-					xTile, yTile,
-					(int)tileSize.x, (int)tileSize.y
-			};
 
 			int ix = (int)floor(x);
 			int iy = (int)floor(y);
 
 			TileDirection result = TILE_NULL;
 
-			char* filename = NULL;
+			AssetId tile;
 			if(floor(x) != x && (ix+1 == PLATFORM_SEED_X || !seedMap[ix+1][iy])) {
 				result |= TILE_EAST;
 			}else if(x == 0 || (floor(x) == x && !seedMap[ix-1][iy])) {
@@ -247,80 +212,113 @@ Platform makePlatform(Coord origin) {
 
 			switch(result) {
 				case TILE_NORTH | TILE_EAST:
-					filename = "base-large-ne.png";
+					tile = ASSET_BASE_LARGE_NE;
 					break;
 				case TILE_NORTH | TILE_WEST:
-					filename = "base-large-nw.png";
+					tile = ASSET_BASE_LARGE_NW;
 					break;
 				case TILE_SOUTH | TILE_EAST:
-					filename = "base-large-se.png";
+					tile = ASSET_BASE_LARGE_SE;
 					break;
 				case TILE_SOUTH | TILE_WEST:
-					filename = "base-large-sw.png";
+					tile = ASSET_BASE_LARGE_SW;
 					break;
 				case TILE_NORTH:{
-					filename = "base-large-n.png";
+					tile = ASSET_BASE_LARGE_N;
 					break;
 				}case TILE_SOUTH:{
-					filename = "base-large-s.png";
+					tile = ASSET_BASE_LARGE_S;
 					break;
 				}case TILE_EAST:
-					filename = "base-large-e.png";
+					tile = ASSET_BASE_LARGE_E;
 					break;
 				case TILE_WEST: {
-					filename = "base-large-w.png";
+					tile = ASSET_BASE_LARGE_W;
 					break;
 				}
 				default: {
-					filename = chance(50) ?
-					   "base-large-chip.png" :
-					   "base-large-resistor.png";
+					tile = chance(&game->random[RANDOM_BACKGROUND], 50) ?
+					   ASSET_BASE_LARGE_CHIP :
+					   ASSET_BASE_LARGE_RESISTOR;
 					break;
 				}
 			}
 
-			SDL_Texture *baseTexture = getTexture(filename);
-			baseSprite = makeSprite(baseTexture, zeroCoord(), SDL_FLIP_NONE);
+			p.tiles[xTile][yTile] = tile;
+		}
+	}
 
-			SDL_RenderCopy(renderer, baseSprite.texture, NULL, &destination);
+	return p;
+}
+
+//Stars are spawned in game frames (not render frames), from the background's own random stream, so
+// the same seed scatters them the same way every run without touching anything else's numbers.
+static void spawnStars(GameContext *game) {
+	BackgroundContext *background = &game->background;
+	Random *random = &game->random[RANDOM_BACKGROUND];
+
+	//Display an initial screen of stars, scattered in one go.
+	if(!background->starsBegun) {
+		int xs[INITIAL_STARS], ys[INITIAL_STARS], layers[INITIAL_STARS], brightnesses[INITIAL_STARS];
+		randomFill(random, xs, INITIAL_STARS, 0, (int)screenBounds.x);
+		randomFill(random, ys, INITIAL_STARS, 0, (int)screenBounds.y);
+		randomFill(random, layers, INITIAL_STARS, 0, 2);
+		randomFill(random, brightnesses, INITIAL_STARS, 0, 2);
+
+		for(int i=0; i < INITIAL_STARS; i++) {
+			Star star = { makeCoord(xs[i], ys[i]), layers[i], brightnesses[i] };
+			background->stars[i] = star;
 		}
+		background->starsBegun = true;
 	}
 
-	//Restore renderer context back to the window canvas.
-	SDL_SetRenderTarget(renderer, renderBuffer);
-	p.sprite = makeSprite(canvas, zeroCoord(), SDL_FLIP_NONE);
+	//Spawn stars based on designated density.
+	if(timer(game, &background->lastStarTime, STAR_DELAY)) {
+		Star star = {
+			makeCoord(
+				randomMq(random, 0, screenBounds.x),  //spawn across the width of the screen
+				0
+			),
+			randomMq(random, 0, 2),		//layer
+			randomMq(random, 0, 2),		//brightness
+		};
 
-	return p;
+		background->stars[background->starInc] = star;
+		background->starInc = (background->starInc + 1) % MAX_STARS;
+	}
 }
 
-void backgroundGameFrame() {
+void backgroundGameFrame(GameContext *game) {
+	BackgroundContext *background = &game->background;
+	Planet *planets = background->planets;
+	Platform *platforms = background->platforms;
+	Star *stars = background->stars;
+	Random *random = &game->random[RANDOM_BACKGROUND];
+
+	if(background->showBackground) spawnStars(game);
 
-	if(!showBackground || staticBackground) return;
+	if(!background->showBackground || background->staticBackground) return;
 
 	//Chunk the textures downwards on each frame, or reset if outside view.
-	bgOffset = bgOffset > screenBounds.y ? 0 : bgOffset + SCROLL_SPEED;
+	background->offset = background->offset > screenBounds.y ? 0 : background->offset + SCROLL_SPEED;
 
 	//Spawn planets.
-	if(timer(&lastPlanetTime, toMilliseconds(nextPlanetSpawnSeconds))) {
-		if(planetInc == MAX_PLANETS-1) planetInc = 0;
+	if(timer(game, &background->lastPlanetTime, toMilliseconds(background->nextPlanetSpawnSeconds))) {
+		int slot = acquireSlot(&background->planetPool);
 
 		//Choose random planet type.
-		char planetFile[50];
-		int randPlanet = randomMq(1, 4);
-		sprintf(planetFile, "planet-%02d.png", randPlanet);
-
-		SDL_Texture *planetTexture = getTexture(planetFile);
-		Sprite planetSprite = makeSprite(planetTexture, zeroCoord(), SDL_FLIP_NONE);
+		int randPlanet = randomMq(random, 1, 4);
+		Sprite planetSprite = makeHandleSprite(PLANET_ASSETS[randPlanet - 1], ASSET_DEFAULT);
 
 		Planet planet = {
-			makeCoord(randomMq(0, (int)screenBounds.x), -PLANET_BOUND),
+			makeCoord(randomMq(random, 0, (int)screenBounds.x), -PLANET_BOUND),
 			planetSprite,
-			(randomMq(PLANET_SPEED_MIN, PLANET_SPEED_MAX)) * 0.1
+			(randomMq(random, PLANET_SPEED_MIN, PLANET_SPEED_MAX)) * 0.1
 		};
-		planets[++planetInc] = planet;
+		if(slot >= 0) planets[slot] = planet;
 
 		//Spawn next planet at a random time.
-		nextPlanetSpawnSeconds = randomMq(PLANET_SPAWN_MIN_SECONDS, PLANET_SPAWN_MAX_SECONDS);
+		background->nextPlanetSpawnSeconds = randomMq(random, PLANET_SPAWN_MIN_SECONDS, PLANET_SPAWN_MAX_SECONDS);
 	}
 
 	//Scroll stars.
@@ -331,37 +329,47 @@ void backgroundGameFrame() {
 	}
 
 	//Scroll planets.
-	for(int i=0; i < MAX_PLANETS; i++) {
-		if(invalidPlanet(&planets[i])) continue;
+	FOR_EACH_SLOT(&background->planetPool, i) {
+		if(invalidPlanet(&planets[i])) {
+			releaseSlot(&background->planetPool, i);
+			continue;
+		}
 		planets[i].origin.y += planets[i].speed;
 	}
 
-	if(timer(&lastPlatformTime, toMilliseconds(nextPlatformSpawnSeconds))) {
-		if(platformInc == MAX_PLATFORMS-1) platformInc = 0;
+	if(timer(game, &background->lastPlatformTime, toMilliseconds(background->nextPlatformSpawnSeconds))) {
+		int slot = acquireSlot(&background->platformPool);
 
-		Coord origin = makeCoord(randomMq(0, (int)screenBounds.x), -(PLATFORM_SEED_Y * PLATFORM_SCALE * PLATFORM_TILE_SIZE) / 2);
-		Platform platform = makePlatform(origin);
-		platforms[++platformInc] = platform;
+		Coord origin = makeCoord(randomMq(random, 0, (int)screenBounds.x), -(PLATFORM_SEED_Y * PLATFORM_SCALE * PLATFORM_TILE_SIZE) / 2);
+		Platform platform = makePlatform(game, origin);
+		if(slot >= 0) platforms[slot] = platform;
 
 		//Spawn next planet at a random time.
-		nextPlatformSpawnSeconds = randomMq(PLATFORM_SPAWN_MIN_SECONDS, PLATFORM_SPAWN_MAX_SECONDS);
+		background->nextPlatformSpawnSeconds = randomMq(random, PLATFORM_SPAWN_MIN_SECONDS, PLATFORM_SPAWN_MAX_SECONDS);
 	}
 
 	//Scroll platforms.
-	for(int i=0; i < MAX_PLATFORMS; i++) {
-		if(invalidPlatform(&platforms[i])) continue;
+	FOR_EACH_SLOT(&background->platformPool, i) {
+		if(invalidPlatform(&platforms[i])) {
+			releaseSlot(&background->platformPool, i);
+			continue;
+		}
 		platforms[i].origin.y += PLATFORM_SCROLL_SPEED;
 	}
 }
 
-void resetBackground() {
-	memset(planets, 0, sizeof(planets));
-	memset(platforms, 0, sizeof(platforms));
-	showBackground = true;
-	staticBackground = false;
+void resetBackground(GameContext *game) {
+	BackgroundContext *background = &game->background;
+
+	clearPool(&background->planetPool);
+	clearPool(&background->platformPool);
+	background->showBackground = true;
+	background->staticBackground = false;
 }
 
-void initBackground() {
-	resetBackground();
+void initBackground(GameContext *game) {
+	initPool(&game->background.planetPool, "planet", game->background.planetSlots, MAX_PLANETS);
+	initPool(&game->background.platformPool, "platform", game->background.platformSlots, MAX_PLATFORMS);
+	resetBackground(game);
 }
 
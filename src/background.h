@@ -1,12 +1,61 @@
 #ifndef BACKGROUND_H
 #define BACKGROUND_H
 
-extern void initBackground();
-extern void foregroundRenderFrame();
-extern void backgroundRenderFrame();
-extern void backgroundGameFrame();
-extern void resetBackground();
-extern bool showBackground;
-extern bool staticBackground;
+#include "renderer.h"
+#include "assets.h"
+#include "pool.h"
+
+#define MAX_PLANETS 10
+#define MAX_PLATFORMS 3
+#define MAX_STARS 64
+#define PLATFORM_TILES_X 6		//seed map size * scale.
+#define PLATFORM_TILES_Y 6
+
+typedef struct {
+	Coord origin;
+	Sprite sprite;
+	double speed;
+} Planet;
+
+//Platforms only record their tile layout - the renderer composes it into a texture the first time
+// it draws a platform with a new serial.
+typedef struct {
+	AssetHandle tiles[PLATFORM_TILES_X][PLATFORM_TILES_Y];	//ASSET_HANDLE_NONE for gaps.
+	Coord origin;
+	long serial;
+} Platform;
+
+typedef struct {
+	Coord position;
+	int layer;
+	int brightness;
+} Star;
+
+typedef struct {
+	double offset;
+	bool showBackground;
+	bool staticBackground;
+	Planet planets[MAX_PLANETS];
+	Pool planetPool;
+	int planetSlots[POOL_STORAGE(MAX_PLANETS)];
+	long lastPlanetTime;
+	double nextPlanetSpawnSeconds;
+	Platform platforms[MAX_PLATFORMS];
+	Pool platformPool;
+	int platformSlots[POOL_STORAGE(MAX_PLATFORMS)];
+	long lastPlatformTime;
+	double nextPlatformSpawnSeconds;
+	long platformSerial;
+	bool starsBegun;
+	Star stars[MAX_STARS];
+	long lastStarTime;
+	int starInc;
+} BackgroundContext;
+
+extern void initBackground(GameContext *game);
+extern void foregroundRenderFrame(const GameContext *game);
+extern void backgroundRenderFrame(const GameContext *game);
+extern void backgroundGameFrame(GameContext *game);
+extern void resetBackground(GameContext *game);
 
 #endif
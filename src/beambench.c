@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <math.h>
+#include "mysdl.h"
+#include "enemymotion.h"
+#include "grid.h"
+#include "bench.h"
+
+//Times a beam cast (see castBeam in weapon.c) against a screen full of enemies: the cell walk over
+// the collision grid, against testing every enemy's box. Built with MAX_ENEMIES raised (see
+// CMakeLists.txt) so the stress count fits in one store.
+
+#define CAST_ENEMIES_TOTAL 50000000		//enemies per run, whatever the count (so fewer casts at more).
+#define BENCH_RAYS 64
+
+static const int COUNTS[] = { 200, 5000 };
+static const double BEAM_REACH = 340;		//as weapon.c.
+
+static EnemyMotion motion;
+static Grid grid;
+static int gridSlots[GRID_STORAGE(MAX_ENEMIES)];
+static int slots[MAX_ENEMIES];
+static int nearby[MAX_ENEMIES];
+static RayHit hits[MAX_ENEMIES];
+static Coord rayOrigins[BENCH_RAYS];
+static Coord rayDirections[BENCH_RAYS];
+
+//Scatters enemies over the screen and files them under the grid, as indexEnemies does.
+static void fill(int count) {
+	initGrid(&grid, gridSlots, MAX_ENEMIES);
+
+	for(int i=0; i < count; i++) {
+		Coord at = benchScatter();
+		motion.parallax[i] = at;
+		motion.size[i] = (Coord){ 26, 26 };
+		slots[i] = i;
+
+		Rect bounds = { at.x - 13, at.y - 13, at.x + 13, at.y + 13 };
+		addToGrid(&grid, i, bounds);
+	}
+}
+
+//Beams from along the bottom of the screen, mostly straight up but some up to 45 degrees off.
+static void aim() {
+	for(int r=0; r < BENCH_RAYS; r++) {
+		double turn = r % 4 == 0 ? randomMq(&benchRandom, -45, 45) * 3.14159265358979 / 180 : 0;
+		rayOrigins[r] = (Coord){ randomMq(&benchRandom, 16, BENCH_SCREEN_WIDTH - 16), randomMq(&benchRandom, 200, 240) };
+		rayDirections[r] = (Coord){ sin(turn), -cos(turn) };
+	}
+}
+
+static double scanFirst(int count, int r) {
+	int found = raycastEnemies(&motion, slots, count, rayOrigins[r], rayDirections[r], BEAM_REACH, hits, 1);
+	return found > 0 ? hits[0].distance : BEAM_REACH;
+}
+
+static double gridFirst(int count, int r) {
+	(void)count;		//the grid knows where they all are.
+	GridRay ray = startGridRay(rayOrigins[r], rayDirections[r], BEAM_REACH);
+	double nearest = BEAM_REACH;
+	int nearbyCount;
+
+	while((nearbyCount = nextRayCell(&grid, &ray, nearby)) >= 0) {
+		RayHit hit;
+		if(raycastEnemies(&motion, nearby, nearbyCount, rayOrigins[r], rayDirections[r], BEAM_REACH, &hit, 1) > 0 && hit.distance < nearest) {
+			nearest = hit.distance;
+		}
+		if(nearest <= ray.reached) break;
+	}
+
+	return nearest;
+}
+
+static double scanAll(int count, int r) {
+	return raycastEnemies(&motion, slots, count, rayOrigins[r], rayDirections[r], BEAM_REACH, hits, MAX_ENEMIES);
+}
+
+static double gridAll(int count, int r) {
+	(void)count;		//the grid knows where they all are.
+	int nearbyCount = slotsAlongRay(&grid, rayOrigins[r], rayDirections[r], BEAM_REACH, nearby);
+	return raycastEnemies(&motion, nearby, nearbyCount, rayOrigins[r], rayDirections[r], BEAM_REACH, hits, MAX_ENEMIES);
+}
+
+static double timeCasts(double (*cast)(int, int), int count) {
+	int casts = CAST_ENEMIES_TOTAL / count;
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for(int i=0; i < casts; i++) benchSink += cast(count, i % BENCH_RAYS);
+	return benchSecondsSince(start) * 1e9 / casts;
+}
+
+int main(int argc, char *argv[]) {
+	(void)argc; (void)argv;
+	printf("%8s %15s %15s %15s %15s %10s\n", "enemies", "first scan ns", "first grid ns", "all scan ns", "all grid ns", "all hits");
+
+	seedBench();
+
+	FOR_EACH_COUNT(COUNTS, count) {
+		if(count > MAX_ENEMIES) {
+			printf("%8d (over MAX_ENEMIES, skipped)\n", count);
+			continue;
+		}
+
+		fill(count);
+		aim();
+
+		//Both ways have to find the same things, or the timings mean nothing.
+		double hitsPerRay = 0;
+		for(int r=0; r < BENCH_RAYS; r++) {
+			double all = scanAll(count, r);
+			if(scanFirst(count, r) != gridFirst(count, r) || all != gridAll(count, r)) {
+				printf("%8d grid and scan casts disagree on ray %d\n", count, r);
+				return 1;
+			}
+			hitsPerRay += all / BENCH_RAYS;
+		}
+
+		printf("%8d %15.1f %15.1f %15.1f %15.1f %10.1f\n", count,
+				timeCasts(scanFirst, count), timeCasts(gridFirst, count),
+				timeCasts(scanAll, count), timeCasts(gridAll, count), hitsPerRay);
+	}
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+#include "bench.h"
+
+//Seeded the same every run, so runs time the same scenes.
+static const Uint64 BENCH_SEED = 0x9E3779B97F4A7C15ULL;
+
+Random benchRandom;
+volatile double benchSink;
+
+void seedBench() {
+	seedRandom(&benchRandom, BENCH_SEED);
+}
+
+//A whole-pixel point anywhere on the screen.
+Coord benchScatter() {
+	Coord at = { randomBelow(&benchRandom, BENCH_SCREEN_WIDTH), randomBelow(&benchRandom, BENCH_SCREEN_HEIGHT) };
+	return at;
+}
+
+double benchSecondsSince(Uint64 start) {
+	return (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
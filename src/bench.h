@@ -0,0 +1,26 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include "mysdl.h"
+#include "common.h"
+#include "random.h"
+
+//Scaffolding shared by the mq-*bench targets (see CMakeLists.txt), which link this instead of the game.
+
+//The game's screen, as renderer.c scales up from.
+#define BENCH_SCREEN_WIDTH 224
+#define BENCH_SCREEN_HEIGHT 256
+
+//Visits each of a bench's stress counts, e.g. FOR_EACH_COUNT(COUNTS, count) { ... }.
+#define FOR_EACH_COUNT(counts, count) \
+	for(int countAt_ = 0, count = 0; countAt_ < (int)(sizeof(counts) / sizeof((counts)[0])) && ((count = (counts)[countAt_]), true); countAt_++)
+
+extern Random benchRandom;
+extern volatile double benchSink;		//results go here, so the work timed can't be optimised away.
+
+extern void seedBench();
+extern Coord benchScatter();
+extern double benchSecondsSince(Uint64 start);
+
+#endif
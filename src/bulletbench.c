@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include "mysdl.h"
+#include "bullets.h"
+#include "bench.h"
+
+//Times a game step's worth of enemy bullet work (save positions, move, cull, find those near the
+// player) at bullet-hell counts, topping the field back up with radial volleys as bullets leave the
+// screen, as a boss would.
+
+#define BULLET_STEPS_TOTAL 200000000		//bullet updates per run, whatever the count.
+
+static const int COUNTS[] = { 500, 2000, 10000, 16000 };
+static const Rect SCREEN = { -4, -104, 228, 260 };		//as shotBounds() makes it.
+static const double STEP_BUDGET_US = 1000000.0 / 60;
+
+static BulletField field;
+static int near[MAX_BULLETS];
+
+static void topUp(int count) {
+	while(field.count < count) {
+		Coord origin = { randomBelow(&benchRandom, BENCH_SCREEN_WIDTH), randomBelow(&benchRandom, BENCH_SCREEN_HEIGHT / 2) };
+		fireRadial(&field, BULLET_KEY, origin, 16, 0.5 + randomBelow(&benchRandom, 20) / 10.0, randomBelow(&benchRandom, 360));
+	}
+}
+
+static void step(int count, Coord offset, Coord player) {
+	saveBulletPositions(&field);
+	moveBullets(&field, offset, 6, 5);
+	cullBullets(&field, SCREEN);
+	benchSink += bulletsNear(&field, player, (Coord){ 6, 6 }, near);
+	topUp(count);
+}
+
+int main(int argc, char *argv[]) {
+	(void)argc; (void)argv;
+	printf("%8s %15s %15s %15s\n", "bullets", "ns/bullet", "us/step", "60Hz budget");
+
+	seedBench();
+
+	FOR_EACH_COUNT(COUNTS, count) {
+		int steps = BULLET_STEPS_TOTAL / count;
+		Coord offset = { BENCH_SCREEN_WIDTH / 2, BENCH_SCREEN_HEIGHT / 2 };
+		Coord player = { BENCH_SCREEN_WIDTH / 2, 200 };
+
+		clearBullets(&field);
+		topUp(count);
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		for(int i=0; i < steps; i++) {
+			offset.x = BENCH_SCREEN_WIDTH / 2 + (i % 64) - 32;
+			step(count, offset, player);
+		}
+		double seconds = benchSecondsSince(start);
+
+		double stepUs = seconds * 1e6 / steps;
+		printf("%8d %15.2f %15.2f %14.2f%%\n", count, stepUs * 1000 / count, stepUs, stepUs * 100 / STEP_BUDGET_US);
+	}
+
+	return 0;
+}
@@ -0,0 +1,229 @@
+#include <math.h>
+#include "bullets.h"
+#include "myc.h"
+
+//Kept to plain maths (no common.c) so mq-bulletbench can link it alone.
+static const double FULL_TURN = 6.28318530717958647692;		//radians, as RADIAN_CIRCLE.
+
+#if defined(__SSE__) || defined(_M_X64)
+#define BULLETS_SSE
+#include <xmmintrin.h>
+#endif
+
+//Bullets are processed 4 at a time. Past count are only stale or zeroed slots, so the last vector
+// can run over into them rather than stopping short.
+static int vectorEnd(int count) {
+	return (count + 3) & ~3;
+}
+
+static float parallaxOf(float at, double offset, double layer) {
+	return layer == 0 ? at : (float)(at + (offset - at) / layer);
+}
+
+void clearBullets(BulletField *field) {
+	field->count = 0;
+	field->spin = 0;
+}
+
+//Fills a slot, already in place (no need to wait for the next move to find its parallax).
+bool fireBullet(BulletField *field, BulletKind kind, Coord origin, Coord velocity) {
+	if(field->count == MAX_BULLETS) {
+		field->dropped++;
+		return false;
+	}
+
+	int i = field->count++;
+	field->x[i] = (float)origin.x;
+	field->y[i] = (float)origin.y;
+	field->velocityX[i] = (float)velocity.x;
+	field->velocityY[i] = (float)velocity.y;
+	field->parallaxX[i] = field->lastParallaxX[i] = parallaxOf(field->x[i], field->offset.x, field->layer);
+	field->parallaxY[i] = field->lastParallaxY[i] = parallaxOf(field->y[i], field->offset.y, field->layer);
+	field->kind[i] = kind;
+
+	return true;
+}
+
+//Bullets at a steady turn from each other. Each heading is the last one rotated, so there's only
+// one sin/cos per arc however many bullets are in it.
+static int fireArc(BulletField *field, BulletKind kind, Coord origin, int count, double speed, double first, double step) {
+	Coord heading = { cos(first) * speed, sin(first) * speed };
+	double turnCos = cos(step), turnSin = sin(step);
+
+	int fired = 0;
+	for(int b=0; b < count; b++) {
+		if(!fireBullet(field, kind, origin, heading)) break;
+		fired++;
+
+		Coord turned = { heading.x * turnCos - heading.y * turnSin, heading.x * turnSin + heading.y * turnCos };
+		heading = turned;
+	}
+
+	return fired;
+}
+
+static double toRadians(double degrees) {
+	return degrees * FULL_TURN / 360;
+}
+
+//Returns how many were fired (fewer than asked once the field's full), as do the other emitters.
+int fireRadial(BulletField *field, BulletKind kind, Coord origin, int count, double speed, double angle) {
+	if(count <= 0) return 0;
+	return fireArc(field, kind, origin, count, speed, toRadians(angle), FULL_TURN / count);
+}
+
+int fireFan(BulletField *field, BulletKind kind, Coord origin, Coord target, int count, double spread, double speed) {
+	if(count <= 0) return 0;
+
+	double aim = atan2(target.y - origin.y, target.x - origin.x);
+	double step = toRadians(spread);
+
+	return fireArc(field, kind, origin, count, speed, aim - step * (count - 1) / 2, step);
+}
+
+//One volley of an emitter's pattern. Radials and spirals start from the given angle, which spirals
+// then turn on ready for their next volley.
+int fireVolley(BulletField *field, const Emitter *emitter, double *angle, Coord origin, Coord target) {
+	switch(emitter->shape) {
+		case EMIT_RADIAL:
+			return fireRadial(field, emitter->kind, origin, emitter->count, emitter->speed, *angle);
+		case EMIT_SPIRAL: {
+			int fired = fireRadial(field, emitter->kind, origin, emitter->count, emitter->speed, *angle);
+			*angle = fmod(*angle + emitter->turn, 360);
+			return fired;
+		}
+		case EMIT_AIMED_FAN:
+			return fireFan(field, emitter->kind, origin, target, emitter->count, emitter->spread, emitter->speed);
+	}
+
+	return 0;
+}
+
+void saveBulletPositions(BulletField *field) {
+	memcpy(field->lastParallaxX, field->parallaxX, field->count * sizeof(float));
+	memcpy(field->lastParallaxY, field->parallaxY, field->count * sizeof(float));
+}
+
+//Moves every bullet along its velocity, and finds its parallax against the given offset (as
+// parallaxEnemies does, with a layer of 0 leaving them where they are).
+void moveBullets(BulletField *field, Coord offset, double layer, double spin) {
+	field->offset = offset;
+	field->layer = layer;
+	field->spin = (float)fmod(field->spin + spin, 360);
+
+	int end = vectorEnd(field->count);
+	float scale = layer == 0 ? 0 : (float)(1 / layer);
+
+#ifdef BULLETS_SSE
+	const __m128 offsetX = _mm_set1_ps((float)offset.x);
+	const __m128 offsetY = _mm_set1_ps((float)offset.y);
+	const __m128 scales = _mm_set1_ps(scale);
+
+	for(int i=0; i < end; i += 4) {
+		__m128 x = _mm_add_ps(_mm_loadu_ps(field->x + i), _mm_loadu_ps(field->velocityX + i));
+		__m128 y = _mm_add_ps(_mm_loadu_ps(field->y + i), _mm_loadu_ps(field->velocityY + i));
+		_mm_storeu_ps(field->x + i, x);
+		_mm_storeu_ps(field->y + i, y);
+		_mm_storeu_ps(field->parallaxX + i, _mm_add_ps(x, _mm_mul_ps(_mm_sub_ps(offsetX, x), scales)));
+		_mm_storeu_ps(field->parallaxY + i, _mm_add_ps(y, _mm_mul_ps(_mm_sub_ps(offsetY, y), scales)));
+	}
+#else
+	for(int i=0; i < end; i++) {
+		field->x[i] += field->velocityX[i];
+		field->y[i] += field->velocityY[i];
+		field->parallaxX[i] = field->x[i] + ((float)offset.x - field->x[i]) * scale;
+		field->parallaxY[i] = field->y[i] + ((float)offset.y - field->y[i]) * scale;
+	}
+#endif
+}
+
+static void releaseBullet(BulletField *field, int i) {
+	int last = --field->count;
+	field->x[i] = field->x[last];
+	field->y[i] = field->y[last];
+	field->velocityX[i] = field->velocityX[last];
+	field->velocityY[i] = field->velocityY[last];
+	field->parallaxX[i] = field->parallaxX[last];
+	field->parallaxY[i] = field->parallaxY[last];
+	field->lastParallaxX[i] = field->lastParallaxX[last];
+	field->lastParallaxY[i] = field->lastParallaxY[last];
+	field->kind[i] = field->kind[last];
+}
+
+//Which of 4 bullets from i (as bits 0-3) are drawn outside the bounds (as made by makeRect).
+static int outsideBounds(const BulletField *field, int i, Rect bounds) {
+#ifdef BULLETS_SSE
+	__m128 x = _mm_loadu_ps(field->parallaxX + i);
+	__m128 y = _mm_loadu_ps(field->parallaxY + i);
+	__m128 outside = _mm_or_ps(
+			_mm_or_ps(_mm_cmplt_ps(x, _mm_set1_ps((float)bounds.x)), _mm_cmpgt_ps(x, _mm_set1_ps((float)bounds.width))),
+			_mm_or_ps(_mm_cmplt_ps(y, _mm_set1_ps((float)bounds.y)), _mm_cmpgt_ps(y, _mm_set1_ps((float)bounds.height))));
+	return _mm_movemask_ps(outside);
+#else
+	int outside = 0;
+	for(int lane=0; lane < 4; lane++) {
+		float x = field->parallaxX[i + lane], y = field->parallaxY[i + lane];
+		if(x < bounds.x || x > bounds.width || y < bounds.y || y > bounds.height) outside |= 1 << lane;
+	}
+	return outside;
+#endif
+}
+
+//Lets go of every bullet drawn outside the bounds. Runs back from the end, so whatever's moved in
+// over a released bullet has always been tested already.
+void cullBullets(BulletField *field, Rect bounds) {
+	for(int i = vectorEnd(field->count) - 4; i >= 0; i -= 4) {
+		int outside = outsideBounds(field, i, bounds);
+		if(outside == 0) continue;
+
+		for(int lane=3; lane >= 0; lane--) {
+			if(outside & 1 << lane && i + lane < field->count) releaseBullet(field, i + lane);
+		}
+	}
+}
+
+//Writes out the bullets drawn within reach of the point on both axes (in field order), returning
+// how many. Only a broad phase: the caller still does the exact test.
+int bulletsNear(const BulletField *field, Coord point, Coord reach, int *found) {
+	int end = vectorEnd(field->count);
+	int count = 0;
+
+#ifdef BULLETS_SSE
+	const __m128 pointX = _mm_set1_ps((float)point.x);
+	const __m128 pointY = _mm_set1_ps((float)point.y);
+	const __m128 reachX = _mm_set1_ps((float)reach.x);
+	const __m128 reachY = _mm_set1_ps((float)reach.y);
+	const __m128 sign = _mm_set1_ps(-0.0f);
+
+	for(int i=0; i < end; i += 4) {
+		__m128 distanceX = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(field->parallaxX + i), pointX));
+		__m128 distanceY = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(field->parallaxY + i), pointY));
+		int near = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(distanceX, reachX), _mm_cmple_ps(distanceY, reachY)));
+		if(near == 0) continue;
+
+		for(int lane=0; lane < 4; lane++) {
+			if(near & 1 << lane && i + lane < field->count) found[count++] = i + lane;
+		}
+	}
+#else
+	for(int i=0; i < field->count; i++) {
+		if(fabsf(field->parallaxX[i] - (float)point.x) <= reach.x && fabsf(field->parallaxY[i] - (float)point.y) <= reach.y) {
+			found[count++] = i;
+		}
+	}
+#endif
+
+	return count;
+}
+
+//Lets go of the given bullets, which have to be in field order (as bulletsNear finds them). Runs
+// back from the last, so none of them is ever the one moved over another.
+void releaseBullets(BulletField *field, const int *found, int count) {
+	for(int f = count - 1; f >= 0; f--) releaseBullet(field, found[f]);
+}
+
+void reportBullets(const BulletField *field) {
+	if(field->dropped > 0) {
+		SDL_Log("The enemy bullet field (%d) was full for %d bullets.", MAX_BULLETS, field->dropped);
+	}
+}
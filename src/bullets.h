@@ -0,0 +1,65 @@
+#ifndef BULLETS_H
+#define BULLETS_H
+
+#include <stdbool.h>
+#include "common.h"
+
+//Room for bullet-hell volleys. A multiple of 4, so the vector passes never need a ragged tail.
+#define MAX_BULLETS 16384
+
+typedef enum {
+	BULLET_VIRUS,		//regular enemy shots.
+	BULLET_KEY,			//the keyboss's.
+	BULLET_KIND_COUNT
+} BulletKind;
+
+//Enemy bullets, one array per field and packed at the front (no gaps), so moving, culling and
+// collision stream through whole vectors of them. Bullets only ever fly straight: aiming is done
+// once, when they're fired. Order isn't kept - letting one go moves the last into its place.
+typedef struct {
+	int count;
+	int dropped;					//bullets fired while full, for reportBullets.
+	Coord offset;					//parallax offset and layer as of the last move, for new bullets.
+	double layer;
+	float spin;						//degrees keys have turned, shared by all of them.
+	float x[MAX_BULLETS];			//where they are, before parallax.
+	float y[MAX_BULLETS];
+	float velocityX[MAX_BULLETS];	//pixels per game step.
+	float velocityY[MAX_BULLETS];
+	float parallaxX[MAX_BULLETS];	//where they're drawn and collide.
+	float parallaxY[MAX_BULLETS];
+	float lastParallaxX[MAX_BULLETS];	//parallax as of the previous game step, to draw between the two.
+	float lastParallaxY[MAX_BULLETS];
+	Uint8 kind[MAX_BULLETS];
+} BulletField;
+
+typedef enum {
+	EMIT_RADIAL,		//evenly around a full circle.
+	EMIT_SPIRAL,		//radial, turning a little between volleys.
+	EMIT_AIMED_FAN		//spread either side of a line to the target.
+} EmitterShape;
+
+//A bullet pattern. Angles are in degrees, clockwise from pointing right (so 90 is straight down).
+typedef struct {
+	EmitterShape shape;
+	BulletKind kind;
+	int count;			//bullets per volley.
+	double speed;		//pixels per game step.
+	double spread;		//degrees between neighbouring bullets in a fan.
+	double turn;		//degrees a spiral turns between volleys.
+	double hertz;		//between volleys, as timer() takes it.
+} Emitter;
+
+extern void clearBullets(BulletField *field);
+extern bool fireBullet(BulletField *field, BulletKind kind, Coord origin, Coord velocity);
+extern int fireRadial(BulletField *field, BulletKind kind, Coord origin, int count, double speed, double angle);
+extern int fireFan(BulletField *field, BulletKind kind, Coord origin, Coord target, int count, double spread, double speed);
+extern int fireVolley(BulletField *field, const Emitter *emitter, double *angle, Coord origin, Coord target);
+extern void saveBulletPositions(BulletField *field);
+extern void moveBullets(BulletField *field, Coord offset, double layer, double spin);
+extern void cullBullets(BulletField *field, Rect bounds);
+extern int bulletsNear(const BulletField *field, Coord point, Coord reach, int *found);
+extern void releaseBullets(BulletField *field, const int *found, int count);
+extern void reportBullets(const BulletField *field);
+
+#endif
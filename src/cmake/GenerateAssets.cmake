@@ -0,0 +1,79 @@
+# Generates the image asset ID enum and register table from the asset manifest.
+#
+# Usage: cmake -DMANIFEST=<assets.csv> -DOUTPUT_DIR=<dir> -P GenerateAssets.cmake
+#
+# Emits:
+#   assetids.h  - AssetId enum (one ASSET_<NAME> per manifest row, plus ASSET_COUNT)
+#   assetdefs.h - AssetDef initialiser rows, in the same order as the enum
+
+if(NOT MANIFEST OR NOT OUTPUT_DIR)
+    message(FATAL_ERROR "GenerateAssets: MANIFEST and OUTPUT_DIR must be set")
+endif()
+
+# Names already taken by AssetVersion and friends in assets.h.
+set(RESERVED ASSET_DEFAULT ASSET_HIT ASSET_SHADOW ASSET_SUPER ASSET_ALPHA ASSET_VERSIONS ASSET_HANDLE_NONE ASSET_COUNT)
+
+file(STRINGS "${MANIFEST}" lines)
+
+set(ids "")
+set(enumBody "")
+set(defsBody "")
+
+foreach(line IN LISTS lines)
+    string(STRIP "${line}" line)
+    if(line STREQUAL "" OR line MATCHES "^#")
+        continue()
+    endif()
+
+    string(REPLACE "," ";" fields "${line}")
+    list(LENGTH fields fieldCount)
+    if(NOT fieldCount EQUAL 6)
+        message(FATAL_ERROR "GenerateAssets: expected 6 fields in '${line}'")
+    endif()
+
+    list(GET fields 0 filename)
+    list(GET fields 1 hit)
+    list(GET fields 2 shadow)
+    list(GET fields 3 super)
+    list(GET fields 4 alpha)
+    list(GET fields 5 background)
+
+    # "virus-shot.png" -> ASSET_VIRUS_SHOT
+    string(REGEX REPLACE "\\.[^.]*$" "" id "${filename}")
+    string(TOUPPER "${id}" id)
+    string(REGEX REPLACE "[^A-Z0-9]" "_" id "${id}")
+    set(id "ASSET_${id}")
+
+    list(FIND RESERVED "${id}" reservedAt)
+    if(NOT reservedAt EQUAL -1)
+        message(FATAL_ERROR "GenerateAssets: '${filename}' maps to reserved name ${id}")
+    endif()
+    list(FIND ids "${id}" existingAt)
+    if(NOT existingAt EQUAL -1)
+        message(FATAL_ERROR "GenerateAssets: '${filename}' maps to duplicate name ${id}")
+    endif()
+    list(APPEND ids "${id}")
+
+    set(flags "")
+    foreach(flag ${hit} ${shadow} ${super} ${alpha} ${background})
+        if(flag STREQUAL "1")
+            set(flags "${flags}, true")
+        else()
+            set(flags "${flags}, false")
+        endif()
+    endforeach()
+
+    set(enumBody "${enumBody}\t${id},\n")
+    set(defsBody "${defsBody}{ \"${filename}\"${flags} },\n")
+endforeach()
+
+set(header "// GENERATED by cmake/GenerateAssets.cmake from assets.csv - do not edit.\n")
+
+file(WRITE "${OUTPUT_DIR}/assetids.h.tmp"
+    "${header}#ifndef ASSETIDS_H\n#define ASSETIDS_H\n\ntypedef enum {\n${enumBody}\tASSET_COUNT\n} AssetId;\n\n#endif\n")
+file(WRITE "${OUTPUT_DIR}/assetdefs.h.tmp" "${header}${defsBody}")
+
+# Only touch the real outputs when they change, so we don't force a rebuild of every includer.
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT_DIR}/assetids.h.tmp" "${OUTPUT_DIR}/assetids.h")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT_DIR}/assetdefs.h.tmp" "${OUTPUT_DIR}/assetdefs.h")
+file(REMOVE "${OUTPUT_DIR}/assetids.h.tmp" "${OUTPUT_DIR}/assetdefs.h.tmp")
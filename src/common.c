@@ -2,10 +2,10 @@
 #include "common.h"
 #include "renderer.h"
 #include <unistd.h>
-#include <time.h>
+#include "game.h"
+#include "trace.h"
 
 SDL_Window *window = NULL;
-GameState gameState;
 
 const bool ENABLE_PARALLAX = true;
 const bool ENABLE_SHADOWS = true;
@@ -24,41 +24,22 @@ const int RENDER_HZ = 1000 / 60;		//60fps
 const int GAME_HZ = 1000 / 60;			//60fps
 const double RADIAN_CIRCLE = 6.28;
 
-bool stateInitialised;
-
-bool isScripted() {
-	return gameState != STATE_GAME;
+bool isScripted(const GameContext *game) {
+	return game->state != STATE_GAME;
 }
 
-void triggerState(GameState newState) {
-	gameState = newState;
-	stateInitialised = false;
+void triggerState(GameContext *game, GameState newState) {
+	traceInstant("triggerState", "state", newState);
+	game->state = newState;
+	game->stateInitialised = false;
 
 	// FIXME: GIANT HACKS for fixing "one visible frame" issue when scripting is wholly responsible
 	// for coordinating scene fade-ins.
 	if(newState == STATE_INTRO || newState == STATE_GAME || newState == STATE_TITLE) {
-		fadeIn();
+		fadeIn(game);
 	}
 }
 
-int randomMq(int min, int max) {
-	return (rand() % (max + 1 - min)) + min;
-}
-
-bool chance(int probability) {
-	//Shortcuts for deterministic scenarios (impossible and always)
-	if(probability == 0) {
-		return false;
-	}else if (probability == 100) {
-		return true;
-	}
-
-	//TODO: Consider simplified randomMq expression based on size of probability (e.g. 50% needs only range of 1).
-
-	int roll = randomMq(0, 100);			//dice roll up to 100 (to match with a percentage-based probability amount)
-	return probability >= roll;			//e.g. 99% is higher than a roll of 5, 50, and 75.
-}
-
 //Constructors
 Coord makeCoord(double x, double y) {
 	Coord coord = { x, y };
@@ -128,62 +109,10 @@ void fatalError(const char *title, const char *message) {
 bool fileExists(const char *path) {
 	return access(path, R_OK ) == 0;
 }
-long ticsToMilliseconds(long tics) {
-	//we want the duration version of the platform-independent seconds, so we / 1000.
-	long platformAgnosticMilliseconds = CLOCKS_PER_SEC / 1000;
-
-	return tics / platformAgnosticMilliseconds;
-}
 int toMilliseconds(int seconds) {
 	return seconds * 1000;
 }
 
-int getPixel(SDL_Surface *surface, int x, int y) {
-	int *pixels = (int *)surface->pixels;
-	return pixels[ ( y * surface->w ) + x ];
-}
-void setPixel(SDL_Surface *surface, int x, int y, Uint32 pixel) {
-	int *pixels = (int *)surface->pixels;
-	pixels[ ( y * surface->w ) + x ] = pixel;
-}
-
-//Note: We offer an additive blend mode, which is different from the multiplicative approach offered by
-//SDL's colour modulate. Also, we operate on a surface, rather than a texture.
-SDL_Surface *colouriseSprite(SDL_Surface *original, Colour colour, ColourisationMethod method) {
-	//Set all opaque pixels as per colour argument.
-	for( int x = 0; x < original->w; x++) {
-		for( int y = 0; y < original->h; y++) {
-			//Obtain alpha channel from pixel
-			int pixel = getPixel(original, x, y);
-			Uint8 oAlpha, or, og, ob;
-			SDL_GetRGBA(pixel, original->format, &or, &og, &ob, &oAlpha);
-
-			//Don't colourise fully-transparent pixels.
-			if(oAlpha == 0) continue;
-
-			Colour final;
-
-			//Set colour to what's supplied without any modulation.
-			if(method == COLOURISE_ABSOLUTE) {
-				final = colour;
-				final.alpha = colour.alpha;
-			//Increase each colour channel value by that of the input colour, and cancel out any channel
-			// that is not in the input - ensuring a complete colourisation every time.
-			}else{
-				final.red = 	colour.red > 0 ? or + colour.red > 255 ? 255 : or + colour.red : 0;
-				final.green = 	colour.green > 0 ? og + colour.green > 255 ? 255 : og + colour.green : 0;
-				final.blue = 	colour.blue > 0 ? ob + colour.blue > 255 ? 255 : ob + colour.blue : 0;
-				final.alpha = 	colour.alpha;
-			}
-
-			setPixel(original, x, y, SDL_MapRGBA(
-				original->format,
-				final.red, final.green, final.blue, final.alpha)
-			);
-		}
-	}
-}
-
 bool inBounds(Coord point, Rect area) {
 	return
 		point.x >= area.x && point.x <= area.width &&
@@ -205,7 +134,7 @@ Rect makeSquareBounds(Coord origin, double size) {
 }
 
 double getFPS(long now, long lastFrameTime) {
-	long timeSinceLast = ticsToMilliseconds(now - lastFrameTime);
+	long timeSinceLast = now - lastFrameTime;
 
 	//Prevent division by zero on first frame.
 	if(timeSinceLast == 0) {
@@ -215,9 +144,10 @@ double getFPS(long now, long lastFrameTime) {
 	}
 }
 
-bool timer(long *lastTime, double hertz){
-	long now = clock();
-	if(due(*lastTime, hertz)) {
+//Timers work in game time (see gameclock.h), in milliseconds.
+bool timer(const GameContext *game, long *lastTime, double hertz){
+	long now = gameTime(game);
+	if(due(game, *lastTime, hertz)) {
 		*lastTime = now;
 		return true;
 	}else{
@@ -225,13 +155,13 @@ bool timer(long *lastTime, double hertz){
 	}
 }
 
-bool dueBetween(long compareTime, double milliseconds, double milliseconds2) {
-	long time = ticsToMilliseconds(clock() - compareTime);
+bool dueBetween(const GameContext *game, long compareTime, double milliseconds, double milliseconds2) {
+	long time = gameTime(game) - compareTime;
 	return time >= milliseconds && time <= milliseconds2;
 }
 
-bool due(long compareTime, double milliseconds) {
-	return ticsToMilliseconds(clock() - compareTime) >= milliseconds;
+bool due(const GameContext *game, long compareTime, double milliseconds) {
+	return gameTime(game) - compareTime >= milliseconds;
 }
 
 double sineInc(double offset, double *sineInc, double frequency, double ampMultiplier) {
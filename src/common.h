@@ -7,6 +7,7 @@
 //#define DEBUG_WINDOW_T500
 #define DEBUG_SKIP_TO_GAME
 //#define DEBUG_CHEATS
+//#define DEBUG_FRAME_TIMING
 
 extern const bool ENABLE_PARALLAX;
 extern const bool ENABLE_SHADOWS;
@@ -20,6 +21,9 @@ extern const int RENDER_HZ;
 extern const int GAME_HZ;
 extern const double RADIAN_CIRCLE;	//2 * pi (or 2 * 3.14)
 
+//One running game's state (see game.h). Declared here, since nearly everything takes one.
+typedef struct GameContext GameContext;
+
 typedef enum {
 	STATE_INTRO = 0,
 	STATE_TITLE = 1,
@@ -29,11 +33,9 @@ typedef enum {
 	STATE_LEVEL_COMPLETE = 5,
 	STATE_STATS = 6
 } GameState;
-GameState gameState;
 
-extern bool isScripted();
-extern bool stateInitialised;
-extern void triggerState(GameState newState);
+extern bool isScripted(const GameContext *game);
+extern void triggerState(GameContext *game, GameState newState);
 
 //COORDINATES
 typedef struct {
@@ -68,24 +70,18 @@ extern Colour makeOpaque(int red, int green, int blue);
 extern Colour makeWhite();
 extern Colour makeBlack();
 
-extern int getPixel(SDL_Surface *surface, int x, int y);
-extern void setPixel(SDL_Surface *surface, int x, int y, Uint32 pixel);
-extern SDL_Surface *colouriseSprite(SDL_Surface *original, Colour colour, ColourisationMethod method);
 
-extern int randomMq(int min, int max);
-extern bool chance(int probability);
 extern char *combineStrings(const char *a, const char *b);
 extern void quit();
 extern void fatalError(const char *title, const char *message);
-extern bool timer(long *lastTime, double hertz);
+extern bool timer(const GameContext *game, long *lastTime, double hertz);
 extern double getFPS(long now, long lastFrameTime);
-extern bool due(long compareTime, double milliseconds);
-extern bool dueBetween(long compareTime, double milliseconds, double milliseconds2);
+extern bool due(const GameContext *game, long compareTime, double milliseconds);
+extern bool dueBetween(const GameContext *game, long compareTime, double milliseconds, double milliseconds2);
 
 extern SDL_Window *window;
 extern bool running;
 extern bool fileExists(const char *path);
-extern long ticsToMilliseconds(long tics);
 extern int toMilliseconds(int seconds);
 extern Coord windowSize;
 
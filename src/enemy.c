@@ -1,64 +1,24 @@
+#include "game.h"
 #include "myc.h"
-#include <time.h>
+#include "gameclock.h"
 #include "renderer.h"
 #include "formations.h"
 #include "enemy.h"
 #include "assets.h"
+#include "animation.h"
 #include "player.h"
 #include "item.h"
 #include "hud.h"
 #include "sound.h"
+#include "trace.h"
 
-#define MAX_SHOTS 500
-#define MAX_SPAWNS 10
-#define MAX_BOOMS 20
-
-typedef struct {
-	Coord origin;
-	Coord parallax;
-	int animFrame;
-	EnemyType enemyType;
-	Coord homeTarget;
-	bool homing;
-	bool isKey;
-	double spinInc;
-} EnemyShot;
-
-typedef struct {
-	Coord origin;
-	int animFrame;
-    double scale;
-} Boom;
-
-typedef struct {
-	double lastSpawnTime;
-	int x;
-	EnemyType type;
-	int max;
-	int count;
-	double speed;
-} EnemySpawn;
-
-EnemySpawn spawns[MAX_SPAWNS];
-Enemy enemies[MAX_ENEMIES];
-int spawnInc = 0;
 const double HEALTH_LIGHT = 1.5;
 const double HEALTH_HEAVY = 5.0;
-bool bossOnscreen = false;
-double bossHealth = 0;
-
-static int boomCount;
-static Boom booms[MAX_BOOMS];
-static int gameTime;
-static int enemyCount;
-static int enemyShotCount;
-static EnemyShot enemyShots[MAX_SHOTS];
-static double rollSine[5] = { 0.0, 1.25, 2.5, 3.75, 5.0 };
-
-static double SHOT_BOSS_HZ = 100;
+//Where each title screen roll call enemy starts its bob.
+static const double ROLL_SINE[ROLL_CALL_SIZE] = { 0.0, 1.25, 2.5, 3.75, 5.0 };
+
 static double SHOT_HZ = 500;
 static double SHOT_SPEED = 1;
-static double BOSS_SHOT_SPEED = 2;
 static double SHOT_DAMAGE = 1;
 
 const int ENEMY_BOUND = 26;
@@ -67,57 +27,52 @@ static double HIT_KNOCKBACK = 0.0;
 static double COLLIDE_DAMAGE = 1;
 static double BOSS_COLLIDE_DAMAGE = 1000;
 
-static const int BOSS_IDLE_FRAMES = 12;
-static const int MAGNET_IDLE_FRAMES = 8;
-static const int CONE_IDLE_FRAMES = 12;
-static const int DISK_IDLE_FRAMES = 12;
-static const int VIRUS_IDLE_FRAMES = 6;
-static const int CD_IDLE_FRAMES = 4;
-static const int BUG_IDLE_FRAMES = 6;
-static const int DEATH_FRAMES = 7;
-static const int MAX_VIRUS_SHOT_FRAMES = 4;
-static const int MAX_PLASMA_SHOT_FRAMES = 2;
+static const double KEY_SPIN = 5;				//degrees boss shots turn each game step.
+static const Coord BULLET_REACH = { 6, 6 };		//half the biggest bullet (virus-shot), to find those near the player.
 
-double dieSpin;
+//What each kind of bullet looks like (and so, collides like).
+static const AssetId BULLET_ASSETS[BULLET_KIND_COUNT] = {
+	[BULLET_VIRUS] = ASSET_VIRUS_SHOT,
+	[BULLET_KEY] = ASSET_KEY_A
+};
 
-static bool bossDeathDir = false;
+//What the keyboss fires through each blast, taking them in turn.
+static const Emitter BOSS_EMITTERS[] = {
+	{ EMIT_AIMED_FAN, BULLET_KEY, 5, 2, 12, 0, 150 },
+	{ EMIT_SPIRAL, BULLET_KEY, 4, 1.5, 0, 17, 60 },
+	{ EMIT_RADIAL, BULLET_KEY, 16, 1.25, 0, 0, 250 },
+};
+static const int BOSS_EMITTER_COUNT = sizeof(BOSS_EMITTERS) / sizeof(Emitter);
 
-bool invalidEnemy(Enemy *enemy) {
+//Whether a live enemy has left the play area (and should be let go of).
+bool invalidEnemy(const GameContext *game, int slot) {
 	// TODO: Use OnScreen/InBounds()?
+	Coord parallax = game->enemy.motion.parallax[slot];
 
 	// Hack here to let intro boss start at the bottom of the screen.
-	bool exceptionForBossIntro = enemy->type != ENEMY_BOSS_INTRO;
+	bool exceptionForBossIntro = game->enemy.enemies[slot].type != ENEMY_BOSS_INTRO;
 
 	return
-		enemy->animFrame == 0 ||
-		enemy->parallax.x < -ENEMY_BOUND*4 ||
-		enemy->parallax.x > screenBounds.x + ENEMY_BOUND*4 ||
-		(enemy->parallax.y > screenBounds.y + ENEMY_BOUND && exceptionForBossIntro);
+		parallax.x < -ENEMY_BOUND*4 ||
+		parallax.x > screenBounds.x + ENEMY_BOUND*4 ||
+		(parallax.y > screenBounds.y + ENEMY_BOUND && exceptionForBossIntro);
 }
 
-static bool invalidEnemyShot(EnemyShot *enemyShot) {
-	return
-			(enemyShot->origin.x == 0 &&
-			 enemyShot->origin.y == 0) ||
-			(enemyShot->parallax.y > screenBounds.y + ENEMY_SHOT_BOUND/2 ||
-			 enemyShot->parallax.x > screenBounds.x + ENEMY_SHOT_BOUND/2 ||
-			 enemyShot->parallax.x < 0 - ENEMY_SHOT_BOUND/2
-			);
+//Where enemy shots are let go of. Bosses fire all ways, so some head up off the screen, but they
+// also fire from above it, so there's a little room above the top.
+static Rect shotBounds() {
+	return makeRect(
+			0 - ENEMY_SHOT_BOUND/2,
+			0 - ENEMY_BOUND*4,
+			screenBounds.x + ENEMY_SHOT_BOUND/2,
+			screenBounds.y + ENEMY_SHOT_BOUND/2);
 }
 
-static Enemy nullEnemy() {
-	Enemy enemy = { };
-	return enemy;
-}
+void hitEnemy(GameContext *game, int slot, double damage, bool collision) {
+	Enemy *enemy = &game->enemy.enemies[slot];
 
-static EnemyShot nullEnemyShot() {
-	EnemyShot enemyShot = { };
-	return enemyShot;
-}
-
-void hitEnemy(Enemy* enemy, double damage, bool collision) {
-	// Don't keep hitting boss if in pain (prevents kamikaze boss cheat)
-	if(pain && enemy->type == ENEMY_BOSS && collision) {
+	// Don't keep hitting boss if in game->player.pain (prevents kamikaze boss cheat)
+	if(game->player.pain && enemy->type == ENEMY_BOSS && collision) {
 		return;
 	}
 
@@ -127,161 +82,203 @@ void hitEnemy(Enemy* enemy, double damage, bool collision) {
 	enemy->collided = collision;
 
 	//Apply knockback by directly altering enemy's Y coordinate (improve with lerping).
-	enemy->origin.y -= HIT_KNOCKBACK;
+	game->enemy.motion.origin[slot].y -= HIT_KNOCKBACK;
 
-	if(bossOnscreen) {
-		bossHealth = enemy->health;
+	if(game->enemy.bossOnscreen) {
+		game->enemy.bossHealth = enemy->health;
 	}
 }
 
-void enemyShadowFrame() {
+//Live counts, for the debug overlay.
+int countEnemies(const GameContext *game) {
+	return game->enemy.enemyPool.count;
+}
+
+int countEnemyShots(const GameContext *game) {
+	return game->enemy.bullets.count;
+}
+
+//Where to draw a bullet, between its last two game steps.
+static Coord bulletCoord(const BulletField *bullets, int b) {
+	return interpolate(
+			makeCoord(bullets->lastParallaxX[b], bullets->lastParallaxY[b]),
+			makeCoord(bullets->parallaxX[b], bullets->parallaxY[b]));
+}
+
+void enemyShadowFrame(GameContext *game) {
+	Enemy *enemies = game->enemy.enemies;
+	EnemyMotion *motion = &game->enemy.motion;
+	const BulletField *bullets = &game->enemy.bullets;
 
 	//Render enemy shadows first (so everything else is above them).
-	for(int i=0; i < MAX_ENEMIES; i++) {
-		if(invalidEnemy(&enemies[i]) || !enemies[i].initialFrameChosen) continue;
+	FOR_EACH_SLOT_IN_ORDER(&game->enemy.enemyPool, i) {
+		if(!enemies[i].initialFrameChosen) continue;
 
         // Permit skipping boss rendering (e.g. delay after visual death).
-        if(enemies[i].type == ENEMY_BOSS && !bossOnscreen) continue;
+        if(enemies[i].type == ENEMY_BOSS && !game->enemy.bossOnscreen) continue;
 
         //Draw shadow, if a shadow version exists for the current frame.
-		SDL_Texture* shadowTexture = getTextureVersion(enemies[i].frameName, ASSET_SHADOW);
-		if(shadowTexture == NULL) continue;
+		const Sprite *shadow = clipFrame(enemies[i].clip, enemies[i].shownFrame, ASSET_SHADOW);
+		if(shadow->texture == NULL) continue;
 
-		Sprite shadow = makeSprite(shadowTexture, zeroCoord(), SDL_FLIP_NONE);
-		Coord shadowCoord = parallax(enemies[i].parallax, PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
+		Coord shadowCoord = parallax(game, interpolate(motion->lastParallax[i], motion->parallax[i]), PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
 		shadowCoord.y += STATIC_SHADOW_OFFSET;
 
-		drawSpriteAbsRotated(shadow, shadowCoord, dieSpin);
+		drawSpriteAbsRotated(*shadow, shadowCoord, game->enemy.dieSpin);
 	}
 
 	//Shot shadows
-	for(int i=0; i < MAX_SHOTS; i++) {
-		if(invalidEnemyShot(&enemyShots[i])) continue;
-
-		//TODO: Fix duplication with enemyRenderFrame here (keep filename?)
-		SDL_Texture *shotTexture;
-		if(enemyShots[i].isKey) {
-			shotTexture = getTextureVersion("key-a.png", ASSET_SHADOW);
-		} else {
-			shotTexture = getTextureVersion("virus-shot.png", ASSET_SHADOW);
-		}
-		Sprite shotShadow = makeSprite(shotTexture, zeroCoord(), SDL_FLIP_VERTICAL);
-		Coord shadowCoord = parallax(enemyShots[i].parallax, PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
+	Sprite shotShadows[BULLET_KIND_COUNT];
+	for(int k=0; k < BULLET_KIND_COUNT; k++) {
+		shotShadows[k] = makeHandleSprite(BULLET_ASSETS[k], ASSET_SHADOW);
+		shotShadows[k].flip = SDL_FLIP_VERTICAL;
+	}
+	for(int b=0; b < bullets->count; b++) {
+		Coord shadowCoord = parallax(game, bulletCoord(bullets, b), PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
 		shadowCoord.y += STATIC_SHADOW_OFFSET;
-		drawSpriteAbs(shotShadow, shadowCoord);
+		drawSpriteAbs(shotShadows[bullets->kind[b]], shadowCoord);
 	}
 }
 
-void enemyBackgroundRenderFrame() {
+void enemyBackgroundRenderFrame(GameContext *game) {
+	Enemy *enemies = game->enemy.enemies;
+	EnemyMotion *motion = &game->enemy.motion;
 	// Just the enemies set to "background"
-	for(int i=0; i < MAX_ENEMIES; i++) {
-		if(invalidEnemy(&enemies[i]) || !enemies[i].initialFrameChosen || !enemies[i].inBackground) continue;
-		drawSpriteAbs(enemies[i].sprite, enemies[i].parallax);
+	FOR_EACH_SLOT_IN_ORDER(&game->enemy.enemyPool, i) {
+		if(!enemies[i].initialFrameChosen || !enemies[i].inBackground) continue;
+		drawSpriteAbs(enemies[i].sprite, interpolate(motion->lastParallax[i], motion->parallax[i]));
 	}
 }
 
-void enemyRenderFrame() {
-	//Render out not-null enemies wherever they may be.
-	for(int i=0; i < MAX_ENEMIES; i++) {
-		if(invalidEnemy(&enemies[i]) || !enemies[i].initialFrameChosen || enemies[i].inBackground) continue;
+void enemyRenderFrame(GameContext *game) {
+	Enemy *enemies = game->enemy.enemies;
+	EnemyMotion *motion = &game->enemy.motion;
+	const BulletField *bullets = &game->enemy.bullets;
+	Boom *booms = game->enemy.booms;
+	//Render out live enemies wherever they may be.
+	FOR_EACH_SLOT_IN_ORDER(&game->enemy.enemyPool, i) {
+		if(!enemies[i].initialFrameChosen || enemies[i].inBackground) continue;
 		
 		// Permit skipping boss rendering (e.g. delay after visual death).
-		if(enemies[i].type == ENEMY_BOSS && !bossOnscreen) continue;
+		if(enemies[i].type == ENEMY_BOSS && !game->enemy.bossOnscreen) continue;
 
-        drawSpriteAbsRotated(enemies[i].sprite, enemies[i].parallax, dieSpin);
-//		drawSpriteAbs(enemies[i].sprite, enemies[i].parallax);
+        drawSpriteAbsRotated(enemies[i].sprite, interpolate(motion->lastParallax[i], motion->parallax[i]), game->enemy.dieSpin);
+//		drawSpriteAbs(enemies[i].sprite, motion->parallax[i]);
 	}
 
 	//Shots
-	for(int i=0; i < MAX_SHOTS; i++) {
-		if(invalidEnemyShot(&enemyShots[i])) continue;
-
-		SDL_Texture *shotTexture;
-		if(enemyShots[i].isKey) {
-			Sprite shotSprite = makeSimpleSprite("key-a.png");
-			enemyShots[i].spinInc = enemyShots[i].spinInc > 360 ? 0 : enemyShots[i].spinInc + 5;
-			drawSpriteAbsRotated(shotSprite, enemyShots[i].parallax, enemyShots[i].spinInc);
+	Sprite keySprite = makeHandleSprite(BULLET_ASSETS[BULLET_KEY], ASSET_DEFAULT);
+	Sprite virusSprite = makeHandleSprite(BULLET_ASSETS[BULLET_VIRUS], ASSET_DEFAULT);
+	virusSprite.flip = SDL_FLIP_VERTICAL;
+	for(int b=0; b < bullets->count; b++) {
+		if(bullets->kind[b] == BULLET_KEY) {
+			drawSpriteAbsRotated(keySprite, bulletCoord(bullets, b), bullets->spin);
 		} else {
-			shotTexture = getTexture("virus-shot.png");
-			Sprite shotSprite = makeSprite(shotTexture, zeroCoord(), SDL_FLIP_VERTICAL);
-			drawSpriteAbs(shotSprite, enemyShots[i].parallax);
+			drawSpriteAbs(virusSprite, bulletCoord(bullets, b));
 		}
 	}
 
 	// Booms
-	for(int i=0; i < MAX_BOOMS; i++) {
-		if (booms[i].origin.x == 0 && booms[i].origin.y == 0) continue;
-		char frameFile[20];
-		char* frameTemplate = "exp-%02d.png";
-
-		sprintf(frameFile, frameTemplate, booms[i].animFrame);
-		Coord boomParallax = parallax(booms[i].origin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_XY, PARALLAX_ADDITIVE);
-		drawSpriteAbsRotated2(makeSimpleSprite(frameFile), boomParallax, 0, booms[i].scale, booms[i].scale);
+	const AnimationClip *boomClip = getClip(CLIP_EXP);
+	FOR_EACH_SLOT_IN_ORDER(&game->enemy.boomPool, i) {
+		const Sprite *frame = clipFrame(boomClip, booms[i].animFrame, ASSET_DEFAULT);
+		Coord boomParallax = parallax(game, booms[i].origin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_XY, PARALLAX_ADDITIVE);
+		drawSpriteAbsRotated2(*frame, boomParallax, 0, booms[i].scale, booms[i].scale);
 	}
 }
 
-void spawnBoom(Coord origin, double scale) {
-	play(chance(50) ? "Explosion14.wav" : "Explosion3.wav");
+void spawnBoom(GameContext *game, Coord origin, double scale) {
+	traceInstant("spawnBoom", NULL, 0);
+	play(chance(&game->random[RANDOM_AUDIO], 50) ? "Explosion14.wav" : "Explosion3.wav");
 
-	boomCount = boomCount > MAX_BOOMS-1 ? 0 : boomCount + 1;
+	int slot = acquireSlot(&game->enemy.boomPool);
+	if(slot < 0) return;
 
 	Boom boom = { origin, 1, (scale == 0.0 ? 1.0 : scale) };
-	booms[boomCount] = boom;
+	game->enemy.booms[slot] = boom;
 }
 
-void animateEnemy() {
+//Frames an enemy idles (and flies about) with, based on its type.
+static const AnimationClip *idleClip(EnemyType type) {
+	switch(type) {
+		case ENEMY_DISK:
+			return getClip(CLIP_DISK);
+		case ENEMY_DISK_BLUE:
+			return getClip(CLIP_DISK_BLUE);
+		case ENEMY_BUG:
+			return getClip(CLIP_BUG);
+		case ENEMY_CD:
+			return getClip(CLIP_CD);
+		case ENEMY_VIRUS:
+			return getClip(CLIP_VIRUS);
+		case ENEMY_CONE:
+			return getClip(CLIP_CONE);
+		case ENEMY_MAGNET:
+			return getClip(CLIP_MAGNET);
+		case ENEMY_BOSS_INTRO:
+			return getClip(CLIP_KEYBOSS_MINI);
+		case ENEMY_BOSS:
+			return getClip(CLIP_KEYBOSS);
+		default:
+			fatalError("Error", "No frames specified for enemy type");
+			return NULL;
+	}
+}
+
+void animateEnemy(GameContext *game) {
+	Enemy *enemies = game->enemy.enemies;
+	EnemyMotion *motion = &game->enemy.motion;
+	Boom *booms = game->enemy.booms;
+	const AnimationClip *boomClip = getClip(CLIP_EXP);
+
 	// Booms
-	for(int i=0; i < MAX_BOOMS; i++) {
-		if (booms[i].origin.x == 0 && booms[i].origin.y == 0) continue;
+	FOR_EACH_SLOT(&game->enemy.boomPool, i) {
 		booms[i].animFrame++;
 
-		if(booms[i].animFrame == DEATH_FRAMES) {
-			booms[i].origin.x = 0;
-			booms[i].origin.y = 0;
+		if(booms[i].animFrame > boomClip->frameCount) {
+			releaseSlot(&game->enemy.boomPool, i);
 			continue;
 		}
 	}
 
-	//Render out not-null enemies wherever they may be.
-	for(int i=0; i < MAX_ENEMIES; i++) {
-		if (invalidEnemy(&enemies[i])) continue;
+	//Animate live enemies wherever they may be.
+	FOR_EACH_SLOT(&game->enemy.enemyPool, i) {
 
-		char frameFile[50];
-		char* animGroupName = NULL;
+		const AnimationClip *clip = NULL;
 		AssetVersion frameVersion = ASSET_DEFAULT;
 		int maxFrames = 0;
 
 		//Freeze animation on dying bosses.
-		if(enemies[i].dying && enemies[i].type == ENEMY_BOSS) {
+		if(motion->dying[i] && enemies[i].type == ENEMY_BOSS) {
 			return;
 		}
 
 		//Death animation
-		if(enemies[i].dying) {
+		if(motion->dying[i]) {
 			//Change animation sequence to explosion (except for bosses)
 			if(enemies[i].animSequence != ENEMY_ANIMATION_DEATH){
 				enemies[i].animSequence = ENEMY_ANIMATION_DEATH;
 				enemies[i].animFrame = 1;
 
 				//Spawn powerup (only in-game, and punish collisions)
-				if(gameState == STATE_GAME && !enemies[i].collided){
+				if(game->state == STATE_GAME && !enemies[i].collided){
 //					if(chance(5) && canSpawn(TYPE_WEAPON)) {
-//						spawnItem(enemies[i].formationOrigin, TYPE_WEAPON);
+//						spawnItem(game, motion->formationOrigin[i], TYPE_WEAPON);
 //					}else if(chance(3) && canSpawn(TYPE_HEALTH)) {
-//						spawnItem(enemies[i].formationOrigin, TYPE_HEALTH);
+//						spawnItem(game, motion->formationOrigin[i], TYPE_HEALTH);
 //					}else if(chance(15)){
-//						spawnItem(enemies[i].formationOrigin, TYPE_FRUIT);
+//						spawnItem(game, motion->formationOrigin[i], TYPE_FRUIT);
 //					}else{
-					spawnItem(enemies[i].formationOrigin, TYPE_COIN);
+					spawnItem(game, motion->formationOrigin[i], TYPE_COIN);
 				}
 			}
-			//Zero if completely dead.
-			else if(enemies[i].animFrame == DEATH_FRAMES){
-				enemies[i] = nullEnemy();
-				raiseScore(10, false);
+			//Let go if completely dead.
+			else if(enemies[i].animFrame > boomClip->frameCount){
+				releaseSlot(&game->enemy.enemyPool, i);
+				raiseScore(game, 10, false);
 				continue;
 			}
-			animGroupName = "exp-%02d.png";
+			clip = boomClip;
 		}
 		//Regular idle animation.
 		else{
@@ -294,56 +291,17 @@ void animateEnemy() {
 				enemies[i].wasHitLastFrame = false;
 			}
 
-			//Select frames based on enemy type.
-			switch(enemies[i].type) {
-				case ENEMY_DISK:
-					animGroupName = "disk-%02d.png";
-					maxFrames = DISK_IDLE_FRAMES;
-					break;
-				case ENEMY_DISK_BLUE:
-					animGroupName = "disk-blue-%02d.png";
-					maxFrames = DISK_IDLE_FRAMES;
-					break;
-				case ENEMY_BUG:
-					animGroupName = "bug-%02d.png";
-					maxFrames = BUG_IDLE_FRAMES;
-					break;
-				case ENEMY_CD:
-					animGroupName = "cd-%02d.png";
-					maxFrames = CD_IDLE_FRAMES;
-					break;
-				case ENEMY_VIRUS:
-					animGroupName = "virus-%02d.png";
-					maxFrames = VIRUS_IDLE_FRAMES;
-					break;
-				case ENEMY_CONE:
-                    animGroupName = "cone-%02d.png";
-					maxFrames = CONE_IDLE_FRAMES;
-					break;
-				case ENEMY_MAGNET:
-					animGroupName = "magnet-%02d.png";
-					maxFrames = MAGNET_IDLE_FRAMES;
-					break;
-				case ENEMY_BOSS_INTRO:
-					animGroupName = "keyboss-mini-%02d.png";
-					maxFrames = 2;
-					break;
-				case ENEMY_BOSS:
-					animGroupName = "keyboss-%02d.png";
-					maxFrames = BOSS_IDLE_FRAMES;
-					break;
-				default:
-					fatalError("Error", "No frames specified for enemy type");
-			}
+			clip = idleClip(enemies[i].type);
+			maxFrames = clip->frameCount;
 		}
 
-		//Select animation frame from above group.
-		sprintf(frameFile, animGroupName, enemies[i].animFrame);
-		SDL_Texture* texture = getTextureVersion(frameFile, frameVersion);
-		enemies[i].sprite = makeSprite(texture, zeroCoord(), SDL_FLIP_NONE);
+		//Select animation frame from above clip.
+		enemies[i].sprite = *clipFrame(clip, enemies[i].animFrame, frameVersion);
 
-		//Record animation frame for shadowing
-		strncpy(enemies[i].frameName, frameFile, sizeof(frameFile));
+		//Record animation frame for shadowing (and collision, which goes by the frame's size and pixels).
+		enemies[i].clip = clip;
+		enemies[i].shownFrame = enemies[i].animFrame;
+		motion->size[i] = getAssetSize(clip->firstFrame + enemies[i].shownFrame - 1);
 
 		//Increment frame count for next frame (NB: absolute death will never get here).
 		enemies[i].animFrame = enemies[i].animFrame == maxFrames ? 1 : enemies[i].animFrame + 1;
@@ -351,328 +309,361 @@ void animateEnemy() {
 		//Flag as being OK to render, now the initial frame is chosen
 		if(!enemies[i].initialFrameChosen) enemies[i].initialFrameChosen = true;
 	}
-
-	//Animate enemy projectiles
-	for(int i=0; i < MAX_SHOTS; i++) {
-		if (invalidEnemyShot(&enemyShots[i])) continue;
-		if(	(enemyShots[i].enemyType == ENEMY_VIRUS && enemyShots[i].animFrame == MAX_VIRUS_SHOT_FRAMES) ||
-			   (enemyShots[i].enemyType == ENEMY_CD && enemyShots[i].animFrame == MAX_PLASMA_SHOT_FRAMES)){
-			enemyShots[i].animFrame = 0;
-		}
-		if(enemyShots[i].animFrame == MAX_VIRUS_SHOT_FRAMES) enemyShots[i].animFrame = 0;
-		enemyShots[i].animFrame++;
-	}
 }
 
-void spawnFormation(int x, EnemyType enemyType, int qty, double speed) {
-	if(spawnInc == MAX_SPAWNS) spawnInc = 0;
+void spawnEnemy(GameContext *game, int x, int y, EnemyType type, EnemyPattern movement, EnemyCombat combat, double speed, double speedX, double swayInc, double health, double frequency, double ampMult) {
+	traceInstant("spawnEnemy", "type", type);
 
-	EnemySpawn s = { clock(), x, enemyType, qty, 0, speed };
-	spawns[spawnInc++] = s;
-}
-
-void spawnEnemy(int x, int y, EnemyType type, EnemyPattern movement, EnemyCombat combat, double speed, double speedX, double swayInc, double health, double frequency, double ampMult) {
-	// Limit Enemy count to array size by looping over the top.
-	// Todo: Consider fixing need for >= (using == bugs out boss explosions sometimes)
-	if(enemyCount >= MAX_ENEMIES) enemyCount = 0;
+	// Drop the spawn if every enemy slot is taken (the pool counts these), rather than overwrite a live one.
+	int slot = acquireSlot(&game->enemy.enemyPool);
+	if(slot < 0) return;
 
 	//Note: We don't bother setting/choosing the initial frame, since all this logic is
 	// centralised in Animate. As a result, we wait until that's been done before considering
-	// it a candidate for rendering (shadowFrame included).
+	// it a candidate for rendering (shadowFrame included). Collision can't wait, so it starts
+	// off with the first idle frame's size and pixels.
 
 	//Build it.
 	Enemy enemy = {
-		makeCoord(x, y),
-		makeCoord(x, y),			//same as origin, so rollcall works OK.
-		makeCoord(x, y),
 		{ },
 		false,
 		health,
 		health,
 		1,
 		ENEMY_ANIMATION_IDLE,
-		false,
 		type,
 		0,
-		speed,
-		speedX,
-		"",
+		idleClip(type),
+		1,
 		false,
 		false,
 		movement,
 		combat,
-		swayInc,
-		swayInc,
 		zeroCoord(),
 		false,
-		clock(),
-		clock(),
+		gameTime(game),
+		gameTime(game),
 		false,
+		0,			//blastCount
+		0,			//volleyAngle
 		0,
-		false,
 		type == ENEMY_BOSS ? BOSS_COLLIDE_DAMAGE : COLLIDE_DAMAGE,
 		0,
 		0,
 		type == ENEMY_BOSS_INTRO,	//nonInteractive
 		type == ENEMY_BOSS_INTRO,	//inBackground
-		frequency,
-		ampMult
 	};
 
 	//Add it to the list of renderables.
-	enemies[enemyCount++] = enemy;
+	game->enemy.enemies[slot] = enemy;
+
+	EnemyMotion *motion = &game->enemy.motion;
+	motion->origin[slot] = makeCoord(x, y);
+	motion->formationOrigin[slot] = makeCoord(x, y);		//same as origin, so rollcall works OK.
+	motion->parallax[slot] = makeCoord(x, y);
+	motion->lastParallax[slot] = makeCoord(x, y);
+	motion->size[slot] = getAssetSize(idleClip(type)->firstFrame);
+	motion->speed[slot] = speed;
+	motion->speedX[slot] = speedX;
+	motion->swayIncX[slot] = swayInc;
+	motion->swayIncY[slot] = swayInc;
+	motion->frequency[slot] = frequency;
+	motion->ampMult[slot] = ampMult;
+	motion->scrollDir[slot] = false;
+	motion->dying[slot] = false;
 
 	if(type == ENEMY_BOSS) {
-		bossOnscreen = true;
-		bossHealth = health;
+		game->enemy.bossOnscreen = true;
+		game->enemy.bossHealth = health;
 	}
 };
 
-static void spawnShot(Enemy* enemy) {
-	if(enemyShotCount == MAX_SHOTS) enemyShotCount = 0;
-
-	play("Laser_Shoot34.wav");
-
-	Coord adjustedShotParallax = parallax(enemy->formationOrigin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_XY, PARALLAX_ADDITIVE);
-	Coord homingStep = getStep(playerOrigin, adjustedShotParallax, enemy->type == ENEMY_BOSS ? BOSS_SHOT_SPEED : SHOT_SPEED, true);
-
-	//TODO: Remove initial texture (not needed - we animate)
-	SDL_Texture* texture = getTexture("virus-shot.png");
-	makeSprite(texture, zeroCoord(), SDL_FLIP_NONE);
-
-	//HACK!
-	if(enemy->type == ENEMY_BOSS) {
-		EnemyShot shot = {
-			deriveCoord(enemy->formationOrigin, 0, 16),
-			enemy->parallax,
-			1,
-			enemy->type,
-			homingStep,
-			enemy->combat == COMBAT_HOMING,
-			enemy->type == ENEMY_BOSS,	// HACK!
-			0
-		};
-		enemyShots[enemyShotCount++] = shot;
-	} else {
-		EnemyShot shot = {
-			deriveCoord(enemy->origin, 0, 8),
-			enemy->parallax,
-			1,
-			enemy->type,
-			homingStep,
-			enemy->combat == COMBAT_HOMING,
-			enemy->type == ENEMY_BOSS,	// HACK!
-			0
-		};
-		enemyShots[enemyShotCount++] = shot;
+//A regular enemy's shot: at the player if it homes, otherwise straight down.
+static void spawnShot(GameContext *game, int enemySlot) {
+	const Enemy *enemy = &game->enemy.enemies[enemySlot];
+	const EnemyMotion *motion = &game->enemy.motion;
+	traceInstant("spawnShot", "enemyType", enemy->type);
+
+	Coord velocity = makeCoord(0, SHOT_SPEED);
+	if(enemy->combat == COMBAT_HOMING) {
+		Coord adjustedShotParallax = parallax(game, motion->formationOrigin[enemySlot], PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_XY, PARALLAX_ADDITIVE);
+		velocity = getStep(game->player.origin, adjustedShotParallax, SHOT_SPEED, true);
+	}
+
+	if(fireBullet(&game->enemy.bullets, BULLET_VIRUS, deriveCoord(motion->origin[enemySlot], 0, 8), velocity)) {
+		play("Laser_Shoot34.wav");
 	}
 }
 
-void resetEnemies() {
-	memset(enemies, 0, sizeof(enemies));
-	memset(enemyShots, 0, sizeof(enemyShots));
-	enemyCount = 0;
-	enemyShotCount = 0;
-	boomCount = 0;
-	bossOnscreen = false;
-	bossHealth = 0;
-    dieSpin = 0;
+static const Emitter *bossEmitter(const Enemy *boss) {
+	return &BOSS_EMITTERS[boss->blastCount % BOSS_EMITTER_COUNT];
 }
 
-void enemyGameFrame() {
+//One volley of the boss's pattern for this blast, from just below its middle (one sound for the lot).
+static void spawnVolley(GameContext *game, int enemySlot) {
+	Enemy *enemy = &game->enemy.enemies[enemySlot];
+	const EnemyMotion *motion = &game->enemy.motion;
+	traceInstant("spawnVolley", "blastCount", enemy->blastCount);
+
+	Coord origin = deriveCoord(motion->formationOrigin[enemySlot], 0, 16);
+
+	//Aim from where the volley's drawn, by shifting the target against its parallax.
+	Coord drawn = parallax(game, origin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_XY, PARALLAX_ADDITIVE);
+	Coord target = deriveCoord(game->player.origin, origin.x - drawn.x, origin.y - drawn.y);
+
+	if(fireVolley(&game->enemy.bullets, bossEmitter(enemy), &enemy->volleyAngle, origin, target) > 0) {
+		play("Laser_Shoot34.wav");
+	}
+}
+
+void resetEnemies(GameContext *game) {
+	clearPool(&game->enemy.enemyPool);
+	clearBullets(&game->enemy.bullets);
+	game->enemy.bossOnscreen = false;
+	game->enemy.bossHealth = 0;
+    game->enemy.dieSpin = 0;
+}
+
+void enemySavePositions(GameContext *game) {
+	saveEnemyPositions(&game->enemy.motion, game->enemy.enemyPool.active, game->enemy.enemyPool.count);
+	saveBulletPositions(&game->enemy.bullets);
+}
+
+//Solid pixels of the frame the enemy's showing.
+const Mask *enemyMask(const GameContext *game, int slot) {
+	const Enemy *enemy = &game->enemy.enemies[slot];
+	return clipFrameMask(enemy->clip, enemy->shownFrame);
+}
+
+//Files the enemies that can still be hit under the grid, for this step's collision tests.
+static void indexEnemies(GameContext *game) {
+	const EnemyMotion *motion = &game->enemy.motion;
+	clearGrid(&game->enemy.grid);
+
+	FOR_EACH_SLOT(&game->enemy.enemyPool, i) {
+		if(motion->dying[i]) continue;
+		addToGrid(&game->enemy.grid, i, makeBounds(motion->parallax[i], motion->size[i].x, motion->size[i].y));
+	}
+}
+
+void enemyGameFrame(GameContext *game) {
+	Enemy *enemies = game->enemy.enemies;
+	EnemyMotion *motion = &game->enemy.motion;
+	Random *random = &game->random[RANDOM_ENEMIES];
+	Random *items = &game->random[RANDOM_ITEMS];
 
 	//Bob enemies in sine pattern.
-	switch(gameState) {
+	switch(game->state) {
 		case STATE_INTRO:
 		case STATE_TITLE:
-			for(int i=0; i < enemyCount; i++) {
+			FOR_EACH_SLOT(&game->enemy.enemyPool, i) {
+				//Only the roll call bobs (they're spawned first, so take the lowest slots).
+				if(i >= ROLL_CALL_SIZE) continue;
+
 				//Increment, looping on 2Pi radians (360 degrees)
-				enemies[i].parallax.y = sineInc(enemies[i].origin.y, &rollSine[i], 0.125, 50);
+				motion->parallax[i].y = sineInc(motion->origin[i].y, &game->enemy.rollSine[i], 0.125, 50);
 			}
 	}
 
 	//Check for killed.
-	switch(gameState) {
+	switch(game->state) {
 		case STATE_INTRO:
 		case STATE_GAME:
-			for (int i = 0; i < MAX_ENEMIES; i++) {
-				//Skip zeroed, or exploding (the explosion can stay where it is).
-				if (invalidEnemy(&enemies[i]) || enemies[i].dying) continue;
+			FOR_EACH_SLOT(&game->enemy.enemyPool, i) {
+				//Skip exploding (the explosion can stay where it is).
+				if (motion->dying[i]) continue;
 
 				//Flag for death sequence.
 				if (enemies[i].health <= 0) {
 					if(enemies[i].type == ENEMY_BOSS) {
 						Mix_PauseMusic();
-						enemies[i].sprite = makeSimpleSprite("keyboss-05.png");
+						enemies[i].sprite = makeHandleSprite(ASSET_KEYBOSS_05, ASSET_DEFAULT);
 					}else{
-						play(chance(50) ? "Explosion14.wav" : "Explosion3.wav");
+						play(chance(&game->random[RANDOM_AUDIO], 50) ? "Explosion14.wav" : "Explosion3.wav");
 					}
 
-					enemies[i].dying = true;
-					enemies[i].fatalTime = clock();
-					enemies[i].boomTime = clock();
+					motion->dying[i] = true;
+					enemies[i].fatalTime = gameTime(game);
+					enemies[i].boomTime = gameTime(game);
 				}
 			}
 	}
 
-	if(gameState != STATE_GAME && gameState != STATE_GAME_OVER) return;
+	if(game->state != STATE_GAME && game->state != STATE_GAME_OVER) {
+		indexEnemies(game);
+		return;
+	}
 
-	//Scroll the enemies down the screen
-	for(int i=0; i < MAX_ENEMIES; i++) {
-		//Skip zeroed.
-		if(invalidEnemy(&enemies[i])) continue;
+	//Let go of any that have left the play area, and play out boss deaths.
+	FOR_EACH_SLOT(&game->enemy.enemyPool, i) {
+		if(invalidEnemy(game, i)) {
+			releaseSlot(&game->enemy.enemyPool, i);
+			continue;
+		}
 
         bool bake = false;
 
 		// Boss explosions.
-		if(enemies[i].dying && enemies[i].type == ENEMY_BOSS) {
+		if(motion->dying[i] && enemies[i].type == ENEMY_BOSS) {
 			// Final death.
-			if(due(enemies[i].fatalTime, 5500)) {
-				enemies[i] = nullEnemy();
-				triggerState(STATE_LEVEL_COMPLETE);
+			if(due(game, enemies[i].fatalTime, 5500)) {
+				releaseSlot(&game->enemy.enemyPool, i);
+				triggerState(game, STATE_LEVEL_COMPLETE);
 				continue;
-			}else if(bossOnscreen && due(enemies[i].fatalTime, 3000)) {
-                fadeInWhite();
+			}else if(game->enemy.bossOnscreen && due(game, enemies[i].fatalTime, 3000)) {
+                fadeInWhite(game);
 				
 				playImportant("boss-blow.wav");
 				playMusic("win-shorter.ogg", 1);
 
                 // Final explosion to hide sprite vanishing.
-                spawnBoom(deriveCoord(enemies[i].formationOrigin, -20, -15), 1);
-                spawnBoom(deriveCoord(enemies[i].formationOrigin, 20, -15), 1);
-                spawnBoom(deriveCoord(enemies[i].formationOrigin, -35, 0), 1);
-                spawnBoom(enemies[i].formationOrigin, 1);
-                spawnBoom(deriveCoord(enemies[i].formationOrigin, 35, 0), 1);
-                spawnBoom(deriveCoord(enemies[i].formationOrigin, -20, 15), 1);
-                spawnBoom(deriveCoord(enemies[i].formationOrigin, 20, 15), 1);
-                bossOnscreen = false;
+                spawnBoom(game, deriveCoord(motion->formationOrigin[i], -20, -15), 1);
+                spawnBoom(game, deriveCoord(motion->formationOrigin[i], 20, -15), 1);
+                spawnBoom(game, deriveCoord(motion->formationOrigin[i], -35, 0), 1);
+                spawnBoom(game, motion->formationOrigin[i], 1);
+                spawnBoom(game, deriveCoord(motion->formationOrigin[i], 35, 0), 1);
+                spawnBoom(game, deriveCoord(motion->formationOrigin[i], -20, 15), 1);
+                spawnBoom(game, deriveCoord(motion->formationOrigin[i], 20, 15), 1);
+                game->enemy.bossOnscreen = false;
 
                 // Toss out rewards ;)
                 for(int k=0; k < 20; k++) {
-                    throwItem(
-                        deriveCoord(enemies[i].formationOrigin, randomMq(-50, 50), randomMq(5, 15)),
-                        chance(80) ? TYPE_COIN : TYPE_FRUIT,
-                        chance(50) ? -1 : 1,
-                        randomMq(160, 220) / 100.0,
-                        randomMq(2, 16) / 10.0
+                    throwItem(game, 
+                        deriveCoord(motion->formationOrigin[i], randomMq(items, -50, 50), randomMq(items, 5, 15)),
+                        chance(items, 80) ? TYPE_COIN : TYPE_FRUIT,
+                        chance(items, 50) ? -1 : 1,
+                        randomMq(items, 160, 220) / 100.0,
+                        randomMq(items, 2, 16) / 10.0
                     );
                 }
 			}
 			// Explosion and shaking drama.
-			else if(bossOnscreen && enemies[i].dying && due(enemies[i].boomTime, 75)) {
+			else if(game->enemy.bossOnscreen && motion->dying[i] && due(game, enemies[i].boomTime, 75)) {
 
-                if(due(enemies[i].fatalTime, 0)) {
+                if(due(game, enemies[i].fatalTime, 0)) {
 
                     // LOTS of explosions.
                     for(int j=0; j < 2; j++) {
-                        spawnBoom(deriveCoord(enemies[i].formationOrigin, randomMq(-60, 60), randomMq(-15, 15)), 1);
-                        enemies[i].boomTime = clock();
+                        spawnBoom(game, deriveCoord(motion->formationOrigin[i], randomMq(random, -60, 60), randomMq(random, -15, 15)), 1);
+                        enemies[i].boomTime = gameTime(game);
                     }
 
-                    if(chance(25)) {
-                        throwItem(
-                            deriveCoord(enemies[i].formationOrigin, randomMq(-40, 40), 10),
+                    if(chance(items, 25)) {
+                        throwItem(game, 
+                            deriveCoord(motion->formationOrigin[i], randomMq(items, -40, 40), 10),
                             TYPE_COIN,
-                            chance(50) ? -1 : 1,
-                            randomMq(100, 160) / 100.0,
-                            randomMq(1, 4) / 10.0
+                            chance(items, 50) ? -1 : 1,
+                            randomMq(items, 100, 160) / 100.0,
+                            randomMq(items, 1, 4) / 10.0
                         );
                     }
 
                     // Pain face >D
-                    SDL_Texture* tex = getTextureVersion("keyboss-01.png", ASSET_HIT);
-                    enemies[i].sprite = makeSprite(tex, zeroCoord(), SDL_FLIP_NONE);
+                    enemies[i].sprite = makeHandleSprite(ASSET_KEYBOSS_01, ASSET_HIT);
 
                     // Shake 'n' bake.
-                    enemies[i].formationOrigin.x += bossDeathDir ? 3 : -3;      // shake from left to right.
-                    enemies[i].formationOrigin.y -= 0.1;	                    	// drop down gradually.
-//                    enemies[i].formationOrigin.x += 0.5;                        // slide across a bit as we tilt.
-//                    dieSpin += 0.8;                                             // tilt (timber!!!)
+                    motion->formationOrigin[i].x += game->enemy.bossDeathDir ? 3 : -3;      // shake from left to right.
+                    motion->formationOrigin[i].y -= 0.1;	                    	// drop down gradually.
+//                    motion->formationOrigin[i].x += 0.5;                        // slide across a bit as we tilt.
+//                    game->enemy.dieSpin += 0.8;                                             // tilt (timber!!!)
 
                 }else{
                     // Explosions.
-                    spawnBoom(deriveCoord(enemies[i].formationOrigin, randomMq(-60, 60), randomMq(-15, 15)), 1);
-                    enemies[i].boomTime = clock();
+                    spawnBoom(game, deriveCoord(motion->formationOrigin[i], randomMq(random, -60, 60), randomMq(random, -15, 15)), 1);
+                    enemies[i].boomTime = gameTime(game);
 
-                    enemies[i].formationOrigin.x += bossDeathDir ? 3 : -3;
+                    motion->formationOrigin[i].x += game->enemy.bossDeathDir ? 3 : -3;
                 }
 
 				// Boss shaking.
-				bossDeathDir = !bossDeathDir;
+				game->enemy.bossDeathDir = !game->enemy.bossDeathDir;
 			}
 		}
+	}
 
-		//Set parallax against the formation origin.
-		enemies[i].parallax = parallax(enemies[i].formationOrigin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_XY, PARALLAX_ADDITIVE);
+	//The rest runs as passes over the live enemies (each a tight loop over a few EnemyMotion arrays),
+	// in the order they used to happen per enemy.
+	const int *live = game->enemy.enemyPool.active;
+	int liveCount = game->enemy.enemyPool.count;
 
-		// If dying - nothing more to do here (explosions can stay where they are).
-		if(enemies[i].dying) continue;
+	//Set parallax against the formation origin.
+	parallaxEnemies(motion, live, liveCount, getParallaxOffset(game), ENABLE_PARALLAX ? PARALLAX_LAYER_FOREGROUND : 0);
 
-		//Scroll them down the screen
-		if(enemies[i].scrollDir) {
-			enemies[i].origin.y -= enemies[i].speed;
-		}else{
-			enemies[i].origin.y += enemies[i].speed;
-		}
+	// If dying - nothing more to do here (explosions can stay where they are).
+	int moving[MAX_ENEMIES];
+	int movingCount = 0;
+	for(int s=0; s < liveCount; s++) {
+		if(!motion->dying[live[s]]) moving[movingCount++] = live[s];
+	}
 
-		//IMPORTANT - the main formation frame.
-		formationFrame(&enemies[i]);
+	//Scroll them down the screen
+	scrollEnemies(motion, moving, movingCount);
 
-		//Have we hit the player? (pass through if dying)
-		Rect enemyBound;
-		if(enemies[i].type == ENEMY_BOSS) { //HACK!
-			enemyBound = makeBounds(enemies[i].parallax, 72, 32);
-		}else{
-			enemyBound = makeSquareBounds(enemies[i].parallax, ENEMY_BOUND);
-		}
-		if(inBounds(playerOrigin, enemyBound) && isSolid() && !enemies[i].nonInteractive) {
-			hitPlayer(enemies[i].collisionDamage);
-			hitEnemy(&enemies[i], playerStrength, true);
+	//IMPORTANT - the main formation frame.
+	formationFrame(game, moving, movingCount);
+
+	indexEnemies(game);
+
+	//Have we hit the player? (pass through if dying, and only those sharing the player's grid cell can have,
+	// by landing on a solid pixel within the box)
+	int nearby[MAX_ENEMIES];
+	int nearbyCount = 0;
+	FOR_EACH_NEAR(&game->enemy.grid, game->player.origin, i) nearby[nearbyCount++] = i;
+
+	int touching[MAX_ENEMIES];
+	int touchingCount = touchingEnemies(motion, nearby, nearbyCount, game->player.origin, touching);
+	for(int t=0; t < touchingCount; t++) {
+		int i = touching[t];
+		if(isSolid(game) && !enemies[i].nonInteractive && maskHolds(enemyMask(game, i), motion->parallax[i], game->player.origin)) {
+			hitPlayer(game, enemies[i].collisionDamage);
+			hitEnemy(game, i, game->player.strength, true);
 		}
+	}
 
-		//Spawn shots.
+	//Spawn shots.
+	for(int s=0; s < movingCount; s++) {
+		int i = moving[s];
 		if((enemies[i].combat == COMBAT_SHOOTER ||
 			enemies[i].combat == COMBAT_HOMING) &&
 		    enemies[i].type != ENEMY_BOSS &&	//HACK!
-		    timer(&enemies[i].lastShotTime, SHOT_HZ) &&
-		    enemies[i].origin.y > 0
+		    timer(game, &enemies[i].lastShotTime, SHOT_HZ) &&
+		    motion->origin[i].y > 0
 		) {
-			spawnShot(&enemies[i]);
+			spawnShot(game, i);
 		}else if(
 			enemies[i].type == ENEMY_BOSS &&
 			enemies[i].blasting &&
-			timer(&enemies[i].lastShotTime, SHOT_BOSS_HZ)
+			timer(game, &enemies[i].lastShotTime, bossEmitter(&enemies[i])->hertz)
 		) {
-			spawnShot(&enemies[i]);
+			spawnVolley(game, i);
 		}
 	}
 
-	//Shots.
-	for(int i=0; i < MAX_SHOTS; i++) {
-		if(invalidEnemyShot(&enemyShots[i])) continue;
-
-		if(enemyShots->homing) {
-			//Home in on target vector.
-			enemyShots[i].origin.x += enemyShots[i].homeTarget.x;
-			enemyShots[i].origin.y += enemyShots[i].homeTarget.y;
-		}else{
-			//Otherwise fire straight down.
-			enemyShots[i].origin.y += SHOT_SPEED;
-		}
-
-		//Parallax it
-		enemyShots[i].parallax = parallax(enemyShots[i].origin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_XY, PARALLAX_ADDITIVE);
-
-		//Hit the player?
-		Rect shotBounds = makeSquareBounds(enemyShots[i].parallax, ENEMY_SHOT_BOUND);
-		if(playerState != PSTATE_DYING && inBounds(playerOrigin, shotBounds)) {
-			hitPlayer(SHOT_DAMAGE);
-			enemyShots[i] = nullEnemyShot();
-		}
+	//Shots: move them all and let go of those that have left the screen, then see which have hit the
+	// player (those within reach, that land a solid pixel on it).
+	BulletField *bullets = &game->enemy.bullets;
+	moveBullets(bullets, getParallaxOffset(game), ENABLE_PARALLAX ? PARALLAX_LAYER_FOREGROUND : 0, KEY_SPIN);
+	cullBullets(bullets, shotBounds());
+
+	int near[MAX_BULLETS];
+	int nearCount = bulletsNear(bullets, game->player.origin, BULLET_REACH, near);
+	int hitCount = 0;
+	for(int n=0; n < nearCount && game->player.state != PSTATE_DYING; n++) {
+		int b = near[n];
+		const Mask *shotMask = getAssetMask(BULLET_ASSETS[bullets->kind[b]]);
+		if(!maskHolds(shotMask, makeCoord(bullets->parallaxX[b], bullets->parallaxY[b]), game->player.origin)) continue;
+
+		hitPlayer(game, SHOT_DAMAGE);
+		near[hitCount++] = b;
 	}
+	releaseBullets(bullets, near, hitCount);
 }
 
-void enemyInit() {
-	resetEnemies();
-	animateEnemy();
+void enemyInit(GameContext *game) {
+	memcpy(game->enemy.rollSine, ROLL_SINE, sizeof(ROLL_SINE));
+	initPool(&game->enemy.enemyPool, "enemy", game->enemy.enemySlots, MAX_ENEMIES);
+	initGrid(&game->enemy.grid, game->enemy.gridSlots, MAX_ENEMIES);
+	initPool(&game->enemy.boomPool, "boom", game->enemy.boomSlots, MAX_BOOMS);
+	resetEnemies(game);
+	animateEnemy(game);
 }
\ No newline at end of file
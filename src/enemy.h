@@ -3,8 +3,14 @@
 
 #include "common.h"
 #include "renderer.h"
+#include "animation.h"
+#include "pool.h"
+#include "enemymotion.h"
+#include "grid.h"
+#include "bullets.h"
 
-#define MAX_ENEMIES 200
+#define MAX_BOOMS 20
+#define ROLL_CALL_SIZE 5
 
 typedef enum {
 	ENEMY_ANIMATION_IDLE = 0,
@@ -57,59 +63,78 @@ typedef enum {
 	COMBAT_HOMING
 } EnemyCombat;
 
+//The rest of an enemy (see EnemyMotion for where it is and how it moves).
 typedef struct {
-	Coord origin;
-	Coord formationOrigin;
-	Coord parallax;
 	Sprite sprite;
 	bool hitAnimate;
 	double health;
 	double strength;		//how resistent enemy is to knockbacks.
 	int animFrame;
 	EnemyAnimation animSequence;
-	bool dying;
 	EnemyType type;
 	long lastShotTime;
-	double speed;
-	double speedX;
-	char frameName[50];
+	const AnimationClip *clip;		//current animation, and the frame of it being shown.
+	int shownFrame;
 	bool wasHitLastFrame;
 	bool initialFrameChosen;
 	EnemyPattern movement;
 	EnemyCombat combat;
-	double swayIncX;
-	double swayIncY;
 	Coord offset;
 	bool collided;
 	long spawnTime;
 	long lastBlastTime;
 	bool blasting;
+	int blastCount;			//blasts started, to pick the boss's pattern for each.
+	double volleyAngle;		//where its radial and spiral volleys start from.
 	int scriptInc;
-	bool scrollDir;
 	double collisionDamage;
 	long boomTime;
 	long fatalTime;
 	bool nonInteractive;
 	bool inBackground;
-	double frequency;
-	double ampMult;
 } Enemy;
 
-extern double bossHealth;
-extern bool bossOnscreen;
-extern void spawnBoom(Coord origin, double scale);
+typedef struct {
+	Coord origin;
+	int animFrame;
+    double scale;
+} Boom;
+
+//Enemies, their shots and explosions, and the boss.
+typedef struct {
+	Enemy enemies[MAX_ENEMIES];
+	EnemyMotion motion;
+	Pool enemyPool;
+	int enemySlots[POOL_STORAGE(MAX_ENEMIES)];
+	Grid grid;				//enemies that can be hit, as of this game step.
+	int gridSlots[GRID_STORAGE(MAX_ENEMIES)];
+	BulletField bullets;	//their shots.
+	Boom booms[MAX_BOOMS];
+	Pool boomPool;
+	int boomSlots[POOL_STORAGE(MAX_BOOMS)];
+	double rollSine[ROLL_CALL_SIZE];
+	double dieSpin;
+	bool bossDeathDir;
+	bool bossOnscreen;
+	double bossHealth;
+} EnemyContext;
+
+extern void spawnBoom(GameContext *game, Coord origin, double scale);
 extern const double HEALTH_LIGHT;
-extern bool invalidEnemy(Enemy* enemy);
-extern void resetEnemies();
-extern void spawnEnemy(int x, int y, EnemyType type, EnemyPattern movement, EnemyCombat combat, double speed, double speedX, double swayInc, double health, double frequency, double ampMult);
-extern void hitEnemy(Enemy* enemy, double damage, bool collision);
+extern bool invalidEnemy(const GameContext *game, int slot);
+extern const Mask *enemyMask(const GameContext *game, int slot);
+extern void resetEnemies(GameContext *game);
+extern void spawnEnemy(GameContext *game, int x, int y, EnemyType type, EnemyPattern movement, EnemyCombat combat, double speed, double speedX, double swayInc, double health, double frequency, double ampMult);
+extern void hitEnemy(GameContext *game, int slot, double damage, bool collision);
 extern const int ENEMY_BOUND;
-extern Enemy enemies[MAX_ENEMIES];
-extern void enemyInit();
-extern void enemyShadowFrame();
-extern void enemyBackgroundRenderFrame();
-extern void enemyRenderFrame();
-extern void enemyGameFrame();
-extern void animateEnemy();
+extern void enemyInit(GameContext *game);
+extern int countEnemies(const GameContext *game);
+extern int countEnemyShots(const GameContext *game);
+extern void enemyShadowFrame(GameContext *game);
+extern void enemyBackgroundRenderFrame(GameContext *game);
+extern void enemyRenderFrame(GameContext *game);
+extern void enemyGameFrame(GameContext *game);
+extern void enemySavePositions(GameContext *game);
+extern void animateEnemy(GameContext *game);
 
 #endif
\ No newline at end of file
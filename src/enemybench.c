@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include "mysdl.h"
+#include "enemymotion.h"
+#include "bench.h"
+
+//Times the per-step enemy passes (save positions, parallax, scroll, player collision) over the split
+// EnemyMotion store, against the same work on whole enemy records laid out as before the split. Built
+// with MAX_ENEMIES raised (see CMakeLists.txt) so the stress count fits in one store.
+
+#define ENEMY_STEPS_TOTAL 20000000		//enemy updates per run, whatever the count.
+
+static const int COUNTS[] = { 200, 10000 };
+
+//An Enemy record from before the split (344 bytes on 64-bit): the hot fields strung out between
+// the sprite, health, animation and timing fields.
+typedef struct {
+	Coord origin;
+	Coord formationOrigin;
+	Coord parallax;
+	char sprite[120];
+	double speed;
+	double speedX;
+	char animation[24];
+	double swayIncX;
+	double swayIncY;
+	char timing[64];
+	double frequency;
+	double ampMult;
+	Coord lastParallax;
+	Coord size;
+	bool scrollDir;
+	bool dying;
+} RecordEnemy;
+
+static EnemyMotion motion;
+static RecordEnemy records[MAX_ENEMIES];
+static int slots[MAX_ENEMIES];
+static int touching[MAX_ENEMIES];
+
+//Scatters enemies over the screen, with the slot list shuffled as a pool's active list ends up.
+static void fill(int count) {
+	for(int i=0; i < count; i++) {
+		Coord at = benchScatter();
+		double speed = randomBelow(&benchRandom, 20) / 10.0;
+
+		motion.origin[i] = motion.formationOrigin[i] = motion.parallax[i] = motion.lastParallax[i] = at;
+		motion.size[i] = (Coord){ 26, 26 };
+		motion.speed[i] = speed;
+		motion.scrollDir[i] = randomBelow(&benchRandom, 8) == 0;
+		motion.dying[i] = false;
+
+		RecordEnemy record = { at, at, at };
+		record.lastParallax = at;
+		record.size = motion.size[i];
+		record.speed = speed;
+		record.scrollDir = motion.scrollDir[i];
+		records[i] = record;
+
+		slots[i] = i;
+	}
+
+	for(int i=count - 1; i > 0; i--) {
+		int j = randomBelow(&benchRandom, i + 1);
+		int swap = slots[i];
+		slots[i] = slots[j];
+		slots[j] = swap;
+	}
+}
+
+static void stepMotion(int count, Coord offset, Coord player) {
+	saveEnemyPositions(&motion, slots, count);
+	parallaxEnemies(&motion, slots, count, offset, 6);
+	scrollEnemies(&motion, slots, count);
+	benchSink += touchingEnemies(&motion, slots, count, player, touching);
+}
+
+//The same passes, a record at a time.
+static void stepRecords(int count, Coord offset, Coord player) {
+	for(int s=0; s < count; s++) {
+		RecordEnemy *e = &records[slots[s]];
+		e->lastParallax = e->parallax;
+	}
+	for(int s=0; s < count; s++) {
+		RecordEnemy *e = &records[slots[s]];
+		e->parallax.x = e->formationOrigin.x + (offset.x - e->formationOrigin.x) / 6;
+		e->parallax.y = e->formationOrigin.y + (offset.y - e->formationOrigin.y) / 6;
+	}
+	for(int s=0; s < count; s++) {
+		RecordEnemy *e = &records[slots[s]];
+		e->origin.y += e->scrollDir ? -e->speed : e->speed;
+	}
+	int found = 0;
+	for(int s=0; s < count; s++) {
+		RecordEnemy *e = &records[slots[s]];
+		if(player.x >= e->parallax.x - e->size.x / 2 && player.x <= e->parallax.x + e->size.x / 2 &&
+		   player.y >= e->parallax.y - e->size.y / 2 && player.y <= e->parallax.y + e->size.y / 2) {
+			touching[found++] = slots[s];
+		}
+	}
+	benchSink += found;
+}
+
+static double timeSteps(void (*step)(int, Coord, Coord), int count) {
+	int steps = ENEMY_STEPS_TOTAL / count;
+	Coord offset = { BENCH_SCREEN_WIDTH / 2, BENCH_SCREEN_HEIGHT / 2 };
+	Coord player = { BENCH_SCREEN_WIDTH / 2, 200 };
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for(int i=0; i < steps; i++) {
+		offset.x = BENCH_SCREEN_WIDTH / 2 + (i % 64) - 32;
+		step(count, offset, player);
+	}
+
+	return benchSecondsSince(start) * 1e9 / ((double)steps * count);
+}
+
+int main(int argc, char *argv[]) {
+	(void)argc; (void)argv;
+	printf("%8s %15s %15s\n", "enemies", "split ns/enemy", "record ns/enemy");
+
+	seedBench();
+
+	FOR_EACH_COUNT(COUNTS, count) {
+		if(count > MAX_ENEMIES) {
+			printf("%8d (over MAX_ENEMIES, skipped)\n", count);
+			continue;
+		}
+
+		fill(count);
+		double split = timeSteps(stepMotion, count);
+		double record = timeSteps(stepRecords, count);
+		printf("%8d %15.2f %15.2f\n", count, split, record);
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include <string.h>
+#include "enemymotion.h"
+
+void saveEnemyPositions(EnemyMotion *motion, const int *slots, int count) {
+	for(int s=0; s < count; s++) {
+		int i = slots[s];
+		motion->lastParallax[i] = motion->parallax[i];
+	}
+}
+
+//Foreground parallax (both axes, additive) of each formation origin against the given offset, as
+// parallax() does one coordinate at a time. A layer of 0 leaves them where they are.
+void parallaxEnemies(EnemyMotion *motion, const int *slots, int count, Coord offset, double layer) {
+	if(layer == 0) {
+		for(int s=0; s < count; s++) motion->parallax[slots[s]] = motion->formationOrigin[slots[s]];
+		return;
+	}
+
+	for(int s=0; s < count; s++) {
+		int i = slots[s];
+		Coord from = motion->formationOrigin[i];
+		motion->parallax[i].x = from.x + (offset.x - from.x) / layer;
+		motion->parallax[i].y = from.y + (offset.y - from.y) / layer;
+	}
+}
+
+//Scrolls each enemy down the screen (or up, if it's turned around).
+void scrollEnemies(EnemyMotion *motion, const int *slots, int count) {
+	for(int s=0; s < count; s++) {
+		int i = slots[s];
+		motion->origin[i].y += motion->scrollDir[i] ? -motion->speed[i] : motion->speed[i];
+	}
+}
+
+//Writes out the slots whose collision box holds the point (in list order), returning how many.
+int touchingEnemies(const EnemyMotion *motion, const int *slots, int count, Coord point, int *touching) {
+	int found = 0;
+
+	for(int s=0; s < count; s++) {
+		int i = slots[s];
+		double halfWidth = motion->size[i].x / 2;
+		double halfHeight = motion->size[i].y / 2;
+
+		if(point.x >= motion->parallax[i].x - halfWidth && point.x <= motion->parallax[i].x + halfWidth &&
+		   point.y >= motion->parallax[i].y - halfHeight && point.y <= motion->parallax[i].y + halfHeight) {
+			touching[found++] = i;
+		}
+	}
+
+	return found;
+}
+
+//Narrows the ray's span to where it's between one pair of a box's sides (the slab method), returning
+// false once nothing's left. Takes the direction's reciprocal, so the sides cost multiplies rather
+// than divides.
+static bool clipToSlab(double origin, double direction, double inverse, double low, double high, double *near, double *far) {
+	if(direction == 0) return origin >= low && origin <= high;
+
+	double enter = (low - origin) * inverse;
+	double leave = (high - origin) * inverse;
+	if(enter > leave) {
+		double swap = enter;
+		enter = leave;
+		leave = swap;
+	}
+
+	if(enter > *near) *near = enter;
+	if(leave < *far) *far = leave;
+	return *near <= *far;
+}
+
+static int compareRayHits(const void *a, const void *b) {
+	double difference = ((const RayHit *)a)->distance - ((const RayHit *)b)->distance;
+	return difference < 0 ? -1 : difference > 0;
+}
+
+//Writes out the slots whose collision box the ray meets within length (in multiples of the direction),
+// nearest first, keeping only the nearest maxHits (1 for just the first), and returns how many. Each
+// hit's distance is where the ray enters the box (0 if it starts inside). Each slot should only be
+// listed once (as slotsAlongRay and a pool's active list do).
+int raycastEnemies(const EnemyMotion *motion, const int *slots, int count, Coord origin, Coord direction, double length, RayHit *hits, int maxHits) {
+	double inverseX = 1 / direction.x, inverseY = 1 / direction.y;
+	bool keepAll = maxHits >= count;		//then there's room to gather them all, and sort once.
+	int found = 0;
+
+	for(int s=0; s < count; s++) {
+		int i = slots[s];
+		double halfWidth = motion->size[i].x / 2;
+		double halfHeight = motion->size[i].y / 2;
+
+		double near = 0, far = length;
+		if(!clipToSlab(origin.x, direction.x, inverseX, motion->parallax[i].x - halfWidth, motion->parallax[i].x + halfWidth, &near, &far) ||
+		   !clipToSlab(origin.y, direction.y, inverseY, motion->parallax[i].y - halfHeight, motion->parallax[i].y + halfHeight, &near, &far)) {
+			continue;
+		}
+
+		if(keepAll) {
+			hits[found++] = (RayHit){ i, near };
+			continue;
+		}
+
+		//Otherwise find its place among the nearest so far.
+		int low = 0, high = found;
+		while(low < high) {
+			int middle = (low + high) / 2;
+			if(hits[middle].distance > near) high = middle;
+			else low = middle + 1;
+		}
+		int at = low;
+		if(at == maxHits) continue;
+
+		if(found < maxHits) found++;
+		memmove(hits + at + 1, hits + at, (found - 1 - at) * sizeof(RayHit));
+		hits[at] = (RayHit){ i, near };
+	}
+
+	if(keepAll) qsort(hits, found, sizeof(RayHit), compareRayHits);
+	return found;
+}
@@ -0,0 +1,44 @@
+#ifndef ENEMYMOTION_H
+#define ENEMYMOTION_H
+
+#include <stdbool.h>
+#include "common.h"
+
+//The benchmark build raises this to size the store for stress counts.
+#ifndef MAX_ENEMIES
+#define MAX_ENEMIES 200
+#endif
+
+//The enemy fields touched every game step, one array per field and indexed by enemy slot, so the
+// movement, parallax and collision passes stream through packed doubles. Everything else about an
+// enemy (sprite, health, timers, flags) stays in its Enemy record.
+typedef struct {
+	Coord origin[MAX_ENEMIES];
+	Coord formationOrigin[MAX_ENEMIES];	//origin plus the formation's own movement.
+	Coord parallax[MAX_ENEMIES];			//where it's drawn and collides.
+	Coord lastParallax[MAX_ENEMIES];		//parallax as of the previous game step, to draw between the two.
+	Coord size[MAX_ENEMIES];				//collision box.
+	double speed[MAX_ENEMIES];
+	double speedX[MAX_ENEMIES];
+	double swayIncX[MAX_ENEMIES];
+	double swayIncY[MAX_ENEMIES];
+	double frequency[MAX_ENEMIES];
+	double ampMult[MAX_ENEMIES];
+	bool scrollDir[MAX_ENEMIES];			//true while scrolling up the screen.
+	bool dying[MAX_ENEMIES];
+} EnemyMotion;
+
+//An enemy a ray meets, and how far along the ray it does.
+typedef struct {
+	int slot;
+	double distance;
+} RayHit;
+
+//Passes over a list of enemy slots (e.g. a pool's active list).
+extern void saveEnemyPositions(EnemyMotion *motion, const int *slots, int count);
+extern void parallaxEnemies(EnemyMotion *motion, const int *slots, int count, Coord offset, double layer);
+extern void scrollEnemies(EnemyMotion *motion, const int *slots, int count);
+extern int touchingEnemies(const EnemyMotion *motion, const int *slots, int count, Coord point, int *touching);
+extern int raycastEnemies(const EnemyMotion *motion, const int *slots, int count, Coord origin, Coord direction, double length, RayHit *hits, int maxHits);
+
+#endif
@@ -1,6 +1,7 @@
-#include <time.h>
+#include "gameclock.h"
 #include "formations.h"
 #include "enemy.h"
+#include "game.h"
 #include "myc.h"
 
 static void incScript(Enemy *e, int toMove) {
@@ -11,154 +12,163 @@ static bool onInc(Enemy *e, int thisInc) {
 	return e->scriptInc == thisInc;
 }
 
-static bool scriptDue(Enemy* e, int time) {
-	return due(e->spawnTime, time);
+static bool scriptDue(const GameContext *game, Enemy* e, int time) {
+	return due(game, e->spawnTime, time);
 }
 
-static void applyFormation(Enemy *e) {
-	e->formationOrigin = e->origin;
+static void applyFormation(EnemyMotion *m, int i) {
+	m->formationOrigin[i] = m->origin[i];
 }
 
-static void left(Enemy* e) {
-	e->origin.x -= e->speedX;
+static void left(EnemyMotion *m, int i) {
+	m->origin[i].x -= m->speedX[i];
 }
 
-static void right(Enemy* e) {
-	e->origin.x += e->speedX;
+static void right(EnemyMotion *m, int i) {
+	m->origin[i].x += m->speedX[i];
 }
 
-void formationFrame(Enemy* e) {
-	switch(e->movement) {
-
-		// SPIN -------------------------------------------------
-		case P_SWIRL_LEFT:
-			e->origin.x = sineInc(e->origin.x, &e->swayIncX, -e->speedX, 2);
-			applyFormation(e);
-			break;
-		case P_SWIRL_RIGHT:
-			e->origin.x = sineInc(e->origin.x, &e->swayIncX, e->speedX, 2);
-			applyFormation(e);
-			break;
-
-		// CURVE -------------------------------------------------
-		case P_PEEL_RIGHT:
-			if(scriptDue(e, 1000)) {
-				e->origin.x = sineInc(e->origin.x, &e->swayIncX, e->frequency, -e->ampMult);
-//				e->origin.x = sineInc(e->origin.x, &e->swayIncX, -e->speedX, 7);
-			}
-			applyFormation(e);
-			break;
-		case P_PEEL_LEFT:
-			if(scriptDue(e, 1000)) {
-				e->origin.x = sineInc(e->origin.x, &e->swayIncX, e->frequency, e->ampMult);
-//				e->origin.x = sineInc(e->origin.x, &e->swayIncX, e->speedX, 7);
-			}
-			applyFormation(e);
-			break;
-
-		// CURVE -------------------------------------------------
-		case P_CURVE_RIGHT:
-			if(scriptDue(e, 550) && e->origin.x < 190 && onInc(e, 0)) {
-				right(e);
-			} else if(scriptDue(e, 1750) && e->origin.x > 150) {
-				left(e); incScript(e, 0);
-			}
-			applyFormation(e);
-			break;
-		case P_CURVE_LEFT:
-			if(scriptDue(e, 550) && e->origin.x > 80 && onInc(e, 0)) {
-				left(e);
-			} else if(scriptDue(e, 1750) && e->origin.x < 120) {
-				right(e); incScript(e, 0);
-			}
-			applyFormation(e);
-			break;
-
-		// SNAKE -------------------------------------------------
-		case P_SNAKE_RIGHT:
-			e->origin.x = sineInc(e->origin.x, &e->swayIncX, e->speedX, 1.2);
-			applyFormation(e);
-			break;
-		case P_SNAKE_LEFT:
-			e->origin.x = sineInc(e->origin.x, &e->swayIncX, -e->speedX, 1.2);
-			applyFormation(e);
-			break;
-
-		// SNAKE_WIDE -------------------------------------------------
-		case P_CROSS_RIGHT:
-			e->origin.x = sineInc(e->origin.x, &e->swayIncX, e->frequency, e->ampMult);
-			applyFormation(e);
-			break;
-		case P_CROSS_LEFT:
-			e->origin.x = sineInc(e->origin.x, &e->swayIncX, -e->frequency, e->ampMult);
-			applyFormation(e);
-			break;
-
-		// STRAFER -------------------------------------------------
-		case P_STRAFE_RIGHT:
-			if(scriptDue(e, 1000))
-				e->origin.x += e->speedX;
-
-			applyFormation(e);
-			break;
-		case P_STRAFE_LEFT:
-			if(scriptDue(e, 1000))
-				e->origin.x -= e->speedX;
-
-			applyFormation(e);
-			break;
-
-		case PATTERN_BOSS_INTRO:
-			if(e->scriptInc == 0) {
-				e->scrollDir = true;
-				e->scriptInc++;
-			}
-			e->formationOrigin.y = e->origin.y;
-			break;
-
-		case PATTERN_BOSS:
-			// Scroll down to the middle of the screen.
-			if(scriptDue(e, 4000) && e->scriptInc == 0) {
-				e->scrollDir = !e->scrollDir;
-				e->spawnTime = clock(); //HACK!
-				e->scriptInc++;
-			// Now scroll up and down.
-			} else if(scriptDue(e, 2250) && e->scriptInc == 1) {
-				e->scrollDir = !e->scrollDir;
-				e->spawnTime = clock(); //HACK!
-			}
-			e->formationOrigin.y = e->origin.y;
-
-			// Blasts.
-			if(due(e->lastBlastTime, 1000)) {
-				e->blasting = !e->blasting;
-				e->lastBlastTime = clock();
-			}
-
-			// Sway him from side to side.
-			e->formationOrigin.x = sineInc(e->origin.x, &e->swayIncX, e->frequency, e->ampMult);
-
-			break;
-
-		case PATTERN_CIRCLE:
-			//TODO: Find out why swayIncX and swayIncY need to be swapped :p
-			e->formationOrigin.y = sineInc(e->origin.y, &e->swayIncX, e->frequency, e->ampMult);
-			e->formationOrigin.x = cosInc(e->origin.x, &e->swayIncY, e->frequency, e->ampMult);
-			break;
-		case PATTERN_SNAKE:
-			e->formationOrigin.x = sineInc(e->origin.x, &e->swayIncX, e->frequency, e->ampMult);
-			e->formationOrigin.y = e->origin.y;
-			break;
-		case PATTERN_SNAKE_REV:
-			e->formationOrigin.x = sineInc(e->origin.x, &e->swayIncX, e->frequency, -e->ampMult);
-			e->formationOrigin.y = e->origin.y;
-			break;
-		case PATTERN_BOB:
-			e->formationOrigin.x = e->origin.x;
-			e->formationOrigin.y = sineInc(e->origin.y, &e->swayIncY, 0.075, 12);;
-			break;
-		default:
-			e->formationOrigin = e->origin;
-			break;
+//Moves each of the given enemies along its formation pattern.
+void formationFrame(GameContext *game, const int *slots, int count) {
+	EnemyMotion *m = &game->enemy.motion;
+
+	for(int s=0; s < count; s++) {
+		int i = slots[s];
+		Enemy *e = &game->enemy.enemies[i];
+
+		switch(e->movement) {
+
+			// SPIN -------------------------------------------------
+			case P_SWIRL_LEFT:
+				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], -m->speedX[i], 2);
+				applyFormation(m, i);
+				break;
+			case P_SWIRL_RIGHT:
+				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->speedX[i], 2);
+				applyFormation(m, i);
+				break;
+
+			// CURVE -------------------------------------------------
+			case P_PEEL_RIGHT:
+				if(scriptDue(game, e, 1000)) {
+					m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->frequency[i], -m->ampMult[i]);
+	//				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], -m->speedX[i], 7);
+				}
+				applyFormation(m, i);
+				break;
+			case P_PEEL_LEFT:
+				if(scriptDue(game, e, 1000)) {
+					m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->frequency[i], m->ampMult[i]);
+	//				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->speedX[i], 7);
+				}
+				applyFormation(m, i);
+				break;
+
+			// CURVE -------------------------------------------------
+			case P_CURVE_RIGHT:
+				if(scriptDue(game, e, 550) && m->origin[i].x < 190 && onInc(e, 0)) {
+					right(m, i);
+				} else if(scriptDue(game, e, 1750) && m->origin[i].x > 150) {
+					left(m, i); incScript(e, 0);
+				}
+				applyFormation(m, i);
+				break;
+			case P_CURVE_LEFT:
+				if(scriptDue(game, e, 550) && m->origin[i].x > 80 && onInc(e, 0)) {
+					left(m, i);
+				} else if(scriptDue(game, e, 1750) && m->origin[i].x < 120) {
+					right(m, i); incScript(e, 0);
+				}
+				applyFormation(m, i);
+				break;
+
+			// SNAKE -------------------------------------------------
+			case P_SNAKE_RIGHT:
+				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->speedX[i], 1.2);
+				applyFormation(m, i);
+				break;
+			case P_SNAKE_LEFT:
+				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], -m->speedX[i], 1.2);
+				applyFormation(m, i);
+				break;
+
+			// SNAKE_WIDE -------------------------------------------------
+			case P_CROSS_RIGHT:
+				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->frequency[i], m->ampMult[i]);
+				applyFormation(m, i);
+				break;
+			case P_CROSS_LEFT:
+				m->origin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], -m->frequency[i], m->ampMult[i]);
+				applyFormation(m, i);
+				break;
+
+			// STRAFER -------------------------------------------------
+			case P_STRAFE_RIGHT:
+				if(scriptDue(game, e, 1000))
+					m->origin[i].x += m->speedX[i];
+
+				applyFormation(m, i);
+				break;
+			case P_STRAFE_LEFT:
+				if(scriptDue(game, e, 1000))
+					m->origin[i].x -= m->speedX[i];
+
+				applyFormation(m, i);
+				break;
+
+			case PATTERN_BOSS_INTRO:
+				if(e->scriptInc == 0) {
+					m->scrollDir[i] = true;
+					e->scriptInc++;
+				}
+				m->formationOrigin[i].y = m->origin[i].y;
+				break;
+
+			case PATTERN_BOSS:
+				// Scroll down to the middle of the screen.
+				if(scriptDue(game, e, 4000) && e->scriptInc == 0) {
+					m->scrollDir[i] = !m->scrollDir[i];
+					e->spawnTime = gameTime(game); //HACK!
+					e->scriptInc++;
+				// Now scroll up and down.
+				} else if(scriptDue(game, e, 2250) && e->scriptInc == 1) {
+					m->scrollDir[i] = !m->scrollDir[i];
+					e->spawnTime = gameTime(game); //HACK!
+				}
+				m->formationOrigin[i].y = m->origin[i].y;
+
+				// Blasts.
+				if(due(game, e->lastBlastTime, 1000)) {
+					e->blasting = !e->blasting;
+					if(e->blasting) e->blastCount++;
+					e->lastBlastTime = gameTime(game);
+				}
+
+				// Sway him from side to side.
+				m->formationOrigin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->frequency[i], m->ampMult[i]);
+
+				break;
+
+			case PATTERN_CIRCLE:
+				//TODO: Find out why swayIncX and swayIncY need to be swapped :p
+				m->formationOrigin[i].y = sineInc(m->origin[i].y, &m->swayIncX[i], m->frequency[i], m->ampMult[i]);
+				m->formationOrigin[i].x = cosInc(m->origin[i].x, &m->swayIncY[i], m->frequency[i], m->ampMult[i]);
+				break;
+			case PATTERN_SNAKE:
+				m->formationOrigin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->frequency[i], m->ampMult[i]);
+				m->formationOrigin[i].y = m->origin[i].y;
+				break;
+			case PATTERN_SNAKE_REV:
+				m->formationOrigin[i].x = sineInc(m->origin[i].x, &m->swayIncX[i], m->frequency[i], -m->ampMult[i]);
+				m->formationOrigin[i].y = m->origin[i].y;
+				break;
+			case PATTERN_BOB:
+				m->formationOrigin[i].x = m->origin[i].x;
+				m->formationOrigin[i].y = sineInc(m->origin[i].y, &m->swayIncY[i], 0.075, 12);;
+				break;
+			default:
+				m->formationOrigin[i] = m->origin[i];
+				break;
+		}
 	}
 }
\ No newline at end of file
@@ -3,6 +3,6 @@
 
 #include "enemy.h"
 
-extern void formationFrame(Enemy* e);
+extern void formationFrame(GameContext *game, const int *slots, int count);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "game.h"
+#include "profiler.h"
+#include "trace.h"
+#include "myc.h"
+
+//Creates a game at the start of the title sequence. Call after the shared assets, scripts and
+// level map are loaded. Games with the same seed (and input) play out the same.
+GameContext *createGame(Uint32 seed) {
+	GameContext *game = calloc(1, sizeof(GameContext));
+	if(game == NULL) {
+		fatalError("Fatal error", "Couldn't allocate a game.");
+		exit(1);
+	}
+
+	initGameClock(&game->clock);
+	seedRandomStreams(game->random, seed);
+	playerInit(game);
+	initBackground(game);
+	enemyInit(game);
+	pewInit(game);
+	itemInit(game);
+	resetLevel(game);
+	resetHud(game);
+
+	return game;
+}
+
+//Logs any pool that ran out of slots over the game's life, so caps can be tuned from a run.
+void reportPools(const GameContext *game) {
+	reportPool(&game->enemy.enemyPool);
+	reportBullets(&game->enemy.bullets);
+	reportPool(&game->enemy.boomPool);
+	reportPool(&game->weapon.shotPool);
+	reportPool(&game->item.itemPool);
+	reportPool(&game->hud.plumePool);
+	reportPool(&game->background.planetPool);
+	reportPool(&game->background.platformPool);
+}
+
+void destroyGame(GameContext *game) {
+	reportPools(game);
+	free(game);
+}
+
+//Remember where everything was before a game step, so render frames can draw in between. Each
+// *SavePositions copies current positions into the matching last ones, and render frames draw
+// interpolate(last, current) until the next step moves things on.
+static void savePositions(GameContext *game) {
+	playerSavePosition(game);
+	enemySavePositions(game);
+	itemSavePositions(game);
+	pewSavePositions(game);
+}
+
+//One fixed game step. Everything that changes the game happens in here, so given the same seed and
+// input it plays out the same however the steps are paced (or whether anything is drawn at all).
+void stepGame(GameContext *game, Uint32 input) {
+	traceBegin("game step");
+	stepGameClock(&game->clock, GAME_HZ);
+	savePositions(game);
+
+	PROFILE(PROFILE_INPUT, applyInput(game, input));
+	PROFILE(PROFILE_LEVEL, levelGameFrame(game));
+	PROFILE(PROFILE_BACKGROUND, backgroundGameFrame(game));
+	PROFILE(PROFILE_SCRIPTS, scriptGameFrame(game));
+	PROFILE(PROFILE_PLAYER, playerGameFrame(game));
+	PROFILE(PROFILE_ENEMIES, enemyGameFrame(game));
+	PROFILE(PROFILE_ITEMS, itemGameFrame(game));
+	PROFILE(PROFILE_SHOTS, pewGameFrame(game));
+	PROFILE(PROFILE_HUD, hudGameFrame(game));
+	PROFILE(PROFILE_HUD, faderGameFrame(game));
+
+	//Animation frame, every ANIMATION_HZ of game time.
+	if(gameTime(game) >= game->nextAnimationTime) {
+		game->nextAnimationTime += ANIMATION_HZ;
+
+		profileBegin(PROFILE_ANIMATION);
+		playerAnimate(game);
+		animateEnemy(game);
+		pewAnimateFrame(game);
+		hudAnimateFrame(game);
+		itemAnimateFrame(game);
+		profileEnd(PROFILE_ANIMATION);
+	}
+	traceEnd("game step");
+}
@@ -0,0 +1,43 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "common.h"
+#include "gameclock.h"
+#include "input.h"
+#include "renderer.h"
+#include "scripts.h"
+#include "player.h"
+#include "weapon.h"
+#include "enemy.h"
+#include "item.h"
+#include "level.h"
+#include "background.h"
+#include "hud.h"
+#include "random.h"
+
+//Everything a running game changes. Frame functions only touch the game they're handed, so several
+// games can step side by side (see --threads); assets, scripts and the level map are shared, read-only.
+struct GameContext {
+	GameState state;
+	bool stateInitialised;
+	GameClock clock;
+	Random random[RANDOM_STREAM_COUNT];
+	long nextAnimationTime;
+	InputState input;
+	FadeState fade;
+	ScriptContext script;
+	PlayerContext player;
+	WeaponContext weapon;
+	EnemyContext enemy;
+	ItemContext item;
+	LevelContext level;
+	BackgroundContext background;
+	HudContext hud;
+};
+
+extern GameContext *createGame(Uint32 seed);
+extern void destroyGame(GameContext *game);
+extern void reportPools(const GameContext *game);
+extern void stepGame(GameContext *game, Uint32 input);
+
+#endif
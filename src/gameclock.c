@@ -0,0 +1,36 @@
+#include "gameclock.h"
+#include "game.h"
+#include "myc.h"
+
+static const double MAX_TIME_SCALE = 16;
+
+static double timeScale = 1;
+
+void initGameClock(GameClock *clock) {
+	clock->elapsed = 0;
+	clock->snapshot = 0;
+}
+
+void stepGameClock(GameClock *clock, double milliseconds) {
+	clock->elapsed += milliseconds;
+	clock->snapshot = (long)clock->elapsed;
+}
+
+long gameTime(const GameContext *game) {
+	return game->clock.snapshot;
+}
+
+//For debugging and benchmarks: 0 pauses, below 1 is slow-motion, above 1 fast-forwards.
+void setTimeScale(double scale) {
+	if(scale < 0) scale = 0;
+	if(scale > MAX_TIME_SCALE) scale = MAX_TIME_SCALE;
+	timeScale = scale;
+}
+
+double getTimeScale() {
+	return timeScale;
+}
+
+bool isGameClockPaused() {
+	return timeScale == 0;
+}
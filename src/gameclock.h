@@ -0,0 +1,23 @@
+#ifndef GAMECLOCK_H
+#define GAMECLOCK_H
+
+#include <stdbool.h>
+#include "common.h"
+
+//Game time, in milliseconds. It only moves when the game steps (by exactly the step length), so
+// every timer read during a step agrees, and a run plays out the same however fast it's driven.
+// Each game has its own clock; the time scale is shared, and sets how quickly the scheduler hands
+// out steps (0 pauses it).
+typedef struct {
+	double elapsed;			//game milliseconds so far.
+	long snapshot;
+} GameClock;
+
+extern void initGameClock(GameClock *clock);
+extern void stepGameClock(GameClock *clock, double milliseconds);
+extern long gameTime(const GameContext *game);
+extern void setTimeScale(double scale);
+extern double getTimeScale();
+extern bool isGameClockPaused();
+
+#endif
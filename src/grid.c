@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <math.h>
+#include "grid.h"
+#include "myc.h"
+
+void initGrid(Grid *grid, int *storage, int capacity) {
+	grid->capacity = capacity;
+	grid->next = storage;
+	grid->entrySlot = storage + capacity * GRID_SPAN;
+	grid->listedOn = storage + capacity * GRID_SPAN * 2;
+	for(int i=0; i < capacity; i++) grid->listedOn[i] = 0;
+	grid->rayWalks = 0;
+	clearGrid(grid);
+}
+
+void clearGrid(Grid *grid) {
+	for(int c=0; c < GRID_COLUMNS * GRID_ROWS; c++) grid->head[c] = -1;
+	grid->entryCount = 0;
+}
+
+static int clampCell(double at, int cells) {
+	int cell = (int)floor(at / GRID_CELL_SIZE);
+	return cell < 0 ? 0 : cell >= cells ? cells - 1 : cell;
+}
+
+int gridCell(Coord point) {
+	return clampCell(point.y, GRID_ROWS) * GRID_COLUMNS + clampCell(point.x, GRID_COLUMNS);
+}
+
+static void cellSpan(Rect bounds, int *left, int *right, int *top, int *bottom) {
+	*left = clampCell(bounds.x, GRID_COLUMNS);
+	*right = clampCell(bounds.width, GRID_COLUMNS);
+	*top = clampCell(bounds.y, GRID_ROWS);
+	*bottom = clampCell(bounds.height, GRID_ROWS);
+}
+
+//Files the slot under every cell its bounds (as made by makeBounds) overlap.
+void addToGrid(Grid *grid, int slot, Rect bounds) {
+	int left, right, top, bottom;
+	cellSpan(bounds, &left, &right, &top, &bottom);
+
+	for(int row = top; row <= bottom; row++) {
+		for(int column = left; column <= right; column++) {
+			assert(grid->entryCount < grid->capacity * GRID_SPAN);
+
+			int cell = row * GRID_COLUMNS + column;
+			int entry = grid->entryCount++;
+			grid->entrySlot[entry] = slot;
+			grid->next[entry] = grid->head[cell];
+			grid->head[cell] = entry;
+		}
+	}
+}
+
+//Writes out every slot filed under any cell the bounds overlap, once each (newest added first within
+// a cell), returning how many. Like FOR_EACH_NEAR, but for things too big to treat as a point.
+int slotsNear(const Grid *grid, Rect bounds, int *slots) {
+	int left, right, top, bottom;
+	cellSpan(bounds, &left, &right, &top, &bottom);
+
+	int found = 0;
+	for(int row = top; row <= bottom; row++) {
+		for(int column = left; column <= right; column++) {
+			for(int entry = grid->head[row * GRID_COLUMNS + column]; entry >= 0; entry = grid->next[entry]) {
+				int slot = grid->entrySlot[entry];
+
+				//Big slots are filed under several cells, but only want visiting once.
+				bool seen = false;
+				for(int f=0; f < found && !seen; f++) seen = slots[f] == slot;
+				if(!seen) slots[found++] = slot;
+			}
+		}
+	}
+
+	return found;
+}
+
+//Starts a walk over the cells a ray crosses, from the origin's out to length (in multiples of the
+// direction, so pixels for a unit direction). The origin's expected on the grid (e.g. the player):
+// one off it starts from the nearest edge cell.
+GridRay startGridRay(Coord origin, Coord direction, double length) {
+	GridRay ray = { length };
+	ray.column = clampCell(origin.x, GRID_COLUMNS);
+	ray.row = clampCell(origin.y, GRID_ROWS);
+	ray.stepColumn = direction.x < 0 ? -1 : 1;
+	ray.stepRow = direction.y < 0 ? -1 : 1;
+
+	ray.nextColumn = direction.x == 0 ? INFINITY : ((ray.column + (ray.stepColumn > 0)) * GRID_CELL_SIZE - origin.x) / direction.x;
+	ray.nextRow = direction.y == 0 ? INFINITY : ((ray.row + (ray.stepRow > 0)) * GRID_CELL_SIZE - origin.y) / direction.y;
+	ray.columnGap = direction.x == 0 ? INFINITY : GRID_CELL_SIZE / fabs(direction.x);
+	ray.rowGap = direction.y == 0 ? INFINITY : GRID_CELL_SIZE / fabs(direction.y);
+
+	return ray;
+}
+
+//Step into whichever neighbour cell the ray reaches first, noting how far along it the cell it's
+// leaving goes. Past a side of the grid it carries on along that side's edge cells instead, since
+// anything off that side is filed under them.
+static void stepRay(GridRay *ray) {
+	while(true) {
+		if(ray->nextColumn == INFINITY && ray->nextRow == INFINITY) {
+			ray->reached = ray->length;
+			break;
+		}
+
+		if(ray->nextColumn < ray->nextRow) {
+			ray->reached = ray->nextColumn;
+			ray->nextColumn += ray->columnGap;
+			int column = ray->column + ray->stepColumn;
+			if(column >= 0 && column < GRID_COLUMNS) {
+				ray->column = column;
+				break;
+			}
+			ray->nextColumn = INFINITY;
+		}else{
+			ray->reached = ray->nextRow;
+			ray->nextRow += ray->rowGap;
+			int row = ray->row + ray->stepRow;
+			if(row >= 0 && row < GRID_ROWS) {
+				ray->row = row;
+				break;
+			}
+			ray->nextRow = INFINITY;
+		}
+	}
+
+	if(ray->reached >= ray->length) {
+		ray->reached = ray->length;
+		ray->done = true;
+	}
+}
+
+//Writes out the slots filed under the ray's next cell, returning how many, or -1 once it's run out
+// or left the grid. Afterwards, reached is how far along the ray that cell goes: anything met
+// closer than that can't be beaten by what's filed further on.
+int nextRayCell(const Grid *grid, GridRay *ray, int *slots) {
+	if(ray->done) return -1;
+
+	int found = 0;
+	for(int entry = grid->head[ray->row * GRID_COLUMNS + ray->column]; entry >= 0; entry = grid->next[entry]) {
+		slots[found++] = grid->entrySlot[entry];
+	}
+
+	stepRay(ray);
+	return found;
+}
+
+//Writes out every slot filed under the cells a ray crosses (see startGridRay), nearer cells' first,
+// returning how many. Each slot is listed once, at the first of its cells the ray reaches, so slots
+// only needs room for the grid's capacity.
+int slotsAlongRay(Grid *grid, Coord origin, Coord direction, double length, int *slots) {
+	GridRay ray = startGridRay(origin, direction, length);
+	int walk = ++grid->rayWalks;
+
+	int found = 0;
+	while(!ray.done) {
+		for(int entry = grid->head[ray.row * GRID_COLUMNS + ray.column]; entry >= 0; entry = grid->next[entry]) {
+			int slot = grid->entrySlot[entry];
+			if(grid->listedOn[slot] == walk) continue;
+
+			grid->listedOn[slot] = walk;
+			slots[found++] = slot;
+		}
+
+		stepRay(&ray);
+	}
+
+	return found;
+}
@@ -0,0 +1,53 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdbool.h>
+#include "common.h"
+
+//A uniform grid over the screen for broad-phase collision: each slot is filed under every cell its
+// bounds overlap, so a point only needs testing against the slots in its own cell. Anything past
+// the screen edge is filed under the nearest edge cell.
+#define GRID_CELL_SIZE 32		//about ENEMY_BOUND.
+#define GRID_COLUMNS 7			//covers the 224x256 screen.
+#define GRID_ROWS 8
+#define GRID_SPAN 12			//most cells one slot can cover (e.g. the boss, 4x3).
+
+typedef struct {
+	int capacity;
+	int head[GRID_COLUMNS * GRID_ROWS];	//first entry in each cell, or -1.
+	int *next;							//entry after each entry in its cell, or -1.
+	int *entrySlot;						//slot each entry is for.
+	int entryCount;
+	int *listedOn;						//ray walk each slot was last listed on, so walks list it once.
+	int rayWalks;
+} Grid;
+
+//Ints of storage a grid needs for its entries, e.g. int gridSlots[GRID_STORAGE(MAX_ENEMIES)];
+#define GRID_STORAGE(capacity) ((capacity) * (GRID_SPAN * 2 + 1))
+
+//A walk over the cells a ray crosses, in the order it meets them (see startGridRay).
+typedef struct {
+	double length;
+	double reached;					//how far along the ray the last cell given out goes.
+	int column, row;
+	int stepColumn, stepRow;
+	double nextColumn, nextRow;		//how far along the ray the next column and row edges are.
+	double columnGap, rowGap;		//and how far apart they are after that.
+	bool done;
+} GridRay;
+
+//Visits the slots filed under the point's cell (newest added first). They're only candidates: the
+// caller still does the exact test.
+#define FOR_EACH_NEAR(grid, point, slot) \
+	for(int entry_ = (grid)->head[gridCell(point)], slot = 0; entry_ >= 0 && ((slot = (grid)->entrySlot[entry_]), true); entry_ = (grid)->next[entry_])
+
+extern void initGrid(Grid *grid, int *storage, int capacity);
+extern void clearGrid(Grid *grid);
+extern void addToGrid(Grid *grid, int slot, Rect bounds);
+extern int gridCell(Coord point);
+extern int slotsNear(const Grid *grid, Rect bounds, int *slots);
+extern GridRay startGridRay(Coord origin, Coord direction, double length);
+extern int nextRayCell(const Grid *grid, GridRay *ray, int *slots);
+extern int slotsAlongRay(Grid *grid, Coord origin, Coord direction, double length, int *slots);
+
+#endif
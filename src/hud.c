@@ -1,173 +1,150 @@
-#include <time.h>
+#include "gameclock.h"
 #include "common.h"
 #include "renderer.h"
 #include "assets.h"
+#include "animation.h"
 #include "player.h"
 #include "hud.h"
 #include "enemy.h"
 #include "sound.h"
+#include "item.h"
+#include "weapon.h"
+#include "profiler.h"
+#include "game.h"
 #include "myc.h"
 
 #define NUM_HEARTS 3
-#define MAX_PLUMES 10
-
-typedef struct {
-	PlumeType type;
-	int score;
-	Coord origin;
-	Coord parallax;
-	long spawnTime;
-} ScorePlume;
-
-int score;
-int topScore;
-int coins = 0;
-int fruit = 0;
-static ScorePlume plumes[MAX_PLUMES];
-static int plumeInc = 0;
+
 static Sprite life, lifeHalf/*, lifeNone*/;
 static Coord lifePositions[NUM_HEARTS];
-static int noneAnimInc = 1;
 static int noneMaxAnims = 2;
 static const int BATTERY_BLINK_RATE = 500;
-static long lastBlinkTime;
 static Sprite letters[10];
+static const AssetId FONT_ASSETS[] = {
+	ASSET_FONT_00, ASSET_FONT_01, ASSET_FONT_02, ASSET_FONT_03, ASSET_FONT_04,
+	ASSET_FONT_05, ASSET_FONT_06, ASSET_FONT_07, ASSET_FONT_08, ASSET_FONT_09
+};
+static const AssetId BATTERY_LOW_ASSETS[] = { ASSET_BATTERY_LOW_01, ASSET_BATTERY_LOW_02 };		//by noneAnimInc, from 1
 static const int LETTER_WIDTH = 4;
 
-static bool warningOn;
-static bool warningShowing;
-static long warningStartTime;
-static long lastWarningFlash;
+static const int DEBUG_ROW_HEIGHT = 8;
+static const SDL_Color DEBUG_PANEL_COLOUR = { 0, 0, 0, 176 };
+static const SDL_Color DEBUG_BUDGET_COLOUR = { 255, 255, 255, 160 };
+
 static const int WARNING_TIME = 3000;
 static const int WARNING_FLASH_TIME = 500;
 
-static bool coinBoxFlash;
-static long lastInsertCoinFlash;
 static const int INSERT_COIN_FLASH_TIME = 250;
 static const int INSERT_COIN_FLASH_TIME_FAST = 50;
-bool coinInserting = false;
-static float coinX = 0;
-static int coinFrame = 1;
 static const int COIN_FRAMES = 12;
-static float coinY = 0;
-static float coinThrowPower;
-static bool coinIn = false;
 
-void spawnScorePlume(PlumeType type, int score) {
-	if(plumeInc+1 == MAX_PLUMES) plumeInc = 0;
+static void spawnScorePlume(GameContext *game, PlumeType type, int score) {
+	HudContext *hud = &game->hud;
+	int slot = acquireSlot(&hud->plumePool);
+	if(slot < 0) return;
 
 	ScorePlume plume = {
 		type,
 		score,
-		deriveCoord(playerOrigin, 0, -10),
-		deriveCoord(playerOrigin, 0, -10),
-		clock()
+		deriveCoord(game->player.origin, 0, -10),
+		deriveCoord(game->player.origin, 0, -10),
+		gameTime(game)
 	};
 
-	plumes[plumeInc++] = plume;
+	hud->plumes[slot] = plume;
 }
 
-void spawnPlume(PlumeType type) {
-	spawnScorePlume(type, 0);
+void spawnPlume(GameContext *game, PlumeType type) {
+	spawnScorePlume(game, type, 0);
 }
 
-void raiseScore(unsigned amount, bool plume) {
-	score += amount;
+void raiseScore(GameContext *game, unsigned amount, bool plume) {
+	game->hud.score += amount;
 	if(plume) {
-		spawnScorePlume(PLUME_SCORE, amount);
+		spawnScorePlume(game, PLUME_SCORE, amount);
 	}
 }
 
-ScorePlume nullPlume() {
-	ScorePlume p = { };
-	return p;
-}
-
-bool isNullPlume(ScorePlume *plume) {
-	return plume->spawnTime == 0;
-}
-
-void hudGameFrame() {
-	for(int i=0; i < MAX_PLUMES; i++) {
-		if(isNullPlume(&plumes[i])) continue;
+void hudGameFrame(GameContext *game) {
+	HudContext *hud = &game->hud;
 
+	FOR_EACH_SLOT(&hud->plumePool, i) {
 		//Hide once their display time has expired.
-		if(due(plumes[i].spawnTime, 750)) {
-			plumes[i] = nullPlume();
+		if(due(game, hud->plumes[i].spawnTime, 750)) {
+			releaseSlot(&hud->plumePool, i);
+			continue;
 		}
 
-		plumes[i].parallax.y -= 0.75;
+		hud->plumes[i].parallax.y -= 0.75;
 	}
 }
 
-void hudAnimateFrame() {
+void hudAnimateFrame(GameContext *game) {
+	HudContext *hud = &game->hud;
+
 	// Insert coin flash
-	if (gameState == STATE_COIN || gameState == STATE_TITLE || gameState == STATE_INTRO) {
+	if (game->state == STATE_COIN || game->state == STATE_TITLE || game->state == STATE_INTRO) {
 		// Two flashing speeds depending on what mode we're in.
-		if(timer(&lastInsertCoinFlash, INSERT_COIN_FLASH_TIME)) {
-			coinBoxFlash = !coinBoxFlash;
-		} else if(coinIn && timer(&lastInsertCoinFlash, INSERT_COIN_FLASH_TIME_FAST)) {
-			coinBoxFlash = !coinBoxFlash;
+		if(timer(game, &hud->lastInsertCoinFlash, INSERT_COIN_FLASH_TIME)) {
+			hud->coinBoxFlash = !hud->coinBoxFlash;
+		} else if(hud->coinIn && timer(game, &hud->lastInsertCoinFlash, INSERT_COIN_FLASH_TIME_FAST)) {
+			hud->coinBoxFlash = !hud->coinBoxFlash;
 		}
 	}
 
 	// coin rotation animation.
-	if(coinInserting) {
-		coinFrame = coinFrame < COIN_FRAMES-1 ? coinFrame + 1 : 1;
+	if(hud->coinInserting) {
+		hud->coinFrame = hud->coinFrame < COIN_FRAMES-1 ? hud->coinFrame + 1 : 1;
 	}
 
-	if(!timer(&lastBlinkTime, BATTERY_BLINK_RATE)) {
+	if(!timer(game, &hud->lastBlinkTime, BATTERY_BLINK_RATE)) {
 		return;
 	}
 
-	if(noneAnimInc == noneMaxAnims) noneAnimInc = 0;
-	noneAnimInc++;
+	if(hud->noneAnimInc == noneMaxAnims) hud->noneAnimInc = 0;
+	hud->noneAnimInc++;
 }
 
-void persistentHudRenderFrame() {
-	if(!(gameState == STATE_COIN || gameState == STATE_TITLE || gameState == STATE_INTRO)) return;
+void persistentHudRenderFrame(GameContext *game) {
+	HudContext *hud = &game->hud;
+
+	if(!(game->state == STATE_COIN || game->state == STATE_TITLE || game->state == STATE_INTRO)) return;
 
 	// Animate the coin box.
-	char coinBoxFile[50];
-	sprintf(coinBoxFile,
-		"insert-coin-%s%d.png",
-		!coinIn ? "dim-" : "",
-		coinBoxFlash ? 0 : 1
-	);
+	AssetId coinBox = !hud->coinIn ?
+		(hud->coinBoxFlash ? ASSET_INSERT_COIN_DIM_0 : ASSET_INSERT_COIN_DIM_1) :
+		(hud->coinBoxFlash ? ASSET_INSERT_COIN_0 : ASSET_INSERT_COIN_1);
 
 	// Draw coin box.
-	Sprite warning = makeSprite(getTexture(coinBoxFile), zeroCoord(), SDL_FLIP_NONE);
+	Sprite warning = makeHandleSprite(coinBox, ASSET_DEFAULT);
 	drawSpriteAbs(warning, makeCoord(screenBounds.x - 20, screenBounds.y - 20));
 
 	// Draw coin insertion animation.
-	if(coinInserting) {
-		if(coinX < 77) {
+	if(hud->coinInserting) {
+		if(hud->coinX < 77) {
 			// Throw the coin
-			coinThrowPower -= 0.16;
-			coinY -= coinThrowPower;
+			hud->coinThrowPower -= 0.16;
+			hud->coinY -= hud->coinThrowPower;
 
-			char coinFile[50];
-			sprintf(coinFile, "coin-%02d.png", coinFrame);
-			Sprite coin = makeSprite(getTexture(coinFile), zeroCoord(), SDL_FLIP_NONE);
+			Sprite coin = *clipFrame(getClip(CLIP_COIN), hud->coinFrame, ASSET_DEFAULT);
 
 			drawSpriteAbsRotated(coin, makeCoord(
-				screenBounds.x /2  + (coinX += 1.325),
-				(screenBounds.y + 8) + coinY),
+				screenBounds.x /2  + (hud->coinX += 1.325),
+				(screenBounds.y + 8) + hud->coinY),
 				90
 			);
 		}else {
-			coinX = 0;
-			coinInserting = false;
-			coinIn = true;
+			hud->coinX = 0;
+			hud->coinInserting = false;
+			hud->coinIn = true;
 			play("Powerup8.wav");
 		}
 	}
 }
 
 void hudInit() {
-	lastInsertCoinFlash = clock();
-	life = makeSprite(getTexture("battery.png"), zeroCoord(), SDL_FLIP_NONE);
-	lifeHalf = makeSprite(getTexture("battery-half.png"), zeroCoord(), SDL_FLIP_NONE);
+	life = makeHandleSprite(ASSET_BATTERY, ASSET_DEFAULT);
+	lifeHalf = makeHandleSprite(ASSET_BATTERY_HALF, ASSET_DEFAULT);
 //	lifeNone = makeSprite(getTexture("battery-none.png"), zeroCoord(), SDL_FLIP_NONE);
 
 	//Set drawing coordinates for heart icons - each is spaced out in the upper-left.
@@ -177,9 +154,7 @@ void hudInit() {
 
 	//Pre-load font sprites.
 	for(int i=0; i < 10; i++) {
-		char textureName[50];
-		sprintf(textureName, "font-%02d.png", i);
-		letters[i] = makeSimpleSprite(textureName);
+		letters[i] = makeHandleSprite(FONT_ASSETS[i], ASSET_DEFAULT);
 	}
 
 	hudReset();
@@ -205,101 +180,142 @@ void writeText(int amount, Coord pos, bool doubleSize) {
 	}
 }
 
-void showDebugStats() {
-	Coord underLife = makeCoord(10, 27);
+//Stacked bar per frame, newest on the right, with a line at the 60fps budget.
+static void drawProfileGraph(Coord bottomLeft, double height, double budgetMs) {
+	double pixelsPerMs = height / (budgetMs * 2);
+
+	for(int frame=0; frame < PROFILE_HISTORY; frame++) {
+		double x = bottomLeft.x + PROFILE_HISTORY - 1 - frame;
+		double stacked = 0;
+
+		for(int s=0; s < PROFILE_SECTION_COUNT; s++) {
+			//Round the running total rather than each segment, so slivers add up instead of vanishing.
+			int from = (int)(stacked * pixelsPerMs);
+			stacked += getProfileFrame(s, frame);
+			int to = (int)(stacked * pixelsPerMs);
+			if(to > height) to = (int)height;
+			if(to <= from) continue;
+
+			drawRectAbs(makeCoord(x, bottomLeft.y - to), makeCoord(1, to - from), getProfileSection(s)->colour);
+		}
+	}
+
+	drawRectAbs(makeCoord(bottomLeft.x, bottomLeft.y - (int)(budgetMs * pixelsPerMs)), makeCoord(PROFILE_HISTORY, 1), DEBUG_BUDGET_COLOUR);
+}
+
+static void drawDebugCount(AssetHandle icon, int count, Coord position) {
+	drawSpriteAbsRotated2(makeHandleSprite(icon, ASSET_DEFAULT), position, 0, 0.5, 0.5);
+	writeText(count, deriveCoord(position, 24, 0), false);
+}
 
-	//Show player X coordinate:
-	writeText(playerOrigin.x, deriveCoord(underLife, 10, 20), false);
+//Profiler overlay (toggled with F3): per-section min, average and 99th percentile in microseconds
+// over the last PROFILE_HISTORY frames, live entity counts, and a frame time graph.
+void showDebugStats(const GameContext *game) {
+	Coord top = makeCoord(4, 38);
 
-	if(enemies[0].health > 0) {
-		writeText(enemies[0].origin.x, deriveCoord(underLife, 10, 30), false);
-		writeText(enemies[0].parallax.x, deriveCoord(underLife, 10, 40), false);
+	drawRectAbs(top, makeCoord(pixelGrid.x - 8, pixelGrid.y - top.y - 4), DEBUG_PANEL_COLOUR);
+
+	for(int s=0; s < PROFILE_SECTION_COUNT; s++) {
+		Coord row = deriveCoord(top, 0, 6 + s * DEBUG_ROW_HEIGHT);
+		ProfileStats stats = getProfileStats(s);
+
+		drawRectAbs(deriveCoord(row, 4, -2), makeCoord(5, 5), getProfileSection(s)->colour);
+		writeText((int)(stats.minMs * 1000), deriveCoord(row, 36, 0), false);
+		writeText((int)(stats.avgMs * 1000), deriveCoord(row, 62, 0), false);
+		writeText((int)(stats.p99Ms * 1000), deriveCoord(row, 88, 0), false);
 	}
+
+	Coord counts = makeCoord(pixelGrid.x - 48, top.y + 10);
+	drawDebugCount(ASSET_DISK_01, countEnemies(game), counts);
+	drawDebugCount(ASSET_VIRUS_SHOT, countEnemyShots(game), deriveCoord(counts, 0, 14));
+	drawDebugCount(ASSET_SHOT_NEON_01, countShots(game), deriveCoord(counts, 0, 28));
+	drawDebugCount(ASSET_COIN_05, countItems(game), deriveCoord(counts, 0, 42));
+
+	drawProfileGraph(makeCoord(top.x + 4, pixelGrid.y - 10), 48, 1000.0 / 60);
 }
 
-void toggleWarning() {
-	warningOn = true;
-	warningStartTime = clock();
-	lastWarningFlash = clock();
+void toggleWarning(GameContext *game) {
+	HudContext *hud = &game->hud;
+
+	hud->warningOn = true;
+	hud->warningStartTime = gameTime(game);
+	hud->lastWarningFlash = gameTime(game);
 
 	// Stop the music (drama!)
 	Mix_FadeOutMusic(250);
 
 	// Force initial display
 	play("warning.wav");
-	warningShowing = true;
+	hud->warningShowing = true;
 }
 
-void renderWarning() {
-	if(!warningOn) return;
+static void renderWarning(GameContext *game) {
+	HudContext *hud = &game->hud;
+
+	if(!hud->warningOn) return;
 
 	// Halt the warning, and start special boss music.
-	if(warningOn && due(warningStartTime, WARNING_TIME)) {
+	if(hud->warningOn && due(game, hud->warningStartTime, WARNING_TIME)) {
 		playMusic("tension.ogg", -1);
-		warningOn = false;
+		hud->warningOn = false;
 		return;
 	}
 
 	// Toggle message on/off, and play sound.
-	if(timer(&lastWarningFlash, WARNING_FLASH_TIME)) {
-		warningShowing = !warningShowing;
-		if(warningShowing) play("warning.wav");
+	if(timer(game, &hud->lastWarningFlash, WARNING_FLASH_TIME)) {
+		hud->warningShowing = !hud->warningShowing;
+		if(hud->warningShowing) play("warning.wav");
 	}
 
 	// Render the message
-	if(warningShowing) {
-		Sprite warning = makeSprite(getTexture("warning.png"), zeroCoord(), SDL_FLIP_NONE);
+	if(hud->warningShowing) {
+		Sprite warning = makeHandleSprite(ASSET_WARNING, ASSET_DEFAULT);
 		drawSpriteAbs(warning, makeCoord(pixelGrid.x/2, pixelGrid.y/3));
 	}
 }
 
-void insertCoin() {
-	coinInserting = true;
+void insertCoin(GameContext *game) {
+	game->hud.coinInserting = true;
 	Mix_PauseMusic();
 	play("Powerup9.wav");
 //	play("Pickup_Coin34b.wav");
 }
 
-int coinInc = 0;
-int fruitInc = 0;
-int scoreInc = 0;
-int statsInc = 0;
-
-void hudRenderFrame() {
+void hudRenderFrame(GameContext *game) {
+	HudContext *hud = &game->hud;
+	const PlayerContext *player = &game->player;
 	Coord underScore = makeCoord(pixelGrid.x - 7, 26);
 
-//	showDebugStats();
-
-	if(gameState == STATE_STATS) {
-		drawSpriteAbsRotated2(makeSimpleSprite("text-coins.png"), makeCoord(120, 50), 0, 1, 1);
-		drawSpriteAbsRotated2(makeSimpleSprite("font-x.png"), makeCoord(100, 50), 0, 1, 1);
-		writeText(coinInc, makeCoord(93, 50), false);
+	if(game->state == STATE_STATS) {
+		drawSpriteAbsRotated2(makeHandleSprite(ASSET_TEXT_COINS, ASSET_DEFAULT), makeCoord(120, 50), 0, 1, 1);
+		drawSpriteAbsRotated2(makeHandleSprite(ASSET_FONT_X, ASSET_DEFAULT), makeCoord(100, 50), 0, 1, 1);
+		writeText(hud->coinInc, makeCoord(93, 50), false);
 
-		if(coinInc == coins) {
-			statsInc++;
+		if(hud->coinInc == hud->coins) {
+			hud->statsInc++;
 		}else{
-			coinInc++;
+			hud->coinInc++;
 		}
 
-		if(statsInc >= 1) {
-			drawSpriteAbsRotated2(makeSimpleSprite("text-treats.png"), makeCoord(123, 60), 0, 1, 1);
-			drawSpriteAbsRotated2(makeSimpleSprite("font-x.png"), makeCoord(100, 60), 0, 1, 1);
-			writeText(fruitInc, makeCoord(93, 60), false);
+		if(hud->statsInc >= 1) {
+			drawSpriteAbsRotated2(makeHandleSprite(ASSET_TEXT_TREATS, ASSET_DEFAULT), makeCoord(123, 60), 0, 1, 1);
+			drawSpriteAbsRotated2(makeHandleSprite(ASSET_FONT_X, ASSET_DEFAULT), makeCoord(100, 60), 0, 1, 1);
+			writeText(hud->fruitInc, makeCoord(93, 60), false);
 
-			if(fruitInc == fruit) {
-				statsInc++;
+			if(hud->fruitInc == hud->fruit) {
+				hud->statsInc++;
 			}else{
-				fruitInc++;
+				hud->fruitInc++;
 			}
 		}
-		if(statsInc >= 1) {
-			drawSpriteAbsRotated2(makeSimpleSprite("text-score.png"), makeCoord(121, 75), 0, 1, 1);
-			writeText(scoreInc, makeCoord(93, 75), false);
+		if(hud->statsInc >= 1) {
+			drawSpriteAbsRotated2(makeHandleSprite(ASSET_TEXT_SCORE, ASSET_DEFAULT), makeCoord(121, 75), 0, 1, 1);
+			writeText(hud->scoreInc, makeCoord(93, 75), false);
 
-			if(scoreInc == score) {
-				statsInc++;
+			if(hud->scoreInc == hud->score) {
+				hud->statsInc++;
 			}else{
-				scoreInc++;
+				hud->scoreInc++;
 			}
 		}
 
@@ -307,97 +323,99 @@ void hudRenderFrame() {
 	}
 
 	//Show score and coin HUD during the game, and game over sequences.
-	if(	gameState == STATE_GAME ||
-		gameState == STATE_LEVEL_COMPLETE ||
-		gameState == STATE_GAME_OVER
+	if(	game->state == STATE_GAME ||
+		game->state == STATE_LEVEL_COMPLETE ||
+		game->state == STATE_GAME_OVER
 	) {
 		//Score HUD
-		writeText(score, makeCoord(pixelGrid.x - 5, 10), false);
+		writeText(hud->score, makeCoord(pixelGrid.x - 5, 10), false);
 
 		//Draw coin status
-		Sprite coin = makeSprite(getTexture("coin-05.png"), zeroCoord(), SDL_FLIP_NONE);
+		Sprite coin = makeHandleSprite(ASSET_COIN_05, ASSET_DEFAULT);
 		drawSpriteAbs(coin, underScore);
-		Sprite x = makeSprite(getTexture("font-x.png"), zeroCoord(), SDL_FLIP_NONE);
+		Sprite x = makeHandleSprite(ASSET_FONT_X, ASSET_DEFAULT);
 		drawSpriteAbs(x, deriveCoord(underScore, -9, -1));
-		writeText(coins, deriveCoord(underScore, -14, -1), false);
+		writeText(hud->coins, deriveCoord(underScore, -14, -1), false);
 	}
 
 	//Only show if playing, and *hide* if dying.
-	if(gameState != STATE_GAME) return;
+	if(game->state != STATE_GAME) return;
 
 	//Loop through icons and draw them at the appropriate 'fullness' levels for each health bar.
 	// This algorithm will automatically scale according to whatever we choose to set the player's total health to.
-	float healthPerHeart = playerStrength / NUM_HEARTS;		//e.g. for 4 hearts, 1 heart = 25 hitpoints.
+	float healthPerHeart = player->strength / NUM_HEARTS;		//e.g. for 4 hearts, 1 heart = 25 hitpoints.
 	for(int bar=0; bar < NUM_HEARTS; bar++) {
 		//The total health represented by this bar. We do a bit of crazy magic here to make sure we calculate this
 		// correctly for a left-to-right pass.
-		float barHealth = playerStrength - ((NUM_HEARTS - (bar+1)) * healthPerHeart);
+		float barHealth = player->strength - ((NUM_HEARTS - (bar+1)) * healthPerHeart);
 
 		//Full bar.
-		if(playerHealth >= barHealth) {
-			AssetVersion version = godMode ? ASSET_SUPER : ASSET_DEFAULT;
-			Sprite lifeGod = makeSprite(getTextureVersion("battery.png", version), zeroCoord(), SDL_FLIP_NONE);
+		if(player->health >= barHealth) {
+			AssetVersion version = player->godMode ? ASSET_SUPER : ASSET_DEFAULT;
+			Sprite lifeGod = makeHandleSprite(ASSET_BATTERY, version);
 
 			drawSpriteAbs(lifeGod, lifePositions[bar]);
 		//Between half and full.
-		}else if(playerHealth >= barHealth - (healthPerHeart/2)) {
-			char noneName[50];
-			sprintf(noneName, "battery-low-%02d.png", noneAnimInc);
-			Sprite lifeNone = makeSprite(getTexture(noneName), zeroCoord(), SDL_FLIP_NONE);
+		}else if(player->health >= barHealth - (healthPerHeart/2)) {
+			Sprite lifeNone = makeHandleSprite(BATTERY_LOW_ASSETS[hud->noneAnimInc - 1], ASSET_DEFAULT);
 
 			drawSpriteAbs(lifeNone, lifePositions[bar]);
 		}else{
-			char noneName[50];
-			sprintf(noneName, "battery-low-%02d.png", noneAnimInc);
-			Sprite lifeNone = makeSprite(getTexture(noneName), zeroCoord(), SDL_FLIP_NONE);
+			Sprite lifeNone = makeHandleSprite(BATTERY_LOW_ASSETS[hud->noneAnimInc - 1], ASSET_DEFAULT);
 
 			drawSpriteAbs(lifeNone, lifePositions[bar]);
 		}
 	}
 
 	//Plumes
-	for(int i=0; i < MAX_PLUMES; i++) {
-		if(isNullPlume(&plumes[i])) continue;
-
-		switch(plumes[i].type) {
+	FOR_EACH_SLOT_IN_ORDER(&hud->plumePool, i) {
+		switch(hud->plumes[i].type) {
 			case PLUME_SCORE: {
-				writeText(plumes[i].score, plumes[i].parallax, false);
+				writeText(hud->plumes[i].score, hud->plumes[i].parallax, false);
 				break;
 			}
 			case PLUME_LASER: {
-				Sprite plume = makeSimpleSprite("text-laser-upgraded.png");
-				drawSpriteAbs(plume, plumes[i].parallax);
+				Sprite plume = makeHandleSprite(ASSET_TEXT_LASER_UPGRADED, ASSET_DEFAULT);
+				drawSpriteAbs(plume, hud->plumes[i].parallax);
 				break;
 			}
 			case PLUME_POWER: {
-				Sprite plume = makeSimpleSprite("text-full-power.png");
-				drawSpriteAbs(plume, plumes[i].parallax);
+				Sprite plume = makeHandleSprite(ASSET_TEXT_FULL_POWER, ASSET_DEFAULT);
+				drawSpriteAbs(plume, hud->plumes[i].parallax);
 				break;
 			}
 		}
 	}
 
-	renderWarning();
+	renderWarning(game);
 
 	// Boss health bar.
-	if(bossOnscreen) {
+	if(game->enemy.bossOnscreen) {
 		const double BAR_LENGTH = 60;
-		Sprite bossBarBg = makeSprite(getTexture("health-bar-bg.png"), zeroCoord(), SDL_FLIP_NONE);
+		Sprite bossBarBg = makeHandleSprite(ASSET_HEALTH_BAR_BG, ASSET_DEFAULT);
 		drawSpriteAbsRotated2(bossBarBg, makeCoord(50, 9), 0, BAR_LENGTH*2, 1);
-		Sprite bossBar = makeSprite(getTexture("health-bar.png"), zeroCoord(), SDL_FLIP_NONE);
-		drawSpriteAbsRotated2(bossBar, makeCoord(50, 9), 0, (bossHealth / 100) * BAR_LENGTH, 1);
-		Sprite bossName = makeSprite(getTexture("text-keyface.png"), zeroCoord(), SDL_FLIP_NONE);
+		Sprite bossBar = makeHandleSprite(ASSET_HEALTH_BAR, ASSET_DEFAULT);
+		drawSpriteAbsRotated2(bossBar, makeCoord(50, 9), 0, (game->enemy.bossHealth / 100) * BAR_LENGTH, 1);
+		Sprite bossName = makeHandleSprite(ASSET_TEXT_KEYFACE, ASSET_DEFAULT);
 		drawSprite(bossName, makeCoord(112, 9));
 	}
 }
 
-void resetHud() {
-	score = 0;
-	coins = 0;
-	fruit = 0;
-	coinInserting = false;
-	coinX = 0;
-	coinY = 0;
-	coinThrowPower = 5.25;
-	coinIn = false;
+void resetHud(GameContext *game) {
+	HudContext *hud = &game->hud;
+
+	hud->score = 0;
+	hud->coins = 0;
+	hud->fruit = 0;
+	hud->coinInserting = false;
+	hud->coinX = 0;
+	hud->coinY = 0;
+	hud->coinThrowPower = 5.25;
+	hud->coinIn = false;
+	hud->coinFrame = 1;
+	hud->noneAnimInc = 1;
+
+	//The pool lives as long as the game (so its exhaustion count survives restarts).
+	if(hud->plumePool.capacity == 0) initPool(&hud->plumePool, "plume", hud->plumeSlots, MAX_PLUMES);
+	clearPool(&hud->plumePool);
 }
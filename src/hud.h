@@ -1,26 +1,65 @@
 #ifndef HUD_H
 #define HUD_H
 
+#include "common.h"
+#include "pool.h"
+
+#define MAX_PLUMES 10
+
 typedef enum {
 	PLUME_SCORE,
 	PLUME_LASER,
 	PLUME_POWER
 } PlumeType;
 
-extern void insertCoin();
-extern void persistentHudRenderFrame();
-extern void toggleWarning();
+typedef struct {
+	PlumeType type;
+	int score;
+	Coord origin;
+	Coord parallax;
+	long spawnTime;
+} ScorePlume;
+
+//Score, pickups and the HUD's own animations (warnings, coin insertion, end of level stats).
+typedef struct {
+	int score;
+	int topScore;
+	int coins;
+	int fruit;
+	ScorePlume plumes[MAX_PLUMES];
+	Pool plumePool;
+	int plumeSlots[POOL_STORAGE(MAX_PLUMES)];
+	int noneAnimInc;
+	long lastBlinkTime;
+	bool warningOn;
+	bool warningShowing;
+	long warningStartTime;
+	long lastWarningFlash;
+	bool coinBoxFlash;
+	long lastInsertCoinFlash;
+	bool coinInserting;
+	float coinX;
+	int coinFrame;
+	float coinY;
+	float coinThrowPower;
+	bool coinIn;
+	int coinInc;
+	int fruitInc;
+	int scoreInc;
+	int statsInc;
+} HudContext;
+
+extern void insertCoin(GameContext *game);
+extern void persistentHudRenderFrame(GameContext *game);
+extern void toggleWarning(GameContext *game);
 extern void hudReset();
-extern void spawnPlume(PlumeType type);
-extern int score;
-extern int topScore;
-extern int coins;
-extern int fruit;
-extern void raiseScore(unsigned amount, bool plume);
-extern void hudGameFrame();
-extern void hudRenderFrame();
+extern void spawnPlume(GameContext *game, PlumeType type);
+extern void raiseScore(GameContext *game, unsigned amount, bool plume);
+extern void hudGameFrame(GameContext *game);
+extern void hudRenderFrame(GameContext *game);
 extern void hudInit();
-extern void hudAnimateFrame();
-extern void resetHud();
+extern void hudAnimateFrame(GameContext *game);
+extern void showDebugStats(const GameContext *game);
+extern void resetHud(GameContext *game);
 
 #endif
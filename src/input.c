@@ -6,22 +6,24 @@
 #include "weapon.h"
 #include "player.h"
 #include "renderer.h"
+#include "gameclock.h"
+#include "profiler.h"
+#include "replay.h"
+#include "game.h"
 #include "myc.h"
 
 //NB: We bind our SDL key codes to game-meaningful actions, so we can bind our logic against those rather than hard-
 // coding keys throughout our code.
 
-#define MAX_COMMANDS 20
+//Closing the window (or a replay running out) quits, whatever state the game's in.
+static bool quitRequested;
 
-static bool commands[MAX_COMMANDS];
-static bool scriptCommands[MAX_COMMANDS];
-
-void scriptCommand(int commandFlag) {
-	scriptCommands[commandFlag] = true;
+void scriptCommand(GameContext *game, int commandFlag) {
+	game->input.scriptCommands[commandFlag] = true;
 }
 
-bool checkCommand(int commandFlag) {
-	return commands[commandFlag];
+bool checkCommand(const GameContext *game, int commandFlag) {
+	return game->input.commands[commandFlag];
 }
 
 void shutdownInput() {
@@ -30,22 +32,86 @@ void shutdownInput() {
 void initInput() {
 }
 
-void pollInput() {
-	//Tell SDL we want to examine events (otherwise getKeyboardState won't work).
-	SDL_PumpEvents();
+//Keys that play the game, as opposed to system keys (screenshots, fullscreen, the profiler...).
+// Which of these are held and newly pressed on each game step is all a replay needs to store.
+typedef enum {
+	KEY_LEFT,
+	KEY_RIGHT,
+	KEY_UP,
+	KEY_DOWN,
+	KEY_SPACE,
+	KEY_LCTRL,
+	KEY_ESCAPE,
+	KEY_CHEAT_GOD,
+	KEY_CHEAT_WEAPON,
+	KEY_CHEAT_HEALTH,
+	GAME_KEY_COUNT
+} GameKey;
 
-	//Respond to held keys
-	const Uint8 *keysHeld = SDL_GetKeyboardState(NULL);
+static const SDL_Scancode gameKeys[GAME_KEY_COUNT] = {
+	[KEY_LEFT] = SDL_SCANCODE_LEFT,
+	[KEY_RIGHT] = SDL_SCANCODE_RIGHT,
+	[KEY_UP] = SDL_SCANCODE_UP,
+	[KEY_DOWN] = SDL_SCANCODE_DOWN,
+	[KEY_SPACE] = SDL_SCANCODE_SPACE,
+	[KEY_LCTRL] = SDL_SCANCODE_LCTRL,
+	[KEY_ESCAPE] = SDL_SCANCODE_ESCAPE,
+	[KEY_CHEAT_GOD] = SDL_SCANCODE_G,
+	[KEY_CHEAT_WEAPON] = SDL_SCANCODE_H,
+	[KEY_CHEAT_HEALTH] = SDL_SCANCODE_J
+};
 
-	//We're on a new frame, so clear all previous checkCommand (not key) states (i.e. set to false)
-	memset(commands, 0, sizeof(commands));
+//A step's input packs held keys in the low half, and keys pressed that step in the high half.
+static const int PRESSED_SHIFT = 16;
+
+static Uint32 keyBit(GameKey key) {
+	return 1u << key;
+}
+
+static void pressSystemKey(SDL_Scancode keypress) {
+	switch(keypress) {
+		case SDL_SCANCODE_F1:
+			screenshot();
+			break;
+		case SDL_SCANCODE_F3:
+			toggleProfilerOverlay();
+			break;
+		case SDL_SCANCODE_F11:
+			toggleFullscreen();
+			break;
+#ifdef DEBUG_CHEATS
+		//Time controls: pause, slow down, speed up, and back to normal.
+		case SDL_SCANCODE_F5:
+			setTimeScale(isGameClockPaused() ? 1 : 0);
+			break;
+		case SDL_SCANCODE_F6:
+			setTimeScale(getTimeScale() / 2);
+			break;
+		case SDL_SCANCODE_F7:
+			setTimeScale(getTimeScale() * 2);
+			break;
+		case SDL_SCANCODE_F8:
+			setTimeScale(1);
+			break;
+#endif
+//		case SDL_SCANCODE_F10:
+//			toggleMusic();
+//			break;
+	}
+}
+
+//Handles the window and system keys straight away, and returns the game keys pressed (as key bits).
+static Uint32 pollEvents() {
+	//Tell SDL we want to examine events (otherwise getKeyboardState won't work).
+	SDL_PumpEvents();
 
 	//Respond to SDL events, or key presses (not holds)
+	Uint32 pressed = 0;
 	SDL_Event event;
 	while(SDL_PollEvent(&event) != 0) {
 		switch(event.type) {
 			case SDL_QUIT:
-				commands[CMD_QUIT] = true;
+				quitRequested = true;
 				break;
 
 			//Presses
@@ -53,86 +119,104 @@ void pollInput() {
 				//Ignore held keys.
 				if(event.key.repeat) break;
 
-				SDL_Keycode keypress = event.key.keysym.scancode;
-
-				switch(keypress) {
-                    case SDL_SCANCODE_F1:
-                        screenshot();
-                        break;
-					case SDL_SCANCODE_F11:
-						toggleFullscreen();
-						break;
-//					case SDL_SCANCODE_F10:
-//						toggleMusic();
-//						break;
-					// Activate fire-on-space only after we've switched modes, to prevent too-soon firing on game start.
-					case SDL_SCANCODE_SPACE:
-					case SDL_SCANCODE_LCTRL:
-						if(gameState == STATE_GAME) {
-							canFireInLevel = true;
-						}
-						break;
-				}
+				SDL_Scancode keypress = event.key.keysym.scancode;
+				pressSystemKey(keypress);
 
-				//Bind SDL keycodes to our custom actions, so we don't have to duplicate/remember keybindings everywhere in our code.
-				switch(gameState) {
-					case STATE_COIN:
-						if(keypress == SDL_SCANCODE_ESCAPE)
-							triggerState(STATE_TITLE);
-						break;
-					case STATE_TITLE:
-						if(	keypress == SDL_SCANCODE_LCTRL ||
-							keypress == SDL_SCANCODE_SPACE
-						)
-							commands[CMD_PLAYER_FIRE] = true;
-
-						if(keypress == SDL_SCANCODE_ESCAPE)
-							commands[CMD_QUIT] = true;
-						break;
-					case STATE_INTRO:
-						if(	keypress == SDL_SCANCODE_LCTRL ||
-							keypress == SDL_SCANCODE_SPACE ||
-							keypress == SDL_SCANCODE_ESCAPE)
-							commands[CMD_PLAYER_SKIP_TO_TITLE] = true;
- 						break;
-					case STATE_GAME_OVER:
-						if(	keypress == SDL_SCANCODE_ESCAPE ||
-							keypress == SDL_SCANCODE_SPACE ||
-							keypress == SDL_SCANCODE_LCTRL )
-							commands[CMD_PLAYER_SKIP_TO_TITLE] = true;
-						break;
-					case STATE_GAME:
-#ifdef DEBUG_CHEATS
-						if(	keypress == SDL_SCANCODE_G)
-							godMode = !godMode;
-
-						if(	keypress == SDL_SCANCODE_H) {
-							if(atMaxWeapon()) {
-								changeWeapon(0);
-							}else{
-								upgradeWeapon();
-							}
-						}
-
-						if(	keypress == SDL_SCANCODE_J){
-							if(playerHealth > 1) {
-								playerHealth = 1;
-							}else{
-								playerHealth = playerStrength;
-							}
-						}
-#endif
-						if(	keypress == SDL_SCANCODE_ESCAPE)
-							commands[CMD_PLAYER_SKIP_TO_TITLE] = true;
-						break;
+				for(int k=0; k < GAME_KEY_COUNT; k++) {
+					if(gameKeys[k] == keypress) pressed |= keyBit(k);
 				}
 				break;
 			}
 		}
 	}
 
+	return pressed;
+}
+
+static void pressGameKey(GameContext *game, GameKey keypress) {
+	bool *commands = game->input.commands;
+
+	switch(keypress) {
+		// Activate fire-on-space only after we've switched modes, to prevent too-soon firing on game start.
+		case KEY_SPACE:
+		case KEY_LCTRL:
+			if(game->state == STATE_GAME) {
+				game->weapon.canFireInLevel = true;
+			}
+			break;
+	}
+
+	//Bind our game keys to custom actions, so we don't have to duplicate/remember keybindings everywhere in our code.
+	switch(game->state) {
+		case STATE_COIN:
+			if(keypress == KEY_ESCAPE)
+				triggerState(game, STATE_TITLE);
+			break;
+		case STATE_TITLE:
+			if(	keypress == KEY_LCTRL ||
+				keypress == KEY_SPACE
+			)
+				commands[CMD_PLAYER_FIRE] = true;
+
+			if(keypress == KEY_ESCAPE)
+				commands[CMD_QUIT] = true;
+			break;
+		case STATE_INTRO:
+			if(	keypress == KEY_LCTRL ||
+				keypress == KEY_SPACE ||
+				keypress == KEY_ESCAPE)
+				commands[CMD_PLAYER_SKIP_TO_TITLE] = true;
+			break;
+		case STATE_GAME_OVER:
+			if(	keypress == KEY_ESCAPE ||
+				keypress == KEY_SPACE ||
+				keypress == KEY_LCTRL )
+				commands[CMD_PLAYER_SKIP_TO_TITLE] = true;
+			break;
+		case STATE_GAME:
+#ifdef DEBUG_CHEATS
+			if(	keypress == KEY_CHEAT_GOD)
+				game->player.godMode = !game->player.godMode;
+
+			if(	keypress == KEY_CHEAT_WEAPON) {
+				if(atMaxWeapon(game)) {
+					changeWeapon(game, 0);
+				}else{
+					upgradeWeapon(game);
+				}
+			}
+
+			if(	keypress == KEY_CHEAT_HEALTH){
+				if(game->player.health > 1) {
+					game->player.health = 1;
+				}else{
+					game->player.health = game->player.strength;
+				}
+			}
+#endif
+			if(	keypress == KEY_ESCAPE)
+				commands[CMD_PLAYER_SKIP_TO_TITLE] = true;
+			break;
+	}
+}
+
+//Turns a step's input into commands. Everything the game does with keys goes through here, so
+// recorded input plays back exactly as it was first played.
+void applyInput(GameContext *game, Uint32 input) {
+	bool *commands = game->input.commands;
+	bool *scriptCommands = game->input.scriptCommands;
+	Uint32 held = input & ((1u << PRESSED_SHIFT) - 1);
+	Uint32 pressed = input >> PRESSED_SHIFT;
+
+	//We're on a new step, so clear all previous checkCommand (not key) states (i.e. set to false)
+	memset(game->input.commands, 0, sizeof(game->input.commands));
+
+	for(int k=0; k < GAME_KEY_COUNT; k++) {
+		if(pressed & keyBit(k)) pressGameKey(game, k);
+	}
+
 	//Respond to held keys.
-	switch(gameState) {
+	switch(game->state) {
 		case STATE_INTRO:
 			if(scriptCommands[CMD_PLAYER_LEFT])
 				commands[CMD_PLAYER_LEFT] = true;
@@ -148,26 +232,53 @@ void pollInput() {
 				commands[CMD_PLAYER_FIRE] = true;
 			break;
 		case STATE_GAME:
-			if(keysHeld[SDL_SCANCODE_LEFT])
+			if(held & keyBit(KEY_LEFT))
 				commands[CMD_PLAYER_LEFT] = true;
-			else if(keysHeld[SDL_SCANCODE_RIGHT])
+			else if(held & keyBit(KEY_RIGHT))
 				commands[CMD_PLAYER_RIGHT] = true;
 
-			if(keysHeld[SDL_SCANCODE_UP])
+			if(held & keyBit(KEY_UP))
 				commands[CMD_PLAYER_UP] = true;
-			else if(keysHeld[SDL_SCANCODE_DOWN])
+			else if(held & keyBit(KEY_DOWN))
 				commands[CMD_PLAYER_DOWN] = true;
 
-			if(keysHeld[SDL_SCANCODE_LCTRL] ||
-			   keysHeld[SDL_SCANCODE_SPACE])
+			if(held & (keyBit(KEY_LCTRL) | keyBit(KEY_SPACE)))
 				commands[CMD_PLAYER_FIRE] = true;
 
 			break;
 	}
 
-	memset(scriptCommands, 0, sizeof(scriptCommands));
+	memset(game->input.scriptCommands, 0, sizeof(game->input.scriptCommands));
+}
+
+//Once per game step, for the game being played (see applyInput).
+Uint32 pollInput() {
+	Uint32 pressed = pollEvents();
+
+	//Respond to held keys
+	const Uint8 *keysHeld = SDL_GetKeyboardState(NULL);
+	Uint32 held = 0;
+	for(int k=0; k < GAME_KEY_COUNT; k++) {
+		if(keysHeld[gameKeys[k]]) held |= keyBit(k);
+	}
+
+	//A replay stands in for the keyboard (the window can still be closed), and quits once it's over.
+	Uint32 input = held | (pressed << PRESSED_SHIFT);
+	if(isReplaying() && !replayInput(&input)) {
+		SDL_Log("Replay finished.");
+		quitRequested = true;
+		input = 0;
+	}
+	recordInput(input);
+
+	return input;
+}
+
+//Between game steps (e.g. while paused), only the window and system keys are listened to.
+void pollSystemInput() {
+	pollEvents();
 }
 
-void processSystemCommands() {
-	if(checkCommand(CMD_QUIT)) quit();
+void processSystemCommands(const GameContext *game) {
+	if(quitRequested || checkCommand(game, CMD_QUIT)) quit();
 }
\ No newline at end of file
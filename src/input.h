@@ -1,6 +1,10 @@
 #ifndef INPUT_H
 #define INPUT_H
 
+#include "common.h"
+
+#define MAX_COMMANDS 20
+
 typedef enum {
 	CMD_QUIT = 0,
 	CMD_PLAYER_UP = 1,
@@ -12,10 +16,18 @@ typedef enum {
 	CMD_MUSIC_TOGGLE = 7
 } Command;
 
+//A game's commands for the current step, from its input (or its scripts, during cutscenes).
+typedef struct {
+	bool commands[MAX_COMMANDS];
+	bool scriptCommands[MAX_COMMANDS];
+} InputState;
+
 extern void initInput();
-extern void pollInput();
-extern void processSystemCommands();
-extern bool checkCommand(int commandFlag);
-extern void scriptCommand(int commandFlag);
+extern Uint32 pollInput();
+extern void applyInput(GameContext *game, Uint32 input);
+extern void pollSystemInput();
+extern void processSystemCommands(const GameContext *game);
+extern bool checkCommand(const GameContext *game, int commandFlag);
+extern void scriptCommand(GameContext *game, int commandFlag);
 
 #endif
@@ -1,5 +1,6 @@
-#include <time.h>
+#include "gameclock.h"
 #include "assets.h"
+#include "animation.h"
 #include "common.h"
 #include "item.h"
 #include "weapon.h"
@@ -8,6 +9,7 @@
 #include "hud.h"
 #include "input.h"
 #include "sound.h"
+#include "game.h"
 #include "myc.h"
 
 typedef enum {
@@ -15,73 +17,39 @@ typedef enum {
 	SPAWN_ONE_ONSCREEN
 } ItemSpawnPolicy;
 
-typedef enum {
-	ANIM_SEQUENCE,
-	ANIM_BOOLEAN
-} AnimationStyle;
-
-typedef struct {
-	ItemType type;
-	Coord origin;
-	Coord parallax;
-	double swayInc;
-	bool swing;
-	int animFrame;
-	int maxAnims;
-	AnimationStyle animStyle;
-	char* baseFrameName;
-	char* realFrameName;
-	bool traveling;
-	bool throwing;
-	int dir;
-	double power;
-	double xSpeed;
-} Item;
-
-#define MAX_ITEMS 100
-
-static int itemCount = 0;
-static Item items[MAX_ITEMS];
 static const double ITEM_SPEED = 1.25;
 const int POWERUP_BOUND = 24;
-static bool boolAnimFrame = false;
-static long lastBoolAnimTime;
-
-static bool invalidPowerup(Item *powerup) {
-	//Unset struct.
-	if(powerup->maxAnims == 0) return true;
 
+//Whether a live item has fallen off the screen (and should be let go of).
+static bool invalidPowerup(const Item *powerup) {
 	//Past the screen bounds, plus it's own radius.
 	return powerup->origin.y > screenBounds.y + POWERUP_BOUND/2;
 }
 
 static bool shouldAnimate(Item item) {
-	return item.maxAnims > 1;
+	return item.clip->frameCount > 1;
 }
 
-static void updateAnimationFrame(Item* item) {
+static void updateAnimationFrame(const GameContext *game, Item* item) {
 	//Global flicker animation
 	if(item->animStyle == ANIM_BOOLEAN) {
-		item->animFrame = boolAnimFrame + 1;
+		item->animFrame = game->item.boolAnimFrame + 1;
 	//Loop frames.
-	}else if(item->animFrame == item->maxAnims) {
+	}else if(item->animFrame == item->clip->frameCount) {
 		item->animFrame = 1;
 	//Increment normal frame.
 	}else{
 		item->animFrame++;
 	}
+}
 
-	//Build the full filename of the animation, based on base, number of frame, and suffix.
-	sprintf(
-		item->realFrameName,
-		"%s%02d.png",
-		item->baseFrameName,
-		item->animFrame
-	);
+static Coord itemParallax(const GameContext *game, Coord origin) {
+	return parallax(game, origin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_X, PARALLAX_ADDITIVE);
 }
 
-static Coord itemParallax(Coord origin) {
-	return parallax(origin, PARALLAX_PAN, PARALLAX_LAYER_FOREGROUND, PARALLAX_X, PARALLAX_ADDITIVE);
+//Traveling items head for the HUD, so they're drawn without parallax.
+static Coord itemDrawCoord(Item *item) {
+	return item->traveling ? item->origin : item->parallax;
 }
 
 static ItemSpawnPolicy getSpawnPolicyForType(ItemType type) {
@@ -95,14 +63,15 @@ static ItemSpawnPolicy getSpawnPolicyForType(ItemType type) {
 	}
 }
 
-bool canSpawn(ItemType type) {
+bool canSpawn(const GameContext *game, ItemType type) {
+	const Item *items = game->item.items;
 
 	switch(type) {
 		case TYPE_HEALTH:
-			if(atFullhealth()) return false;
+			if(atFullhealth(game)) return false;
 			break;
 		case TYPE_WEAPON:
-			if(atMaxWeapon()) return false;
+			if(atMaxWeapon(game)) return false;
 			break;
 	}
 
@@ -112,7 +81,7 @@ bool canSpawn(ItemType type) {
 		case SPAWN_ALWAYS:
 			return true;
 		case SPAWN_ONE_ONSCREEN:
-			for(int i=0; i < MAX_ITEMS; i++) {
+			FOR_EACH_SLOT(&game->item.itemPool, i) {
 				if(invalidPowerup(&items[i])) continue;
 				if(items[i].type == type) {
 					return false;
@@ -122,83 +91,71 @@ bool canSpawn(ItemType type) {
 	}
 }
 
-void throwItem(Coord coord, ItemType type, int dir, double power, double xSpeed) {
-	int i = spawnItem(coord, type);
+void throwItem(GameContext *game, Coord coord, ItemType type, int dir, double power, double xSpeed) {
+	Item *items = game->item.items;
+	int i = spawnItem(game, coord, type);
+	if(i < 0) return;
 	items[i].throwing = true;
 	items[i].dir = dir;
 	items[i].power = power;
 	items[i].xSpeed = xSpeed;
 }
 
-int spawnItem(Coord coord, ItemType type) {
-	//Stop spawning items after we've elapsed our total.
-	if(itemCount == MAX_ITEMS) itemCount = 0;
+int spawnItem(GameContext *game, Coord coord, ItemType type) {
+	ItemContext *item = &game->item;
+
+	//Drop the spawn if every slot is taken.
+	int slot = acquireSlot(&item->itemPool);
+	if(slot < 0) return -1;
 
 	bool swing;
-	int maxAnims = 1;
 	AnimationStyle animRate;
-
-	//Reserve space on struct for both string arrays (must be pointers, we can't reassign to arrays)
-	char* realFrameName = malloc(sizeof(char) * 50);
-	char* baseFrameName = malloc(sizeof(char) * 50);
+	ClipId clip;
 
 	switch(type) {
 		case TYPE_COIN:
 			swing = false;
-			maxAnims = 12;
 			animRate = ANIM_SEQUENCE;
-			strcpy(baseFrameName, "coin-");
+			clip = CLIP_COIN;
 			break;
 		case TYPE_FRUIT: {
-			int chance = randomMq(0, 100);
+			int chance = randomMq(&game->random[RANDOM_ITEMS], 0, 100);
 
 			if(chance < 33) {
-				strcpy(baseFrameName, "cherries-");
-				strcpy(realFrameName, "cherries-");
+				clip = CLIP_CHERRIES;
 			}else if(chance > 66) {
-				strcpy(baseFrameName, "grape-");
-				strcpy(realFrameName, "grape-");
+				clip = CLIP_GRAPE;
 			}else{
-				strcpy(baseFrameName, "pineapple-");
-				strcpy(realFrameName, "pineapple-");
+				clip = CLIP_PINEAPPLE;
 			}
 
 			swing = false;
 			animRate = ANIM_BOOLEAN;
-			maxAnims = 2;
 			break;
 		}
 		case TYPE_WEAPON:
 			swing = true;
 			animRate = ANIM_BOOLEAN;
 
-			char* filename = NULL;
-			switch(weaponInc) {
+			switch(game->weapon.weaponInc) {
 				case 0:
-					filename = "powerup-double-";
-					maxAnims = 2;
+					clip = CLIP_POWERUP_DOUBLE;
 					break;
 				case 1:
-					filename = "powerup-triple-";
-					maxAnims = 2;
+					clip = CLIP_POWERUP_TRIPLE;
 					break;
 				case 2:
-					filename = "powerup-fan.png";
+					clip = CLIP_POWERUP_FAN;
 					break;
 				default:
-					filename = "powerup.png";
+					clip = CLIP_POWERUP;
 					break;
 			}
-
-			strcpy(baseFrameName, filename);
-			strcpy(realFrameName, filename);
 			break;
 		case TYPE_HEALTH:
 			swing = true;
 			animRate = ANIM_BOOLEAN;
-			maxAnims = 2;
-			strcpy(baseFrameName, "battery-pack-");
-			strcpy(realFrameName, "battery-pack-");
+			clip = CLIP_BATTERY_PACK;
 			break;
 	}
 
@@ -206,82 +163,96 @@ int spawnItem(Coord coord, ItemType type) {
 	Item powerup = {
 		type,
 		coord,
-		itemParallax(coord),
+		itemParallax(game, coord),
 		0,
 		swing,
 		1,
-		maxAnims,
 		animRate,
-		baseFrameName,
-		realFrameName,
+		getClip(clip),
 		false
 	};
-	if(shouldAnimate(powerup)) updateAnimationFrame(&powerup);
+	powerup.lastDrawn = itemDrawCoord(&powerup);
+	if(shouldAnimate(powerup)) updateAnimationFrame(game, &powerup);
 
-	items[itemCount++] = powerup;
+	item->items[slot] = powerup;
 	
-	return itemCount - 1;
+	return slot;
 }
 
-void itemShadowFrame() {
+void itemShadowFrame(GameContext *game) {
+	Item *items = game->item.items;
 	//Render powerup shadows
-	for(int i=0; i < MAX_ITEMS; i++) {
+	FOR_EACH_SLOT_IN_ORDER(&game->item.itemPool, i) {
 		//NB: We deliberately skip shadows for traveling ones.
-		if(invalidPowerup(&items[i]) || items[i].traveling) continue;
+		if(items[i].traveling) continue;
 
-		SDL_Texture *texture = getTextureVersion(items[i].realFrameName, ASSET_SHADOW);
-		Sprite sprite = makeSprite(texture, zeroCoord(), SDL_FLIP_NONE);
-		Coord shadowCoord = parallax(items[i].parallax, PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
+		const Sprite *sprite = clipFrame(items[i].clip, items[i].animFrame, ASSET_SHADOW);
+		Coord shadowCoord = parallax(game, interpolate(items[i].lastDrawn, items[i].parallax), PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
 		shadowCoord.y += STATIC_SHADOW_OFFSET;
-		drawSpriteAbs(sprite, shadowCoord);
+		drawSpriteAbs(*sprite, shadowCoord);
 	}
 }
 
-void itemRenderFrame() {
+void itemRenderFrame(GameContext *game) {
+	Item *items = game->item.items;
 	//Render items
-	for(int i=0; i < MAX_ITEMS; i++) {
-		if(invalidPowerup(&items[i])) continue;
-
-		SDL_Texture *texture = getTexture(items[i].realFrameName);
-		Sprite sprite = makeSprite(texture, zeroCoord(), SDL_FLIP_NONE);
+	FOR_EACH_SLOT_IN_ORDER(&game->item.itemPool, i) {
+		const Sprite *sprite = clipFrame(items[i].clip, items[i].animFrame, ASSET_DEFAULT);
+		Coord drawn = interpolate(items[i].lastDrawn, itemDrawCoord(&items[i]));
 		if(items[i].traveling) {
-			drawSpriteAbsRotated2(sprite, items[i].origin, 0, 1.2, 1.2);
+			drawSpriteAbsRotated2(*sprite, drawn, 0, 1.2, 1.2);
 		}else{
-			drawSpriteAbs(sprite, items[i].parallax);
+			drawSpriteAbs(*sprite, drawn);
 		}
 	}
 }
 
-void itemAnimateFrame() {
+void itemAnimateFrame(GameContext *game) {
+	Item *items = game->item.items;
 	//Powerups
-	for(int i=0; i < MAX_ITEMS; i++) {
-		if(invalidPowerup(&items[i])) continue;
+	FOR_EACH_SLOT(&game->item.itemPool, i) {
 		if(!shouldAnimate(items[i])) continue;
 
-		updateAnimationFrame(&items[i]);
+		updateAnimationFrame(game, &items[i]);
 	}
 
-	if(due(lastBoolAnimTime, 500)) {
-		lastBoolAnimTime = clock();
-		boolAnimFrame = !boolAnimFrame;
+	if(due(game, game->item.lastBoolAnimTime, 500)) {
+		game->item.lastBoolAnimTime = gameTime(game);
+		game->item.boolAnimFrame = !game->item.boolAnimFrame;
 	}
 }
 
-void itemGameFrame() {
+int countItems(const GameContext *game) {
+	return game->item.itemPool.count;
+}
+
+void itemSavePositions(GameContext *game) {
+	Item *items = game->item.items;
+	FOR_EACH_SLOT(&game->item.itemPool, i) {
+		items[i].lastDrawn = itemDrawCoord(&items[i]);
+	}
+}
+
+void itemGameFrame(GameContext *game) {
+	Item *items = game->item.items;
+	clearGrid(&game->item.grid);
+
 	//Powerups
-	for(int i=0; i < MAX_ITEMS; i++) {
-		if(invalidPowerup(&items[i])) continue;
+	FOR_EACH_SLOT(&game->item.itemPool, i) {
+		if(invalidPowerup(&items[i])) {
+			releaseSlot(&game->item.itemPool, i);
+			continue;
+		}
 
 		if(items[i].traveling) {
 			//Stop when we reach the HUD icon
 			if(items[i].origin.x >= 216) {
 				//Register the action associated with the item.
 				if(items[i].type == TYPE_COIN) {
-					coins++;
+					game->hud.coins++;
 				}
 
-				Item nullItem = {};
-				items[i] = nullItem;
+				releaseSlot(&game->item.itemPool, i);
 				continue;
 			}
 
@@ -292,7 +263,7 @@ void itemGameFrame() {
 
 			items[i].origin.x -= travelStep.x;
 			items[i].origin.y -= travelStep.y;
-			items[i].parallax = itemParallax(items[i].origin);
+			items[i].parallax = itemParallax(game, items[i].origin);
 			continue;
 		}else if(items[i].throwing) {
 			items[i].power -= 0.06;
@@ -305,56 +276,59 @@ void itemGameFrame() {
 			items[i].origin.y += ITEM_SPEED;
 		}
 		
-		items[i].parallax = itemParallax(items[i].origin);
+		items[i].parallax = itemParallax(game, items[i].origin);
 		
 		//Sway in sine wave pattern
 		if(items[i].swing){
 			items[i].parallax.x = sineInc(items[i].origin.x, &items[i].swayInc, 0.05, 32);
 		}
 
-		//Check if player touching
+		//File it for the pickup test.
+		addToGrid(&game->item.grid, i, makeSquareBounds(items[i].parallax, POWERUP_BOUND));
+	}
+
+	//Check if player touching (only those sharing the player's grid cell can be).
+	FOR_EACH_NEAR(&game->item.grid, game->player.origin, i) {
 		Rect powerupBound = makeSquareBounds(items[i].parallax, POWERUP_BOUND);
-		if(inBounds(playerOrigin, powerupBound)) {
+		if(inBounds(game->player.origin, powerupBound)) {
 			switch(items[i].type) {
 				case TYPE_COIN:
 					play("Pickup_Coin34.wav");
-					raiseScore(25, true);
+					raiseScore(game, 25, true);
 					items[i].traveling = true;				//zoom off the screen.
 					items[i].origin = items[i].parallax;	//start from visual origin.
 					break;
 				case TYPE_FRUIT:
 					play("Pickup_Coin34.wav");
-					raiseScore(100, true);
-					fruit++;
+					raiseScore(game, 100, true);
+					game->hud.fruit++;
 					break;
 				case TYPE_WEAPON:
 					play("Powerup8.wav");
-					upgradeWeapon();
-					spawnPlume(PLUME_LASER);
+					upgradeWeapon(game);
+					spawnPlume(game, PLUME_LASER);
 					break;
 				case TYPE_HEALTH:
 					play("Powerup8.wav");
-					restoreHealth();
-					spawnPlume(PLUME_POWER);
+					restoreHealth(game);
+					spawnPlume(game, PLUME_POWER);
 					break;
 			}
 
-			//Null any non-traveling items immediately.
-			if(!items[i].traveling) {
-				Item nullPowerup = { };
-				items[i] = nullPowerup;
-			}
+			//Let go of any non-traveling items immediately.
+			if(!items[i].traveling) releaseSlot(&game->item.itemPool, i);
 		}
 	}
 }
 
-void resetItems() {
-	memset(items, 0, sizeof(items));
-	itemCount = 0;
+void resetItems(GameContext *game) {
+	clearPool(&game->item.itemPool);
 }
 
-void itemInit() {
-	lastBoolAnimTime = clock();
-	resetItems();
-	itemAnimateFrame();
+void itemInit(GameContext *game) {
+	game->item.lastBoolAnimTime = gameTime(game);
+	initPool(&game->item.itemPool, "item", game->item.itemSlots, MAX_ITEMS);
+	initGrid(&game->item.grid, game->item.gridSlots, MAX_ITEMS);
+	resetItems(game);
+	itemAnimateFrame(game);
 }
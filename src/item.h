@@ -2,6 +2,11 @@
 #define ITEM_H
 
 #include "common.h"
+#include "animation.h"
+#include "pool.h"
+#include "grid.h"
+
+#define MAX_ITEMS 100
 
 typedef enum {
 	TYPE_FRUIT,
@@ -10,15 +15,49 @@ typedef enum {
 	TYPE_HEALTH
 } ItemType;
 
+typedef enum {
+	ANIM_SEQUENCE,
+	ANIM_BOOLEAN
+} AnimationStyle;
+
+typedef struct {
+	ItemType type;
+	Coord origin;
+	Coord parallax;
+	double swayInc;
+	bool swing;
+	int animFrame;
+	AnimationStyle animStyle;
+	const AnimationClip *clip;
+	bool traveling;
+	bool throwing;
+	int dir;
+	double power;
+	double xSpeed;
+	Coord lastDrawn;		//where it was drawn as of the previous game step.
+} Item;
+
+typedef struct {
+	Item items[MAX_ITEMS];
+	Pool itemPool;
+	int itemSlots[POOL_STORAGE(MAX_ITEMS)];
+	Grid grid;				//items that can be picked up, as of this game step.
+	int gridSlots[GRID_STORAGE(MAX_ITEMS)];
+	bool boolAnimFrame;
+	long lastBoolAnimTime;
+} ItemContext;
+
 extern void shutdownInput();
-extern bool canSpawn(ItemType type);
-extern int spawnItem(Coord coord, ItemType type);
-extern void throwItem(Coord coord, ItemType type, int dir, double power, double xSpeed);
-extern void itemInit();
-extern void itemGameFrame();
-extern void itemShadowFrame();
-extern void itemRenderFrame();
-extern void itemAnimateFrame();
-extern void resetItems();
+extern bool canSpawn(const GameContext *game, ItemType type);
+extern int spawnItem(GameContext *game, Coord coord, ItemType type);
+extern void throwItem(GameContext *game, Coord coord, ItemType type, int dir, double power, double xSpeed);
+extern void itemInit(GameContext *game);
+extern int countItems(const GameContext *game);
+extern void itemGameFrame(GameContext *game);
+extern void itemSavePositions(GameContext *game);
+extern void itemShadowFrame(GameContext *game);
+extern void itemRenderFrame(GameContext *game);
+extern void itemAnimateFrame(GameContext *game);
+extern void resetItems(GameContext *game);
 
 #endif
@@ -1,15 +1,12 @@
 #include <stdbool.h>
-#include <time.h>
+#include "gameclock.h"
 #include "common.h"
 #include "enemy.h"
 #include "hud.h"
+#include "level.h"
+#include "game.h"
 #include "myc.h"
 
-typedef enum {
-	W_COL,
-	W_WARNING
-} WaveType;
-
 typedef enum {
     SNAKE,
     MAG_SPLIT,
@@ -45,40 +42,10 @@ typedef struct {
 	double ampMult;
 } MapWave;
 
-typedef struct {
-	bool Warning;
-	bool Pause;
-	bool PauseFinished;
-	int SpawnTime;
-	WaveType WaveType;
-	int x;
-	int y;
-	EnemyPattern Movement;
-	EnemyType Type;
-	EnemyCombat Combat;
-	bool Async;
-	double Speed;
-	double SpeedX;
-	double Health;
-	int Qty;
-	bool Finished;
-	long StartedPausing;
-    bool Started;
-	double Frequency;
-	double AmpMult;
-    long FinishedPausing;
-} WaveTrigger;
-
-#define MAX_WAVES 200
-
 static const int NA = -50;
 
-WaveTrigger triggers[MAX_WAVES];
 static MapWave mapWaves[100];
 static int mapWaveInc = 0;
-static int waveAddInc = 0;
-static bool pausing = false;
-static long gameStartTime;
 
 // -------------------------------------------------------------------------
 
@@ -86,31 +53,31 @@ bool invalidWave(WaveTrigger *wave) {
 	return wave->Health == 0 && !wave->Pause && !wave->Warning;
 }
 
-void warning() {
+void warning(LevelContext *level) {
 	WaveTrigger e = {
 		true, false, false, 0, W_WARNING, 0, 0, PATTERN_BOB, ENEMY_CD, COMBAT_IDLE, false, 0, 0, 0, 0
 	};
 
-	triggers[waveAddInc++] = e;
+	level->triggers[level->waveAddInc++] = e;
 }
 
-void pause(int spawnTime) {
+void pause(LevelContext *level, int spawnTime) {
 	WaveTrigger e = {
 		false, true, false, spawnTime, W_COL, 0, 0, PATTERN_BOB, ENEMY_CD, COMBAT_IDLE, false, 0, 0, 0, 0, false, 0, false, 0, 0, 0
 	};
 
-	triggers[waveAddInc++] = e;
+	level->triggers[level->waveAddInc++] = e;
 }
 
-void wave(int spawnTime, WaveType waveType, int x, int y, EnemyPattern movement, EnemyType type, EnemyCombat combat, bool async, double speed, double speedX, double health, int qty, double frequency, double ampMult) {
+void wave(LevelContext *level, int spawnTime, WaveType waveType, int x, int y, EnemyPattern movement, EnemyType type, EnemyCombat combat, bool async, double speed, double speedX, double health, int qty, double frequency, double ampMult) {
 	WaveTrigger e = {
 		false, false, false, spawnTime, waveType, x, y, movement, type, combat, async, speed, speedX, health, qty, false, 0, false, frequency, ampMult, 0
 	};
 
-	triggers[waveAddInc++] = e;
+	level->triggers[level->waveAddInc++] = e;
 }
 
-void w_column(int x, int y, EnemyPattern movement, EnemyType type, EnemyCombat combat, bool async, double speed, double speedX, int qty, double health, double frequency, double ampMult) {
+void w_column(GameContext *game, int x, int y, EnemyPattern movement, EnemyType type, EnemyCombat combat, bool async, double speed, double speedX, int qty, double health, double frequency, double ampMult) {
 	int startY = y > NA ? y : NA; //respect Y if given, otherwise normal offscreen pos.
 	int sineInc = 0;
 
@@ -118,18 +85,21 @@ void w_column(int x, int y, EnemyPattern movement, EnemyType type, EnemyCombat c
 	double sineIncInc = qty / 3.14;
 
 	for(int i=0; i < qty; i++) {
-		spawnEnemy(x, startY, type, movement, combat, speed, speedX, sineInc, health, frequency, ampMult);
+		spawnEnemy(game, x, startY, type, movement, combat, speed, speedX, sineInc, health, frequency, ampMult);
 		startY -= 35;
 		if(async) sineInc += sineIncInc;
 	}
 }
 
 //Wires up wave spawners with their triggers.
-void levelGameFrame() {
-	if(gameState != STATE_GAME) return;
+void levelGameFrame(GameContext *game) {
+	if(game->state != STATE_GAME) return;
+
+	LevelContext *level = &game->level;
+	WaveTrigger *triggers = level->triggers;
 
     // Cycle through all triggers per-frame.
-	for(int i=0; i < waveAddInc; i++) {
+	for(int i=0; i < level->waveAddInc; i++) {
 		WaveTrigger trigger = triggers[i];
 
 		// Ignore finished or unset triggers.
@@ -140,14 +110,14 @@ void levelGameFrame() {
             // Start pausing if we're not already (NB: We don't bother about many pauses at this point, because
             // we stop looping at the first active or candidate trigger).
             if(!triggers[i].Started) {
-                triggers[i].StartedPausing = clock();
+                triggers[i].StartedPausing = gameTime(game);
                 triggers[i].Started = true;
                 break;
 
             // Stop pausing if we've reached the delay time.
-            } else if (due(triggers[i].StartedPausing, trigger.SpawnTime)) {
+            } else if (due(game, triggers[i].StartedPausing, trigger.SpawnTime)) {
 				triggers[i].Finished = true;
-                triggers[i].FinishedPausing = clock();
+                triggers[i].FinishedPausing = gameTime(game);
 
             // Don't cycle past a pause if we're still on it.
 			}else{
@@ -156,21 +126,21 @@ void levelGameFrame() {
 
         // Warnings.
 		}else if(trigger.Warning) {
-			toggleWarning();
+			toggleWarning(game);
 			triggers[i].Finished = true;
 
 		// Enemies
         }else{
             // If our spawn time is due, SINCE the last pause time, fire away!
-            long pauseBeforeWave = gameStartTime;
+            long pauseBeforeWave = level->gameStartTime;
             for(int j=i; j > 0; j--) {
                 if(triggers[j].Pause && triggers[j].Finished) {
                     pauseBeforeWave = triggers[j].FinishedPausing;
                     break;
                 }
             }
-			if(due(pauseBeforeWave, trigger.SpawnTime)) {
-				w_column(trigger.x, trigger.y, trigger.Movement, trigger.Type, trigger.Combat, trigger.Async, trigger.Speed, trigger.SpeedX, trigger.Qty, trigger.Health, trigger.Frequency, trigger.AmpMult);
+			if(due(game, pauseBeforeWave, trigger.SpawnTime)) {
+				w_column(game, trigger.x, trigger.y, trigger.Movement, trigger.Type, trigger.Combat, trigger.Async, trigger.Speed, trigger.SpeedX, trigger.Qty, trigger.Health, trigger.Frequency, trigger.AmpMult);
 				triggers[i].Finished = true;
 			}
 		}
@@ -335,7 +305,9 @@ void loadLevel() {
 	fclose(file);
 }
 
-void runLevel() {
+void runLevel(GameContext *game) {
+    LevelContext *level = &game->level;
+
     const int LEFT = 40;
     const int RIGHT = 230;
     const int CENTER = 120;
@@ -360,32 +332,32 @@ void runLevel() {
 
 			case COLUMN:
 				for(int i=0; i < map.qty; i++)
-					wave(i * spacing, W_COL, map.position, NA, PATTERN_NONE, map.enemyType, map.combat, false, map.speed, 0.05, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
+					wave(level, i * spacing, W_COL, map.position, NA, PATTERN_NONE, map.enemyType, map.combat, false, map.speed, 0.05, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
 
 				break;
 
 			case SNAKE:
                 for(int i=0; i < map.qty; i++)
-                    wave(i * spacing, W_COL, map.position, NA, PATTERN_SNAKE, map.enemyType, map.combat, false, map.speed, 0.05, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
+                    wave(level, i * spacing, W_COL, map.position, NA, PATTERN_SNAKE, map.enemyType, map.combat, false, map.speed, 0.05, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
 
                 break;
 
 			case SNAKE_REV:
 				for(int i=0; i < map.qty; i++)
-					wave(i * spacing, W_COL, map.position, NA, PATTERN_SNAKE_REV, map.enemyType, map.combat, false, map.speed, 0.05, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
+					wave(level, i * spacing, W_COL, map.position, NA, PATTERN_SNAKE_REV, map.enemyType, map.combat, false, map.speed, 0.05, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
 
 				break;
 
 			case MAG_SPLIT:
                 for(int i=0; i < map.qty; i++) {
-                    wave(i * spacing, W_COL, C_LEFT, NA, P_CURVE_LEFT, map.enemyType, map.combat, false, map.speed, 1, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
-                    wave(i * spacing, W_COL, C_RIGHT, NA, P_CURVE_RIGHT, map.enemyType, map.combat, false, map.speed, 1, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
+                    wave(level, i * spacing, W_COL, C_LEFT, NA, P_CURVE_LEFT, map.enemyType, map.combat, false, map.speed, 1, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
+                    wave(level, i * spacing, W_COL, C_RIGHT, NA, P_CURVE_RIGHT, map.enemyType, map.combat, false, map.speed, 1, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
                 }
                 break;
 
             case STRAFER:
                 for(int i=0; i < map.qty; i++) {
-                    wave(ceil(i * spacing * 1.5), W_COL, offscreenPos, -40,
+                    wave(level, ceil(i * spacing * 1.5), W_COL, offscreenPos, -40,
                          mapWaves[w].position == POS_L ? P_STRAFE_RIGHT : P_STRAFE_LEFT,
 						 map.enemyType, COMBAT_HOMING, false, map.speed, 1.5, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
                 }
@@ -393,7 +365,7 @@ void runLevel() {
 
             case PEELER:
                 for(int i=0; i < map.qty; i++) {
-                    wave(i * spacing, W_COL, map.position, NA,
+                    wave(level, i * spacing, W_COL, map.position, NA,
                          mapWaves[w].position == POS_LL ? P_PEEL_RIGHT : P_PEEL_LEFT,
 						 map.enemyType, map.combat, false, map.speed, 0.008, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
                 }
@@ -401,37 +373,36 @@ void runLevel() {
 
             case SWIRLER:
                 for(int i=0; i < map.qty; i++) {
-                    wave(i * spacing, W_COL, mapWaves[w].position + 50, NA, P_SWIRL_RIGHT, map.enemyType, map.combat, false, map.speed, 0.09, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
-                    wave((spacing/2) + i * spacing, W_COL, mapWaves[w].position, NA, P_SWIRL_LEFT, map.enemyType, i == 4 ? map.combat : map.combat, false, map.speed, 0.09, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
+                    wave(level, i * spacing, W_COL, mapWaves[w].position + 50, NA, P_SWIRL_RIGHT, map.enemyType, map.combat, false, map.speed, 0.09, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
+                    wave(level, (spacing/2) + i * spacing, W_COL, mapWaves[w].position, NA, P_SWIRL_LEFT, map.enemyType, i == 4 ? map.combat : map.combat, false, map.speed, 0.09, HEALTH_LIGHT, 1, map.frequency, map.ampMult);
                 }
                 break;
 
             case WARNING:
-                warning();
+                warning(level);
                 break;
 
             case BOSS_INTRO:
-                wave(0, W_COL, map.position, 310, PATTERN_BOSS_INTRO, map.enemyType, COMBAT_IDLE, false, map.speed, 0, 200, 1, map.frequency, map.ampMult);
+                wave(level, 0, W_COL, map.position, 310, PATTERN_BOSS_INTRO, map.enemyType, COMBAT_IDLE, false, map.speed, 0, 200, 1, map.frequency, map.ampMult);
                 break;
 
             case BOSS:
-//				wave(0, W_COL, map.position, NA, PATTERN_BOSS, map.enemyType, COMBAT_HOMING, false, map.speed, 1, 200, 1, map.frequency, map.ampMult);
-                wave(0, W_COL, map.position, NA, PATTERN_BOSS, map.enemyType, COMBAT_HOMING, false, map.speed, 1, 1, 1, map.frequency, map.ampMult);
+//				wave(level, 0, W_COL, map.position, NA, PATTERN_BOSS, map.enemyType, COMBAT_HOMING, false, map.speed, 1, 200, 1, map.frequency, map.ampMult);
+                wave(level, 0, W_COL, map.position, NA, PATTERN_BOSS, map.enemyType, COMBAT_HOMING, false, map.speed, 1, 1, 1, map.frequency, map.ampMult);
                 break;
         }
 
         if(mapWaves[w].delay > 0) {
-            pause(mapWaves[w].delay);
+            pause(level, mapWaves[w].delay);
         }
     }
 }
 
-void resetLevel() {
-    gameStartTime = clock();
-	waveAddInc = 0;
+void resetLevel(GameContext *game) {
+    game->level.gameStartTime = gameTime(game);
+	game->level.waveAddInc = 0;
 }
 
 void levelInit() {
 	loadLevel();
-	resetLevel();
 }
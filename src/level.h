@@ -1,9 +1,49 @@
 #ifndef LEVEL_H
 #define LEVEL_H
 
-extern void levelGameFrame();
+#include "enemy.h"
+
+#define MAX_WAVES 200
+
+typedef enum {
+	W_COL,
+	W_WARNING
+} WaveType;
+
+typedef struct {
+	bool Warning;
+	bool Pause;
+	bool PauseFinished;
+	int SpawnTime;
+	WaveType WaveType;
+	int x;
+	int y;
+	EnemyPattern Movement;
+	EnemyType Type;
+	EnemyCombat Combat;
+	bool Async;
+	double Speed;
+	double SpeedX;
+	double Health;
+	int Qty;
+	bool Finished;
+	long StartedPausing;
+    bool Started;
+	double Frequency;
+	double AmpMult;
+    long FinishedPausing;
+} WaveTrigger;
+
+//Wave triggers for the level in progress, built from the map by runLevel().
+typedef struct {
+	WaveTrigger triggers[MAX_WAVES];
+	int waveAddInc;
+	long gameStartTime;
+} LevelContext;
+
+extern void levelGameFrame(GameContext *game);
 extern void levelInit();
-extern void resetLevel();
-extern void runLevel();
+extern void resetLevel(GameContext *game);
+extern void runLevel(GameContext *game);
 
 #endif
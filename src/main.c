@@ -3,6 +3,7 @@
 #include "mysdl.h"
 #include "common.h"
 #include "assets.h"
+#include "animation.h"
 #include "renderer.h"
 #include "player.h"
 #include "input.h"
@@ -14,6 +15,12 @@
 #include "hud.h"
 #include "item.h"
 #include "level.h"
+#include "scheduler.h"
+#include "gameclock.h"
+#include "profiler.h"
+#include "trace.h"
+#include "replay.h"
+#include "game.h"
 #include "myc.h"
 
 // !!!IMPORTANT!!!
@@ -39,7 +46,23 @@ static const char *GAME_TITLE = "Mouse Quest";
 
 bool running = true;
 
+static const char *recordPath;
+static const char *replayPath;
+static GameContext *game;
+
+//Headless runs only do game steps, as fast as they'll go (see runHeadless).
+static bool headless = false;
+static long headlessTicks = 10000;
+static int headlessThreads = 1;
+
 static void initSDL() {
+	//Assets still want a renderer, so headless runs get a software one on a window that's never shown.
+	if(headless) {
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+		SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+	}
+
 	SDL_Init(SDL_INIT_VIDEO);
 
 	//Init SDL_Image for PNG support.
@@ -59,7 +82,7 @@ static void initWindow() {
 		SDL_WINDOWPOS_UNDEFINED,
 		(int)windowSize.x,					//dimensions
 		(int)windowSize.y,
-		SDL_WINDOW_OPENGL | (FULLSCREEN ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0)
+		headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_OPENGL | (FULLSCREEN ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0)
 	);
 
 	//Hide cursor in fullscreen
@@ -74,6 +97,9 @@ static void shutdownWindow() {
 	window = NULL;
 }
 void shutdownMain() {
+	shutdownTrace();
+	shutdownReplay();
+	shutdownAnimations();
 	shutdownAssets();
 	shutdownRenderer();
 	shutdownWindow();
@@ -82,12 +108,92 @@ void shutdownMain() {
 	SDL_Quit();
 }
 
+//Options for every platform (the Windows build checks -generate and -window first).
+static void parseOptions(int argc, char *argv[]) {
+	for(int i=1; i < argc; i++) {
+		if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			startTrace(argv[++i]);
+		}else if(strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			recordPath = argv[++i];
+		}else if(strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			replayPath = argv[++i];
+		}else if(strcmp(argv[i], "--headless") == 0) {
+			headless = true;
+			FULLSCREEN = false;
+		}else if(strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+			headlessTicks = strtol(argv[++i], NULL, 10);
+		}else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			headlessThreads = (int)strtol(argv[++i], NULL, 10);
+			if(headlessThreads < 1) headlessThreads = 1;
+		}
+	}
+}
+
+//Polls (or replays) this step's input and runs it on the game.
+static void gameStep() {
+	Uint32 input;
+	PROFILE(PROFILE_INPUT, input = pollInput());
+	stepGame(game, input);
+	PROFILE(PROFILE_INPUT, processSystemCommands(game));
+}
+
+//Extra headless games, each stepped flat out on its own thread with no input.
+static int runHeadlessGame(void *data) {
+	GameContext *extra = data;
+	for(long ticks=0; ticks < headlessTicks; ticks++) {
+		stepGame(extra, 0);
+	}
+	return 0;
+}
+
+//Runs game steps back to back with nothing drawn, then reports how fast they went. Stops early if
+// the game quits (e.g. a replay runs out). With --threads, the extra games run alongside this one.
+static void runHeadless(Uint32 seed) {
+	SDL_Thread *threads[headlessThreads];
+	GameContext *extras[headlessThreads];
+
+	//Games are created up front on this thread, as creating one still touches shared (SDL) state.
+	for(int t=1; t < headlessThreads; t++) {
+		extras[t] = createGame(seed + t);
+		triggerState(extras[t], STATE_GAME);
+	}
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for(int t=1; t < headlessThreads; t++) {
+		threads[t] = SDL_CreateThread(runHeadlessGame, "headless game", extras[t]);
+		if(threads[t] == NULL) {
+			fatalError("Fatal error", SDL_GetError());
+			exit(1);
+		}
+	}
+
+	long ticks = 0;
+	while(running && ticks < headlessTicks) {
+		gameStep();
+		profileEndFrame();
+		ticks++;
+	}
+
+	for(int t=1; t < headlessThreads; t++) {
+		SDL_WaitThread(threads[t], NULL);
+		ticks += headlessTicks;
+		destroyGame(extras[t]);
+	}
+	double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+	printf("Ran %ld ticks on %d thread(s) in %.3fs: %.0f ticks per second.\n",
+			ticks, headlessThreads, seconds, seconds > 0 ? ticks / seconds : 0);
+}
+
 static void setWindowIcon() {
 	SDL_Surface* icon = reloadSurface("mike-lean-02.png");
 	SDL_SetWindowIcon(window, icon);
 }
 
 static void generate() {
+    Random random;
+    seedRandom(&random, (Uint64)time(NULL));
+
     FILE *fp;
     fp = fopen("C:\\Users\\lxm\\dev\\mq\\src\\LEVEL-custom.csv", "w");
     if(fp == NULL) exit(-1);
@@ -109,7 +215,7 @@ static void generate() {
         char* position;
 
         // Always make sure we spawn left then right.
-        int thisPos = wasLeft ? chance(75) ? 2 : 3 : chance(75) ? 1 : 0;
+        int thisPos = wasLeft ? chance(&random, 75) ? 2 : 3 : chance(&random, 75) ? 1 : 0;
         wasLeft = thisPos < 2;
 
         switch(thisPos) {
@@ -129,11 +235,11 @@ static void generate() {
 
         fprintf(fp,
                 "%s,NA,%d,%f,%s,%s,0.075,220,%d\n",
-                randomMq(0,1) ? "DISK" : "DISK_BLUE", randomMq(4,12), randomMq(0,1) ? 2.4 : 1.7, randomMq(0,1) ? "SNAKE" : "COLUMN", position, randomMq(1750, 2250)
+                randomMq(&random, 0,1) ? "DISK" : "DISK_BLUE", randomMq(&random, 4,12), randomMq(&random, 0,1) ? 2.4 : 1.7, randomMq(&random, 0,1) ? "SNAKE" : "COLUMN", position, randomMq(&random, 1750, 2250)
         );
 
         // Always make sure we spawn left then right.
-        thisPos = wasLeft ? chance(75) ? 2 : 3 : chance(75) ? 1 : 0;
+        thisPos = wasLeft ? chance(&random, 75) ? 2 : 3 : chance(&random, 75) ? 1 : 0;
         wasLeft = thisPos < 2;
 
         switch(thisPos) {
@@ -153,7 +259,7 @@ static void generate() {
 
         fprintf(fp,
                 "%s,NA,%d,%f,%s,%s,0.075,220,%d\n",
-                randomMq(0,1) ? "DISK" : "DISK_BLUE", randomMq(4,12), randomMq(0,1) ? 2.4 : 1.7, randomMq(0,1) ? "SNAKE" : "COLUMN", position, randomMq(2500, 4000)
+                randomMq(&random, 0,1) ? "DISK" : "DISK_BLUE", randomMq(&random, 4,12), randomMq(&random, 0,1) ? 2.4 : 1.7, randomMq(&random, 0,1) ? "SNAKE" : "COLUMN", position, randomMq(&random, 2500, 4000)
         );
     }
 
@@ -167,9 +273,6 @@ static void generate() {
 #if defined(_WIN32)
 	int main(int argc, char *argv[]) {
 
-		//Seed randomMq number generator
-		srand(time(NULL));
-
 		// Windowed mode argument.
 		if(argc > 1 && strcmp(argv[1], "-generate") == 0) {
             generate();
@@ -187,87 +290,112 @@ static void generate() {
         }
 
 #else
-	int main()  {
-		//Seed randomMq number generator
-		srand(time(NULL));
+	int main(int argc, char *argv[])  {
 #endif
 
+	//Before anything starts threads, so tracing sees them.
+	parseOptions(argc, argv);
+
 	atexit(shutdownMain);
+	initProfiler();
+
+	//Seed the game's random streams. A replay brings its own seed, so it plays out the same again.
+	Uint32 seed = (Uint32)time(NULL);
+	if(replayPath != NULL) seed = startReplay(replayPath);
+	if(recordPath != NULL) startRecording(recordPath, seed);
 
 	initSDL();
 	initWindow();
 	initRenderer();
 	initAssets();
+	initAnimations();
+	loadWeapons();
 	setWindowIcon();
 	initInput();
 	initScripts();
-	playerInit();
-	initBackground();
-	enemyInit();
 	hudInit();
-	pewInit();
-	itemInit();
 	levelInit();
+	game = createGame(seed);
 
 #ifdef DEBUG_SKIP_TO_GAME
-	triggerState(STATE_GAME);
-//	triggerState(STATE_STATS);
+	triggerState(game, STATE_GAME);
+//	triggerState(game, STATE_STATS);
 #else
-	triggerState(STATE_TITLE);
+	//Nobody's there to press start on a headless run, unless it's replaying one that did.
+	triggerState(game, headless && replayPath == NULL ? STATE_GAME : STATE_TITLE);
 #endif
 
-	long lastRenderFrameTime = clock();
-	long lastGameFrameTime = lastRenderFrameTime;
-	long lastAnimFrameTime = lastRenderFrameTime;
+	if(headless) {
+		runHeadless(seed);
+		destroyGame(game);
+		return 0;
+	}
+
+	initScheduler();
 
-	//Main game loop (realtime)
+	//Main game loop (realtime), idling between ticks.
 	while(running){
-		//Game frame
-		if(timer(&lastGameFrameTime, GAME_HZ)) {
-			pollInput();
-			levelGameFrame();
-			processSystemCommands();
-			backgroundGameFrame();
-			scriptGameFrame();
-			playerGameFrame();
-			enemyGameFrame();
-			itemGameFrame();
-			pewGameFrame();
-			hudGameFrame();
-		}
+		DueTicks ticks = waitForTicks();
 
-		//Animation frame
-		if(timer(&lastAnimFrameTime, ANIMATION_HZ)) {
-			playerAnimate();
-			animateEnemy();
-			pewAnimateFrame();
-			hudAnimateFrame();
-			itemAnimateFrame();
+		//Game frames, in fixed steps (several, if we're catching up).
+		for(int step=0; step < ticks.gameSteps && running; step++) {
+			gameStep();
+		}
+		if(isGameClockPaused() && (ticks.sources & TICK_RENDER)) {
+			//Keep listening while paused, so we can resume (or quit).
+			PROFILE(PROFILE_INPUT, pollSystemInput());
+			PROFILE(PROFILE_INPUT, processSystemCommands(game));
 		}
 
-		//Renderer frame
-		if(timer(&lastRenderFrameTime, RENDER_HZ)) {
-			backgroundRenderFrame();
-			enemyBackgroundRenderFrame();	// we show certain enemies behind the background.
-			foregroundRenderFrame();		// show platforms.
+		//Renderer frame. Render sections only time queueing sprites; drawing them happens on flush,
+		// so lands in canvas (or render hud, where the fader flushes).
+		if(ticks.sources & TICK_RENDER) {
+			traceBegin("render frame");
+			setInterpolation(ticks.alpha);
+
+			//Sprites are batched up, and drawn in this layer order on flush.
+			profileBegin(PROFILE_RENDER_BACKGROUND);
+			setRenderLayer(RENDER_LAYER_BACKGROUND);
+			backgroundRenderFrame(game);
+			setRenderLayer(RENDER_LAYER_BACKGROUND_ENEMIES);
+			enemyBackgroundRenderFrame(game);	// we show certain enemies behind the background.
+			setRenderLayer(RENDER_LAYER_PLATFORMS);
+			foregroundRenderFrame(game);		// show platforms.
+			profileEnd(PROFILE_RENDER_BACKGROUND);
 
 			if(ENABLE_SHADOWS) {
-				pewShadowFrame();
-				enemyShadowFrame();
-				playerShadowFrame();
-				itemShadowFrame();
+				setRenderLayer(RENDER_LAYER_SHADOWS);
+				profileBegin(PROFILE_RENDER_SHADOWS);
+				pewShadowFrame(game);
+				enemyShadowFrame(game);
+				playerShadowFrame(game);
+				itemShadowFrame(game);
+				profileEnd(PROFILE_RENDER_SHADOWS);
 			}
- 			enemyRenderFrame();
-			itemRenderFrame();
-			pewRenderFrame();
-			scriptRenderFrame();
-			playerRenderFrame();
-			hudRenderFrame();
-			faderRenderFrame();
-			persistentHudRenderFrame();
-			updateCanvas();
+			setRenderLayer(RENDER_LAYER_ENEMIES);
+			PROFILE(PROFILE_RENDER_ENEMIES, enemyRenderFrame(game));
+			setRenderLayer(RENDER_LAYER_ITEMS);
+			PROFILE(PROFILE_RENDER_ITEMS, itemRenderFrame(game));
+			setRenderLayer(RENDER_LAYER_SHOTS);
+			PROFILE(PROFILE_RENDER_SHOTS, pewRenderFrame(game));
+			setRenderLayer(RENDER_LAYER_SCRIPTS);
+			PROFILE(PROFILE_RENDER_SCRIPTS, scriptRenderFrame(game));
+			setRenderLayer(RENDER_LAYER_PLAYER);
+			PROFILE(PROFILE_RENDER_PLAYER, playerRenderFrame(game));
+			setRenderLayer(RENDER_LAYER_HUD);
+			profileBegin(PROFILE_RENDER_HUD);
+			hudRenderFrame(game);
+			faderRenderFrame(game);
+			setRenderLayer(RENDER_LAYER_PERSISTENT_HUD);
+			persistentHudRenderFrame(game);
+			if(isProfilerOverlayShowing()) showDebugStats(game);
+			profileEnd(PROFILE_RENDER_HUD);
+			PROFILE(PROFILE_CANVAS, updateCanvas());
+			profileEndFrame();
+			traceEnd("render frame");
 		}
 	}
 
+	destroyGame(game);
     return 0;
 }
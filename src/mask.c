@@ -0,0 +1,125 @@
+#include <math.h>
+#include "mask.h"
+#include "pixels.h"
+#include "myc.h"
+
+static const int MASK_ALPHA_THRESHOLD = 128;		//anything fainter is glow, not body.
+
+static bool isSolid(SDL_Surface *surface, int x, int y) {
+	int bytes = surface->format->BytesPerPixel;
+	Uint8 red, green, blue, alpha;
+	SDL_GetRGBA(readPixel((Uint8 *)surface->pixels + y * surface->pitch + x * bytes, bytes),
+			surface->format, &red, &green, &blue, &alpha);
+
+	return alpha >= MASK_ALPHA_THRESHOLD;
+}
+
+//Built once per image at load, so it's fine to go through SDL's format conversion a pixel at a time.
+Mask makeMask(SDL_Surface *surface) {
+	Mask mask = { surface->w, surface->h };
+
+	if(SDL_MUSTLOCK(surface)) SDL_LockSurface(surface);
+
+	//Find the solid box first, so the rows only cover that.
+	int left = surface->w, top = surface->h, right = -1, bottom = -1;
+	for(int y = 0; y < surface->h; y++) {
+		for(int x = 0; x < surface->w; x++) {
+			if(!isSolid(surface, x, y)) continue;
+			if(x < left) left = x;
+			if(x > right) right = x;
+			if(y < top) top = y;
+			if(y > bottom) bottom = y;
+		}
+	}
+
+	if(right >= 0) {
+		mask.left = left;
+		mask.top = top;
+		mask.width = right - left + 1;
+		mask.height = bottom - top + 1;
+		mask.stride = (mask.width + 63) / 64;
+		mask.rows = calloc(mask.stride * mask.height, sizeof(Uint64));
+
+		for(int y = 0; y < mask.height; y++) {
+			Uint64 *row = mask.rows + y * mask.stride;
+			for(int x = 0; x < mask.width; x++) {
+				if(isSolid(surface, left + x, top + y)) row[x / 64] |= (Uint64)1 << (x % 64);
+			}
+		}
+	}
+
+	if(SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+
+	return mask;
+}
+
+void freeMask(Mask *mask) {
+	free(mask->rows);
+	mask->rows = NULL;
+}
+
+//World pixel column/row of the solid box's top-left corner, with the image centred on the origin.
+static int solidLeft(const Mask *mask, Coord centre) {
+	return (int)floor(centre.x - mask->imageWidth / 2.0) + mask->left;
+}
+static int solidTop(const Mask *mask, Coord centre) {
+	return (int)floor(centre.y - mask->imageHeight / 2.0) + mask->top;
+}
+
+//Solid box in world space (as makeBounds makes them), e.g. for filing under a grid.
+Rect maskBounds(const Mask *mask, Coord centre) {
+	int left = solidLeft(mask, centre);
+	int top = solidTop(mask, centre);
+
+	return makeRect(left, top, left + mask->width, top + mask->height);
+}
+
+bool maskHolds(const Mask *mask, Coord centre, Coord point) {
+	int x = (int)floor(point.x) - solidLeft(mask, centre);
+	int y = (int)floor(point.y) - solidTop(mask, centre);
+	if(x < 0 || y < 0 || x >= mask->width || y >= mask->height) return false;
+
+	return mask->rows[y * mask->stride + x / 64] >> (x % 64) & 1;
+}
+
+//The 64 pixels of a row starting at the given column, which needn't fall on a word (or even within
+// the row - anything outside it is clear).
+static Uint64 rowWindow(const Uint64 *row, int stride, int column) {
+	int word = column >= 0 ? column / 64 : -((63 - column) / 64);
+	int shift = column - word * 64;
+
+	Uint64 low = word >= 0 && word < stride ? row[word] : 0;
+	if(shift == 0) return low;
+
+	Uint64 high = word + 1 >= 0 && word + 1 < stride ? row[word + 1] : 0;
+	return low >> shift | high << (64 - shift);
+}
+
+//Whether any solid pixels coincide: the solid boxes have to overlap first, then each shared row
+// is tested a word at a time against the other mask's row shifted into line.
+bool masksOverlap(const Mask *a, Coord aCentre, const Mask *b, Coord bCentre) {
+	int ax = solidLeft(a, aCentre), ay = solidTop(a, aCentre);
+	int bx = solidLeft(b, bCentre), by = solidTop(b, bCentre);
+
+	int left = ax > bx ? ax : bx;
+	int right = ax + a->width < bx + b->width ? ax + a->width : bx + b->width;
+	int top = ay > by ? ay : by;
+	int bottom = ay + a->height < by + b->height ? ay + a->height : by + b->height;
+	if(left >= right || top >= bottom) return false;
+
+	//Column c of a lines up with column c + shift of b.
+	int shift = ax - bx;
+	int firstWord = (left - ax) / 64;
+	int lastWord = (right - 1 - ax) / 64;
+
+	for(int y = top; y < bottom; y++) {
+		const Uint64 *aRow = a->rows + (y - ay) * a->stride;
+		const Uint64 *bRow = b->rows + (y - by) * b->stride;
+
+		for(int w = firstWord; w <= lastWord; w++) {
+			if(aRow[w] & rowWindow(bRow, b->stride, w * 64 + shift)) return true;
+		}
+	}
+
+	return false;
+}
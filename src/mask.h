@@ -0,0 +1,26 @@
+#ifndef MASK_H
+#define MASK_H
+
+#include <stdbool.h>
+#include "mysdl.h"
+#include "common.h"
+
+//Which pixels of an image are solid, for pixel-accurate collision. Only the bounding box of the
+// solid pixels is kept, as a row of 64-bit words per pixel row (bit 0 of a word is its leftmost
+// pixel, and bits past the box's right edge are always clear). Images are placed as sprites are
+// drawn: centred on their origin.
+typedef struct {
+	int imageWidth, imageHeight;
+	int left, top;			//solid box, from the image's top-left.
+	int width, height;		//solid box size (0 when nothing's solid).
+	int stride;				//words per row.
+	Uint64 *rows;
+} Mask;
+
+extern Mask makeMask(SDL_Surface *surface);
+extern void freeMask(Mask *mask);
+extern Rect maskBounds(const Mask *mask, Coord centre);
+extern bool maskHolds(const Mask *mask, Coord centre, Coord point);
+extern bool masksOverlap(const Mask *a, Coord aCentre, const Mask *b, Coord bCentre);
+
+#endif
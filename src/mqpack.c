@@ -0,0 +1,182 @@
+//mq-pack: decodes every asset once and writes them all to a single .mqpak, which the game maps at
+// startup instead of decoding the loose files (see mqpak.h).
+//
+//Usage: mq-pack [assets folder] [output file]
+//Both default to the assets folder next to the executable, as the game itself does.
+
+#include "myc.h"
+#include <stdio.h>
+#include "assets.h"
+#include "assetsource.h"
+#include "mqpak.h"
+
+static FILE *output;
+static Uint64 written;
+
+static bool writeBytes(const void *data, size_t size) {
+	if(size > 0 && fwrite(data, size, 1, output) != 1) return false;
+	written += size;
+	return true;
+}
+
+//Pads to PAK_ALIGNMENT, and returns the offset the next data will start at.
+static Uint64 alignOutput() {
+	static const Uint8 zeroes[PAK_ALIGNMENT];
+	Uint64 padding = (PAK_ALIGNMENT - written % PAK_ALIGNMENT) % PAK_ALIGNMENT;
+	writeBytes(zeroes, padding);
+	return written;
+}
+
+static void setSource(PakSource *source, const char *path) {
+	if(!readPakSource(path, source)) {
+		fprintf(stderr, "Could not read %s\n", path);
+		exit(1);
+	}
+}
+
+static void setKey(char *key, const char *filename) {
+	if(strlen(filename) >= PAK_KEY_LENGTH) {
+		fprintf(stderr, "Filename too long for a pack key: %s\n", filename);
+		exit(1);
+	}
+	strcpy(key, filename);
+}
+
+//Stores a surface's rows without any pitch padding, then frees it. Data never starts at 0 (the
+// header is there), so 0 is free to mean "not stored".
+static Uint64 writeSurface(SDL_Surface *surface) {
+	if(surface == NULL) return 0;
+
+	Uint64 offset = alignOutput();
+	for(int y=0; y < surface->h; y++) {
+		if(!writeBytes((Uint8 *)surface->pixels + y * surface->pitch, surface->w * 4)) {
+			fprintf(stderr, "Could not write image data to the pack\n");
+			exit(1);
+		}
+	}
+	SDL_FreeSurface(surface);
+
+	return offset;
+}
+
+static void writeImage(PakImage *entry, const char *assetsFolder, AssetDef definition) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s%s", assetsFolder, definition.filename);
+
+	DecodedImage image = decodeImage(path, definition);
+	if(image.original == NULL) {
+		fprintf(stderr, "Could not load %s: %s\n", path, IMG_GetError());
+		exit(1);
+	}
+
+	setKey(entry->key, definition.filename);
+	setSource(&entry->source, path);
+	entry->flags = pakImageFlags(definition);
+	entry->width = image.original->w;
+	entry->height = image.original->h;
+
+	//Shadow and alpha versions are made by page modulation at runtime, so they're never stored.
+	entry->pixels[ASSET_DEFAULT] = writeSurface(image.original);
+	entry->pixels[ASSET_SUPER] = writeSurface(image.super);
+	entry->pixels[ASSET_HIT] = writeSurface(image.hit);
+}
+
+//Sound and music are stored as the original files, which SDL_mixer reads straight from memory.
+static void writeFile(PakBlob *entry, const char *assetsFolder, const char *filename) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s%s", assetsFolder, filename);
+
+	size_t size;
+	void *data = SDL_LoadFile(path, &size);
+	if(data == NULL) {
+		fprintf(stderr, "Could not read %s: %s\n", path, SDL_GetError());
+		exit(1);
+	}
+
+	setKey(entry->key, filename);
+	setSource(&entry->source, path);
+	entry->offset = alignOutput();
+	entry->size = size;
+	if(!writeBytes(data, size)) {
+		fprintf(stderr, "Could not write %s to the pack\n", filename);
+		exit(1);
+	}
+	SDL_free(data);
+}
+
+int main(int argc, char *argv[]) {
+	if(SDL_Init(0) != 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+		fprintf(stderr, "Could not initialise SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	char defaultFolder[4096];
+	char *basePath = SDL_GetBasePath();
+	snprintf(defaultFolder, sizeof(defaultFolder), "%sassets/", basePath != NULL ? basePath : "");
+	SDL_free(basePath);
+
+	const char *assetsFolder = argc > 1 ? argv[1] : defaultFolder;
+	char outputPath[4096];
+	if(argc > 2) {
+		snprintf(outputPath, sizeof(outputPath), "%s", argv[2]);
+	}else{
+		snprintf(outputPath, sizeof(outputPath), "%s%s", assetsFolder, PAK_FILENAME);
+	}
+
+	PakHeader header = { PAK_MAGIC, PAK_BYTE_ORDER, ASSET_COUNT, soundDefinitionCount, musicDefinitionCount };
+	PakImage *images = calloc(ASSET_COUNT, sizeof(PakImage));
+	PakBlob *blobs = calloc(soundDefinitionCount + musicDefinitionCount, sizeof(PakBlob));
+	size_t tablesSize = sizeof(PakHeader) + sizeof(PakImage) * ASSET_COUNT
+			+ sizeof(PakBlob) * (soundDefinitionCount + musicDefinitionCount);
+
+	//Write to a temporary file, so a failed run never leaves the game a half-written pack.
+	char workingPath[4096 + 8];
+	snprintf(workingPath, sizeof(workingPath), "%s.part", outputPath);
+	output = fopen(workingPath, "wb");
+	if(output == NULL) {
+		fprintf(stderr, "Could not create %s\n", workingPath);
+		return 1;
+	}
+
+	//Data goes after the tables, which are filled in as it's written and then written last.
+	if(fseek(output, tablesSize, SEEK_SET) != 0) {
+		fprintf(stderr, "Could not write %s\n", workingPath);
+		return 1;
+	}
+	written = tablesSize;
+
+	for(int i=0; i < ASSET_COUNT; i++) {
+		writeImage(&images[i], assetsFolder, imageDefinitions[i]);
+	}
+	for(int i=0; i < soundDefinitionCount; i++) {
+		writeFile(&blobs[i], assetsFolder, soundDefinitions[i].filename);
+	}
+	for(int i=0; i < musicDefinitionCount; i++) {
+		writeFile(&blobs[soundDefinitionCount + i], assetsFolder, musicDefinitions[i]);
+	}
+	Uint64 total = written;
+
+	rewind(output);
+	bool ok = writeBytes(&header, sizeof(header))
+			&& writeBytes(images, sizeof(PakImage) * ASSET_COUNT)
+			&& writeBytes(blobs, sizeof(PakBlob) * (soundDefinitionCount + musicDefinitionCount));
+	ok = fclose(output) == 0 && ok;
+	if(ok) {
+		remove(outputPath);
+		ok = rename(workingPath, outputPath) == 0;
+	}
+	if(!ok) {
+		fprintf(stderr, "Could not write %s\n", outputPath);
+		remove(workingPath);
+		return 1;
+	}
+
+	printf("Packed %d images, %d sounds and %d music tracks into %s (%.1fMB).\n",
+			ASSET_COUNT, soundDefinitionCount, musicDefinitionCount, outputPath, total / (1024.0 * 1024.0));
+
+	free(images);
+	free(blobs);
+	IMG_Quit();
+	SDL_Quit();
+	return 0;
+}
@@ -0,0 +1,159 @@
+#ifndef _WIN32
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "myc.h"
+#include "mqpak.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <sys/types.h>
+	#include <sys/stat.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+//Maps the whole file read-only. Returns NULL if it can't be opened (which is normal - it's optional).
+static const Uint8 *mapFile(const char *path, size_t *size) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) return NULL;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return NULL;
+	}
+
+	//The view keeps the file mapped after both handles are closed.
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if(mapping == NULL) return NULL;
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if(data == NULL) return NULL;
+
+	*size = (size_t)fileSize.QuadPart;
+	return data;
+#else
+	int file = open(path, O_RDONLY);
+	if(file < 0) return NULL;
+
+	struct stat info;
+	if(fstat(file, &info) != 0 || info.st_size == 0) {
+		close(file);
+		return NULL;
+	}
+
+	//The mapping outlives the descriptor.
+	void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if(data == MAP_FAILED) return NULL;
+
+	*size = info.st_size;
+	return data;
+#endif
+}
+
+static void unmapFile(const Uint8 *data, size_t size) {
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap((void *)data, size);
+#endif
+}
+
+static bool inPak(const Pak *pak, Uint64 offset, Uint64 size) {
+	return offset <= pak->size && size <= pak->size - offset;
+}
+
+static bool validKey(const char *key) {
+	return memchr(key, '\0', PAK_KEY_LENGTH) != NULL;
+}
+
+//Checks every table and offset lies inside the file (and points at the tables), so nothing
+// later has to.
+static bool validPak(Pak *pak) {
+	if(pak->size < sizeof(PakHeader)) return false;
+	const PakHeader *header = pak->header;
+	if(memcmp(header->magic, PAK_MAGIC, sizeof(header->magic)) != 0) return false;
+	if(header->byteOrder != PAK_BYTE_ORDER) return false;
+
+	Uint64 tables = sizeof(PakHeader) + (Uint64)header->imageCount * sizeof(PakImage)
+			+ ((Uint64)header->soundCount + header->musicCount) * sizeof(PakBlob);
+	if(!inPak(pak, 0, tables)) return false;
+
+	pak->images = (const PakImage *)(header + 1);
+	pak->sounds = (const PakBlob *)(pak->images + header->imageCount);
+	pak->music = pak->sounds + header->soundCount;
+
+	for(Uint32 i=0; i < header->imageCount; i++) {
+		const PakImage *image = &pak->images[i];
+		if(!validKey(image->key)) return false;
+
+		Uint64 bytes = (Uint64)image->width * image->height * 4;
+		for(int v=0; v < ASSET_VERSIONS; v++) {
+			if(image->pixels[v] != 0 && !inPak(pak, image->pixels[v], bytes)) return false;
+		}
+	}
+	for(Uint32 i=0; i < header->soundCount + header->musicCount; i++) {
+		const PakBlob *blob = &pak->sounds[i];		//music follows straight on from sounds.
+		if(!validKey(blob->key) || !inPak(pak, blob->offset, blob->size)) return false;
+	}
+
+	return true;
+}
+
+bool openPak(Pak *pak, const char *path) {
+	Pak none = { };
+	*pak = none;
+
+	pak->data = mapFile(path, &pak->size);
+	if(pak->data == NULL) return false;
+
+	pak->header = (const PakHeader *)pak->data;
+	if(!validPak(pak)) {
+		SDL_Log("Ignoring %s, as it isn't a pack this build can read.", path);
+		closePak(pak);
+		return false;
+	}
+
+	return true;
+}
+
+void closePak(Pak *pak) {
+	if(pak->data != NULL) unmapFile(pak->data, pak->size);
+
+	Pak none = { };
+	*pak = none;
+}
+
+const void *pakData(const Pak *pak, Uint64 offset) {
+	return pak->data + offset;
+}
+
+Uint32 pakImageFlags(AssetDef definition) {
+	return definition.makeHitVersion
+		| definition.makeShadowVersion << 1
+		| definition.makeSuperVersion << 2
+		| definition.makeAlphaVersion << 3
+		| definition.isBackground << 4;
+}
+
+//Fills in a file's size and modification time, or returns false if it can't be read.
+bool readPakSource(const char *path, PakSource *source) {
+#ifdef _WIN32
+	struct _stat64 info;
+	if(_stat64(path, &info) != 0) return false;
+#else
+	struct stat info;
+	if(stat(path, &info) != 0) return false;
+#endif
+
+	source->size = info.st_size;
+	source->modified = info.st_mtime;
+	return true;
+}
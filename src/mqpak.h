@@ -0,0 +1,67 @@
+#ifndef MQPAK_H
+#define MQPAK_H
+
+#include "mysdl.h"
+#include <stdbool.h>
+#include "assets.h"
+#include "assetsource.h"
+
+//A .mqpak holds every asset pre-decoded, so the game can map it at startup rather than decode and
+// open hundreds of files. It's written by mq-pack, in native byte order:
+//
+//  PakHeader | PakImage[imageCount] | PakBlob[soundCount] | PakBlob[musicCount] | data
+//
+//Image data is ARGB8888 rows (pitch = width * 4), already colourised. Sound and music data are
+// the original files, for SDL_mixer to read from memory. Each entry records its source file's size
+// and modification time, so a pack is refused once any of them has been edited.
+
+#define PAK_FILENAME "mouse-quest.mqpak"
+#define PAK_MAGIC "MQPAK02"
+#define PAK_KEY_LENGTH 64
+#define PAK_ALIGNMENT 16
+#define PAK_BYTE_ORDER 0x01020304
+
+typedef struct {
+	char magic[8];
+	Uint32 byteOrder;		//PAK_BYTE_ORDER as written, so a foreign-endian pack is refused.
+	Uint32 imageCount;
+	Uint32 soundCount;
+	Uint32 musicCount;
+} PakHeader;
+
+typedef struct {
+	Uint64 size;
+	Sint64 modified;		//seconds since the epoch.
+} PakSource;
+
+typedef struct {
+	char key[PAK_KEY_LENGTH];
+	Uint32 flags;						//the AssetDef it was built from (see pakImageFlags).
+	Uint32 width, height;
+	Uint32 reserved;
+	PakSource source;
+	Uint64 pixels[ASSET_VERSIONS];		//data offset for each version, or 0 where it's not stored.
+} PakImage;
+
+typedef struct {
+	char key[PAK_KEY_LENGTH];
+	Uint64 offset, size;
+	PakSource source;
+} PakBlob;
+
+typedef struct {
+	const Uint8 *data;
+	size_t size;
+	const PakHeader *header;
+	const PakImage *images;
+	const PakBlob *sounds;
+	const PakBlob *music;
+} Pak;
+
+extern bool openPak(Pak *pak, const char *path);
+extern void closePak(Pak *pak);
+extern const void *pakData(const Pak *pak, Uint64 offset);
+extern Uint32 pakImageFlags(AssetDef definition);
+extern bool readPakSource(const char *path, PakSource *source);
+
+#endif
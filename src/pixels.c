@@ -0,0 +1,226 @@
+#include "pixels.h"
+
+int getPixel(SDL_Surface *surface, int x, int y) {
+	int *pixels = (int *)surface->pixels;
+	return pixels[ ( y * surface->w ) + x ];
+}
+void setPixel(SDL_Surface *surface, int x, int y, Uint32 pixel) {
+	int *pixels = (int *)surface->pixels;
+	pixels[ ( y * surface->w ) + x ] = pixel;
+}
+
+//Byte-wise form of a colourisation, for 32-bit formats whose channels each fill a whole byte:
+// opaque pixels become (saturating add(pixel, add) & keep) | fill, transparent ones are copied.
+typedef struct {
+	Uint32 add;
+	Uint32 keep;
+	Uint32 fill;
+	Uint32 alphaMask;
+} ColourKernel;
+
+typedef int (*ColouriseRow)(const Uint32 *source, Uint32 *target, int width, const ColourKernel *kernel);
+
+static Uint32 clampChannel(int value) {
+	return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+static bool isByteMask(Uint32 mask) {
+	return mask == 0xFF || mask == 0xFF00 || mask == 0xFF0000 || mask == 0xFF000000;
+}
+
+static bool makeColourKernel(const SDL_PixelFormat *format, Colour colour, ColourisationMethod method, ColourKernel *kernel) {
+	if(format->BytesPerPixel != 4 || !isByteMask(format->Rmask) || !isByteMask(format->Gmask) ||
+			!isByteMask(format->Bmask) || !isByteMask(format->Amask)) return false;
+
+	ColourKernel none = { 0, 0, 0, format->Amask };
+	*kernel = none;
+
+	//Set to what's supplied without any modulation.
+	if(method == COLOURISE_ABSOLUTE) {
+		kernel->fill = SDL_MapRGBA(format, clampChannel(colour.red), clampChannel(colour.green),
+				clampChannel(colour.blue), clampChannel(colour.alpha));
+		return true;
+	}
+
+	//Increase each channel by that of the input colour, and cancel out any channel that is not in
+	// the input - ensuring a complete colourisation every time.
+	int values[] = { colour.red, colour.green, colour.blue };
+	Uint32 masks[] = { format->Rmask, format->Gmask, format->Bmask };
+	Uint8 shifts[] = { format->Rshift, format->Gshift, format->Bshift };
+	for(int c=0; c < 3; c++) {
+		if(values[c] <= 0) continue;
+		kernel->keep |= masks[c];
+		kernel->add |= clampChannel(values[c]) << shifts[c];
+	}
+	kernel->fill = clampChannel(colour.alpha) << format->Ashift;
+
+	return true;
+}
+
+static Uint32 colourisePixel(Uint32 pixel, const ColourKernel *kernel) {
+	//Don't colourise fully-transparent pixels.
+	if((pixel & kernel->alphaMask) == 0) return pixel;
+
+	//Saturating per-byte add, four channels at a time: add the low 7 bits of each byte, then work
+	// out each byte's top bit and carry, and max out any byte that carried.
+	Uint32 low = (pixel & 0x7F7F7F7F) + (kernel->add & 0x7F7F7F7F);
+	Uint32 carries = ((pixel & kernel->add) | ((pixel | kernel->add) & low)) & 0x80808080;
+	Uint32 sum = (low ^ ((pixel ^ kernel->add) & 0x80808080)) | ((carries >> 7) * 0xFF);
+
+	return (sum & kernel->keep) | kernel->fill;
+}
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define PIXELS_X86
+#include <immintrin.h>
+
+//Row kernels return how many pixels they did, leaving the rest of the row to colourisePixel.
+__attribute__((target("sse2")))
+static int colouriseRowSSE2(const Uint32 *source, Uint32 *target, int width, const ColourKernel *kernel) {
+	const __m128i add = _mm_set1_epi32((int)kernel->add);
+	const __m128i keep = _mm_set1_epi32((int)kernel->keep);
+	const __m128i fill = _mm_set1_epi32((int)kernel->fill);
+	const __m128i alphaMask = _mm_set1_epi32((int)kernel->alphaMask);
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for(; x + 4 <= width; x += 4) {
+		__m128i pixels = _mm_loadu_si128((const __m128i *)(source + x));
+		__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero);
+		__m128i coloured = _mm_or_si128(_mm_and_si128(_mm_adds_epu8(pixels, add), keep), fill);
+		_mm_storeu_si128((__m128i *)(target + x),
+				_mm_or_si128(_mm_and_si128(transparent, pixels), _mm_andnot_si128(transparent, coloured)));
+	}
+
+	return x;
+}
+
+__attribute__((target("avx2")))
+static int colouriseRowAVX2(const Uint32 *source, Uint32 *target, int width, const ColourKernel *kernel) {
+	const __m256i add = _mm256_set1_epi32((int)kernel->add);
+	const __m256i keep = _mm256_set1_epi32((int)kernel->keep);
+	const __m256i fill = _mm256_set1_epi32((int)kernel->fill);
+	const __m256i alphaMask = _mm256_set1_epi32((int)kernel->alphaMask);
+	const __m256i zero = _mm256_setzero_si256();
+
+	int x = 0;
+	for(; x + 8 <= width; x += 8) {
+		__m256i pixels = _mm256_loadu_si256((const __m256i *)(source + x));
+		__m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, alphaMask), zero);
+		__m256i coloured = _mm256_or_si256(_mm256_and_si256(_mm256_adds_epu8(pixels, add), keep), fill);
+		_mm256_storeu_si256((__m256i *)(target + x), _mm256_blendv_epi8(coloured, pixels, transparent));
+	}
+
+	return x;
+}
+#endif
+
+//NULL when there's no vector kernel to use, and colourisePixel does every pixel.
+static ColouriseRow pickRowKernel() {
+#ifdef PIXELS_X86
+	if(SDL_HasAVX2()) return colouriseRowAVX2;
+	if(SDL_HasSSE2()) return colouriseRowSSE2;
+#endif
+	return NULL;
+}
+
+Uint32 readPixel(const Uint8 *pixel, int bytes) {
+	switch(bytes) {
+		case 1:
+			return *pixel;
+		case 2:
+			return *(const Uint16 *)pixel;
+		case 3:
+			return SDL_BYTEORDER == SDL_BIG_ENDIAN ?
+				pixel[0] << 16 | pixel[1] << 8 | pixel[2] :
+				pixel[0] | pixel[1] << 8 | pixel[2] << 16;
+		default:
+			return *(const Uint32 *)pixel;
+	}
+}
+
+static void writePixel(Uint8 *pixel, int bytes, Uint32 value) {
+	switch(bytes) {
+		case 1:
+			*pixel = value;
+			break;
+		case 2:
+			*(Uint16 *)pixel = value;
+			break;
+		case 3:
+			if(SDL_BYTEORDER == SDL_BIG_ENDIAN) {
+				pixel[0] = value >> 16; pixel[1] = value >> 8; pixel[2] = value;
+			}else{
+				pixel[0] = value; pixel[1] = value >> 8; pixel[2] = value >> 16;
+			}
+			break;
+		default:
+			*(Uint32 *)pixel = value;
+			break;
+	}
+}
+
+//Any other format is copied, then colourised a pixel at a time through SDL's format conversion.
+static SDL_Surface *colouriseAnyFormat(SDL_Surface *original, Colour colour, ColourisationMethod method) {
+	SDL_Surface *result = SDL_ConvertSurface(original, original->format, 0);
+	if(result == NULL) return NULL;
+
+	if(SDL_MUSTLOCK(result)) SDL_LockSurface(result);
+	int bytes = result->format->BytesPerPixel;
+	for(int y = 0; y < result->h; y++) {
+		Uint8 *row = (Uint8 *)result->pixels + y * result->pitch;
+
+		for(int x = 0; x < result->w; x++) {
+			//Obtain alpha channel from pixel
+			Uint8 oAlpha, or, og, ob;
+			SDL_GetRGBA(readPixel(row + x * bytes, bytes), result->format, &or, &og, &ob, &oAlpha);
+
+			//Don't colourise fully-transparent pixels.
+			if(oAlpha == 0) continue;
+
+			Colour final;
+			if(method == COLOURISE_ABSOLUTE) {
+				final = colour;
+			}else{
+				final.red = 	colour.red > 0 ? or + colour.red > 255 ? 255 : or + colour.red : 0;
+				final.green = 	colour.green > 0 ? og + colour.green > 255 ? 255 : og + colour.green : 0;
+				final.blue = 	colour.blue > 0 ? ob + colour.blue > 255 ? 255 : ob + colour.blue : 0;
+				final.alpha = 	colour.alpha;
+			}
+
+			writePixel(row + x * bytes, bytes, SDL_MapRGBA(result->format,
+					clampChannel(final.red), clampChannel(final.green), clampChannel(final.blue), clampChannel(final.alpha)));
+		}
+	}
+	if(SDL_MUSTLOCK(result)) SDL_UnlockSurface(result);
+
+	return result;
+}
+
+//Note: We offer an additive blend mode, which is different from the multiplicative approach offered by
+//SDL's colour modulate. Also, we operate on a surface, rather than a texture.
+//The original is left untouched - a colourised copy is returned (NULL on failure), which the caller frees.
+SDL_Surface *colouriseSprite(SDL_Surface *original, Colour colour, ColourisationMethod method) {
+	ColourKernel kernel;
+	if(!makeColourKernel(original->format, colour, method, &kernel))
+		return colouriseAnyFormat(original, colour, method);
+
+	SDL_Surface *result = SDL_CreateRGBSurfaceWithFormat(0, original->w, original->h, 32, original->format->format);
+	if(result == NULL) return NULL;
+
+	//Row by row, so both surfaces are walked in memory order.
+	ColouriseRow colouriseRow = pickRowKernel();
+	if(SDL_MUSTLOCK(original)) SDL_LockSurface(original);
+	for(int y = 0; y < original->h; y++) {
+		const Uint32 *source = (const Uint32 *)((const Uint8 *)original->pixels + y * original->pitch);
+		Uint32 *target = (Uint32 *)((Uint8 *)result->pixels + y * result->pitch);
+
+		int x = colouriseRow != NULL ? colouriseRow(source, target, original->w, &kernel) : 0;
+		for(; x < original->w; x++) {
+			target[x] = colourisePixel(source[x], &kernel);
+		}
+	}
+	if(SDL_MUSTLOCK(original)) SDL_UnlockSurface(original);
+
+	return result;
+}
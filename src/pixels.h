@@ -0,0 +1,17 @@
+#ifndef PIXELS_H
+#define PIXELS_H
+
+//Surface pixel helpers. Kept apart from common.c so tools (e.g. mq-pack) can use them without
+// linking the rest of the game.
+
+#include "mysdl.h"
+#include "common.h"
+
+extern int getPixel(SDL_Surface *surface, int x, int y);
+extern void setPixel(SDL_Surface *surface, int x, int y, Uint32 pixel);
+//Raw value of a pixel (of 1 to 4 bytes), for SDL_GetRGBA to pick apart.
+extern Uint32 readPixel(const Uint8 *pixel, int bytes);
+//Returns a colourised copy, leaving the original untouched.
+extern SDL_Surface *colouriseSprite(SDL_Surface *original, Colour colour, ColourisationMethod method);
+
+#endif
@@ -1,11 +1,13 @@
-#include <time.h>
+#include "gameclock.h"
 #include "player.h"
 #include "weapon.h"
 #include "assets.h"
+#include "animation.h"
 #include "renderer.h"
 #include "input.h"
 #include "hud.h"
 #include "sound.h"
+#include "game.h"
 #include "myc.h"
 
 //NB: There is a conceptual distinction between realtime and animated effects. e.g. movment is realtime, whereas the
@@ -13,284 +15,237 @@
 // Quake. i.e. the update rate is higher than the animation rate.
 //TODO: Stop player being able to accel. past his MAX velocity with both strafe and forward motions.
 
-typedef enum {
-	LEAN_NONE = 0,
-	LEAN_LEFT = 1,
-	LEAN_RIGHT = 2
-} LeanDirection;
-
-typedef enum {
-	Y_NONE = 0,
-	Y_UP = 1,
-	Y_DOWN = 2
-} YDirection;
-
-PlayerState playerState;
-
 const PlayerState PSTATE_CAN_ANIMATE = PSTATE_NOT_PLAYING | PSTATE_NORMAL | PSTATE_WON | PSTATE_DYING | PSTATE_SMILING | PSTATE_SLEEPING;
 const PlayerState PSTATE_CAN_CONTROL = PSTATE_NORMAL;
 
-//TODO: Group these for clarity.
-bool godMode = false;
-bool useMike;		//onscreen, responds to actions etc.
-bool hideMike;		//still there, but don't render this frame.
-Coord playerOrigin;
-double playerStrength = 3;
-double playerHealth;
-char* forcedFrame;
-
-static long deathTime = 0;
 static const double PLAYER_MAX_SPEED = 4.0;
 //static const double MOMENTUM_INC_DIVISOR = 6.5;	//works well with joystick.
 static const double MOMENTUM_INC_DIVISOR = 7.5;
 static const int ANIMATION_FRAMES = 8;
 static const int SHOOTING_FRAMES = 2;
 static const int SMILING_FRAMES = 13;
-static int animationInc;
+static const double PLAYER_STRENGTH = 3;
 static double momentumInc;			//PLAYER_MAX_SPEED / MOMENTUM_INC_DIVISOR = momentumInc
-static LeanDirection leanDirection;
-static YDirection yDirection;
-static Sprite bodySprite;
-static Coord thrustState;			//Stores direction state (-1 = left/down, 1 = up/right, 0 = stationary)
-static Coord momentumState;
 static Coord PLAYER_SIZE = { 6, 7 };
 static Rect movementBounds;
-static bool begunDyingRender = false;
-static bool begunSmiling = false;
 static const double HIT_KNOCKBACK = 0.5;
-bool playerShooting;
-bool begunShooting;
 static double BUBBLE_TIME_SECONDS = 1.5;
-static bool bubbleFinished = false;
-static long bubbleLastTime;
-static char* frameName;
-static long lastHitTime;
-bool pain;
-static bool flickerPain;
 static const int PAIN_RECOVER_TIME = 2000;
-static bool painShocked;
-static PlayerState lastState;
-
-static double dieBounce;
-static bool dieDir;
-static double dieSide;
-static bool begunDyingGame;
 
-static bool canControl() {
-	return (playerState&PSTATE_CAN_CONTROL) > 0;
+static bool canControl(const GameContext *game) {
+	return (game->player.state&PSTATE_CAN_CONTROL) > 0;
 }
-static bool canAnimate() {
-	return ( playerState&PSTATE_CAN_ANIMATE) > 0;
+static bool canAnimate(const GameContext *game) {
+	return ( game->player.state&PSTATE_CAN_ANIMATE) > 0;
 }
-bool isSolid() {
-	return playerState != PSTATE_DYING && playerState != PSTATE_SLEEPING;
+bool isSolid(const GameContext *game) {
+	return game->player.state != PSTATE_DYING && game->player.state != PSTATE_SLEEPING;
 }
-bool isDying() {
-	return playerState == PSTATE_DYING;
+bool isDying(const GameContext *game) {
+	return game->player.state == PSTATE_DYING;
 }
 
-extern void smile() {
-	lastState = playerState;
-	playerState = PSTATE_SMILING;
+extern void smile(GameContext *game) {
+	game->player.lastState = game->player.state;
+	game->player.state = PSTATE_SMILING;
 }
 
-extern bool atFullhealth() {
-	return playerHealth == playerStrength;
+extern bool atFullhealth(const GameContext *game) {
+	return game->player.health == game->player.strength;
 }
 
-extern void restoreHealth() {
-	if(godMode) return;
+extern void restoreHealth(GameContext *game) {
+	if(game->player.godMode) return;
 
-	playerHealth = playerStrength;
+	game->player.health = game->player.strength;
 }
 
-void hitPlayer(double damage) {
+void hitPlayer(GameContext *game, double damage) {
+	PlayerContext *player = &game->player;
+
 	//Don't take damage when in hit recovery mode.
-	if(pain && isSolid() || godMode) return;
+	if(player->pain && isSolid(game) || player->godMode) return;
 
 	//Take damage.
-	playerHealth -= damage;
+	player->health -= damage;
 	play("Hit_Hurt18.wav");
 
 	//Remove any powerups / reset weapon to default.
-	if(weaponInc > 0) {
-		changeWeapon(0);
+	if(game->weapon.weaponInc > 0) {
+		changeWeapon(game, 0);
 		play("loss.wav");
 	}
 
-	lastHitTime = clock();
-	pain = true;
-	painShocked = 0;
+	player->lastHitTime = gameTime(game);
+	player->pain = true;
+	player->painShocked = 0;
 
 	//Apply knockback, but only if we're within bounds.
-	Coord predicted = addCoords(playerOrigin, deriveCoord(playerOrigin, 0, HIT_KNOCKBACK));
+	Coord predicted = addCoords(player->origin, deriveCoord(player->origin, 0, HIT_KNOCKBACK));
 	if(predicted.y <= movementBounds.height) {
-		playerOrigin.y += HIT_KNOCKBACK;
+		player->origin.y += HIT_KNOCKBACK;
 	}
 }
 
-static bool sleeping;
-
 //Perform an animation sceneNumber.
-void playerAnimate() {
-	if(!canAnimate()) return;
+void playerAnimate(GameContext *game) {
+	PlayerContext *player = &game->player;
+	if(!canAnimate(game)) return;
 
 	//TODO: Fix hard-coded smiling state animation loop.
 
 	//Reset animation loop.
-	if(playerState != PSTATE_SMILING && playerState != PSTATE_SLEEPING) {
-		animationInc = animationInc == ANIMATION_FRAMES ? 1 : animationInc + 1;
+	if(player->state != PSTATE_SMILING && player->state != PSTATE_SLEEPING) {
+		player->animationInc = player->animationInc == ANIMATION_FRAMES ? 1 : player->animationInc + 1;
 	}
 
-	char frameFile[255];
-	char* animGroupName;
+	const AnimationClip *clip = NULL;
+	int frame = 0;			//zero follows animationInc.
 	AssetVersion frameVersion = ASSET_DEFAULT;
 
 	//Death.
-	if(playerState == PSTATE_SMILING) {
-		if(!begunSmiling) {
-			animationInc = 1;
-			begunSmiling = true;
-		}else if(animationInc == 5) {
+	if(player->state == PSTATE_SMILING) {
+		if(!player->begunSmiling) {
+			player->animationInc = 1;
+			player->begunSmiling = true;
+		}else if(player->animationInc == 5) {
 			play("ping2.wav");
-		}else if(animationInc == SMILING_FRAMES) {
-			playerState = lastState;
-			animationInc = 1;
-			begunSmiling = false;
+		}else if(player->animationInc == SMILING_FRAMES) {
+			player->state = player->lastState;
+			player->animationInc = 1;
+			player->begunSmiling = false;
 			return;
 		}
-		animGroupName = "mike-shades-%02d.png";
-		animationInc++;
-	}else if(isDying()) {
+		clip = getClip(CLIP_MIKE_SHADES);
+		player->animationInc++;
+	}else if(isDying(game)) {
 		//Start to die - reset animation frames.
-		if(!begunDyingRender) {
+		if(!player->begunDyingRender) {
 			play("mike-die.wav");
 			Mix_PauseMusic();
-			animationInc = 5;
-			begunDyingRender = true;
-			deathTime = clock();
+			player->animationInc = 5;
+			player->begunDyingRender = true;
+			player->deathTime = gameTime(game);
 
 			//Save score.
-			if(score > topScore) topScore = score;
+			if(game->hud.score > game->hud.topScore) game->hud.topScore = game->hud.score;
 		}
 
-		if(playerState != PSTATE_SLEEPING) {
-			if(dieDir) {
-				animGroupName = "mike-lean-right-03.png";
-			}else{
-				animGroupName = "mike-lean-left-03.png";
-			}
+		if(player->state != PSTATE_SLEEPING) {
+			clip = getClip(player->dieDir ? CLIP_MIKE_LEAN_RIGHT : CLIP_MIKE_LEAN_LEFT);
+			frame = 3;
 		}
 
-	}else if(playerState == PSTATE_SLEEPING) {
-		animGroupName = "sleep-%02d.png";
-		animationInc = animationInc == 8 ? 1 : animationInc + 1;
+	}else if(player->state == PSTATE_SLEEPING) {
+		clip = getClip(CLIP_SLEEP);
+		player->animationInc = player->animationInc == 8 ? 1 : player->animationInc + 1;
 
 	//Pain: In shock (change frame)
-	}else if(pain && !painShocked) {
-		animGroupName = "mike-shock3.png";
-		painShocked = true;
+	}else if(player->pain && !player->painShocked) {
+		clip = getClip(CLIP_MIKE_SHOCK);
+		frame = 3;
+		player->painShocked = true;
 	}
 	//Idle frames.
 	else{
 		//Pain: Flicker during recovery time.
-		if(pain) {
-			if(flickerPain) {
-				hideMike = true;
-				flickerPain = false;
+		if(player->pain) {
+			if(player->flickerPain) {
+				player->hideMike = true;
+				player->flickerPain = false;
 			}else{
-				hideMike = false;
-				flickerPain = true;
+				player->hideMike = false;
+				player->flickerPain = true;
 			}
 			//Ensure mike is always restored after being in pain.
-		}else if(hideMike) {
-			hideMike = false;
+		}else if(player->hideMike) {
+			player->hideMike = false;
 		}
 
 		//Shooting.
-		if(playerShooting) {
+		if(player->shooting) {
 			//Start shooting
-			if(!begunShooting) {
-				animationInc = 1;
-				begunShooting = true;
+			if(!player->begunShooting) {
+				player->animationInc = 1;
+				player->begunShooting = true;
 			}
 				//Cycle shooting animation.
-			else if(animationInc > SHOOTING_FRAMES) {
-				animationInc = 1;
+			else if(player->animationInc > SHOOTING_FRAMES) {
+				player->animationInc = 1;
 			}
-			if(leanDirection == LEAN_LEFT) {
-				animGroupName = "mike-shoot-left-%02d.png";
-			}else if(leanDirection == LEAN_RIGHT) {
-				animGroupName = "mike-shoot-right-%02d.png";
+			if(player->leanDirection == LEAN_LEFT) {
+				clip = getClip(CLIP_MIKE_SHOOT_LEFT);
+			}else if(player->leanDirection == LEAN_RIGHT) {
+				clip = getClip(CLIP_MIKE_SHOOT_RIGHT);
 			}else {
-				animGroupName = "mike-shoot-%02d.png";
+				clip = getClip(CLIP_MIKE_SHOOT);
 			}
 		}
 		//Regular idle.
 		else{
-			if(leanDirection == LEAN_LEFT) {
-				animGroupName = "mike-lean-left-%02d.png";
-			}else if(leanDirection == LEAN_RIGHT) {
-				animGroupName = "mike-lean-right-%02d.png";
-			}else if(yDirection == Y_UP) {
-				animGroupName = "mike-%02d.png";
+			if(player->leanDirection == LEAN_LEFT) {
+				clip = getClip(CLIP_MIKE_LEAN_LEFT);
+			}else if(player->leanDirection == LEAN_RIGHT) {
+				clip = getClip(CLIP_MIKE_LEAN_RIGHT);
+			}else if(player->yDirection == Y_UP) {
+				clip = getClip(CLIP_MIKE);
 			}else {
-				animGroupName = "mike-facing-%02d.png";
+				clip = getClip(CLIP_MIKE_FACING);
 			}
 		}
 	}
 	
-	//Select animation frame from above group, and draw.
-	sprintf(frameFile, animGroupName, animationInc);
-	
+	//Select animation frame from above clip.
+	if(frame == 0) frame = player->animationInc;
+
 	//Remember what frame we're on for shadow drawing.
-	frameName = realloc(frameName, strlen(frameFile) + 1);
-	strcpy(frameName, frameFile);
+	player->frameClip = clip;
+	player->frameIndex = frame;
 
 	//Now, assign it.
-	SDL_Texture* texture = getTextureVersion(frameFile, frameVersion);
-
-	bodySprite = makeSprite(texture, zeroCoord(), SDL_FLIP_NONE);
+	player->bodySprite = *clipFrame(clip, frame, frameVersion);
 }
 
-void playerShadowFrame() {
-	if(!useMike || hideMike) return;
+void playerShadowFrame(GameContext *game) {
+	PlayerContext *player = &game->player;
+	if(!player->useMike || player->hideMike) return;
 
-	SDL_Texture* shadowTexture = getTextureVersion(frameName, ASSET_SHADOW);
-	if(shadowTexture != NULL) {
-		Sprite shadow = makeSprite(shadowTexture, zeroCoord(), SDL_FLIP_NONE);
-		Coord shadowCoord = parallax(playerOrigin, PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
+	const Sprite *shadow = clipFrame(player->frameClip, player->frameIndex, ASSET_SHADOW);
+	if(shadow->texture != NULL) {
+		Coord shadowCoord = parallax(game, interpolate(player->lastOrigin, player->origin), PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
 		shadowCoord.y += STATIC_SHADOW_OFFSET;
 
 		drawSpriteAbs(
-			shadow,
+			*shadow,
 			shadowCoord
 		);
 	}
 }
 
 //Render the player at a given frame, independent of animation.
-void playerRenderFrame() {
-	if(!useMike || hideMike) return;
-	if((playerState&PSTATE_DEAD) > 0) return;
+void playerRenderFrame(GameContext *game) {
+	PlayerContext *player = &game->player;
+	if(!player->useMike || player->hideMike) return;
+	if((player->state&PSTATE_DEAD) > 0) return;
 
-	switch(gameState) {
+	Coord drawn = interpolate(player->lastOrigin, player->origin);
+	switch(game->state) {
 		case STATE_TITLE: {
-			playerOrigin.y = 220;
+			player->origin.y = drawn.y = 220;
 
-			Sprite bubbleSprite = makeSprite(getTexture("speech-coin.png"), zeroCoord(), SDL_FLIP_NONE);
-			Coord position = playerOrigin;
+			Sprite bubbleSprite = makeHandleSprite(ASSET_SPEECH_COIN, ASSET_DEFAULT);
+			Coord position = drawn;
 			position.y -= 16;
 			drawSprite(bubbleSprite, position);
 			break;
 		}
 		case STATE_GAME:{
-			if(!bubbleFinished) {
-				if(timer(&bubbleLastTime, toMilliseconds(BUBBLE_TIME_SECONDS))) {
-					bubbleFinished = true;
+			if(!player->bubbleFinished) {
+				if(timer(game, &player->bubbleLastTime, toMilliseconds(BUBBLE_TIME_SECONDS))) {
+					player->bubbleFinished = true;
 				}else{
-					Sprite bubbleSprite = makeSprite(getTexture("speech-entry.png"), zeroCoord(), SDL_FLIP_NONE);
-					Coord position = playerOrigin;
+					Sprite bubbleSprite = makeHandleSprite(ASSET_SPEECH_ENTRY, ASSET_DEFAULT);
+					Coord position = drawn;
 					position.y -= 16;
 					position.x += 15;
 					drawSprite(bubbleSprite, position);
@@ -300,163 +255,175 @@ void playerRenderFrame() {
 		}
 	}
 
-	Sprite useSprite = bodySprite;
+	Sprite useSprite = player->bodySprite;
 	
 	// Forced frame override.
-	if(forcedFrame != NULL) {
-		useSprite = makeSimpleSprite(forcedFrame);
+	if(player->forcedFrame != ASSET_HANDLE_NONE) {
+		useSprite = makeHandleSprite(player->forcedFrame, ASSET_DEFAULT);
 	}
 	
-	drawSpriteAbs(useSprite, playerOrigin);
+	drawSpriteAbs(useSprite, drawn);
 }
 
-static void applyMomentum() {
+static void applyMomentum(GameContext *game) {
+	PlayerContext *player = &game->player;
+	Coord *thrustState = &player->thrustState;
+	Coord *momentumState = &player->momentumState;
+
 	//TODO: Clean up duplication.
 
 	//Increase momentum if we're thrusting towards that direction, but limit to max speed.
-	if(thrustState.x < 0 && momentumState.x > -PLAYER_MAX_SPEED)		momentumState.x -= momentumInc;
-	else if(thrustState.x > 0 && momentumState.x < PLAYER_MAX_SPEED) 	momentumState.x += momentumInc;
-	if(thrustState.y < 0 && momentumState.y > -PLAYER_MAX_SPEED) 		momentumState.y -= momentumInc;
-	else if(thrustState.y > 0 && momentumState.y < PLAYER_MAX_SPEED) 	momentumState.y += momentumInc;
+	if(thrustState->x < 0 && momentumState->x > -PLAYER_MAX_SPEED)		momentumState->x -= momentumInc;
+	else if(thrustState->x > 0 && momentumState->x < PLAYER_MAX_SPEED) 	momentumState->x += momentumInc;
+	if(thrustState->y < 0 && momentumState->y > -PLAYER_MAX_SPEED) 		momentumState->y -= momentumInc;
+	else if(thrustState->y > 0 && momentumState->y < PLAYER_MAX_SPEED) 	momentumState->y += momentumInc;
 
 	//If we're not thrusting in a direction, but still have some momentum, decelerate back to zero.
-	if(thrustState.x == 0 && momentumState.x != 0){
-		double currentDiff = fabs(momentumState.x);
+	if(thrustState->x == 0 && momentumState->x != 0){
+		double currentDiff = fabs(momentumState->x);
 		double offsetInc = currentDiff < momentumInc ? currentDiff : momentumInc;		//ensure we always return to zero, and don't say in limbo.
-		momentumState.x += momentumState.x < 0 ? offsetInc : -offsetInc;				//decel by moving one increment towards zero.
+		momentumState->x += momentumState->x < 0 ? offsetInc : -offsetInc;				//decel by moving one increment towards zero.
 	}
-	if(thrustState.y == 0 && momentumState.y != 0) {
-		double currentDiff = fabs(momentumState.y);
+	if(thrustState->y == 0 && momentumState->y != 0) {
+		double currentDiff = fabs(momentumState->y);
 		double offsetInc = currentDiff < momentumInc ? currentDiff : momentumInc;
-		momentumState.y += momentumState.y < 0 ? offsetInc : -offsetInc;
+		momentumState->y += momentumState->y < 0 ? offsetInc : -offsetInc;
 	}
 
 	//Predict where we're going to end up.
-	Coord predicted = addCoords(playerOrigin, momentumState);
+	Coord predicted = addCoords(player->origin, *momentumState);
 
 	//Stop momentum if we'd reach, or overshoot, the screen bounds, but allow this kind
 	// of behaviour during scripted sequences.
-	if(!isScripted()) {
+	if(!isScripted(game)) {
 		if(predicted.x <= movementBounds.x || predicted.x >= movementBounds.width)
-			momentumState.x = 0;
+			momentumState->x = 0;
 		if(predicted.y <= movementBounds.y || predicted.y >= movementBounds.height)
-			momentumState.y = 0;
+			momentumState->y = 0;
 	}
 }
 
-static void recogniseThrust() {
+static void recogniseThrust(GameContext *game) {
+	PlayerContext *player = &game->player;
+
 	//Toggle thrust in a particular direction, based on key press.
-	if(checkCommand(CMD_PLAYER_UP)){
-		thrustState.y = -1;
-		yDirection = Y_UP;
-	}else if(checkCommand(CMD_PLAYER_DOWN)){
-		thrustState.y = 1;
-	}else if(yDirection != Y_NONE) {
-		yDirection = Y_NONE;
+	if(checkCommand(game, CMD_PLAYER_UP)){
+		player->thrustState.y = -1;
+		player->yDirection = Y_UP;
+	}else if(checkCommand(game, CMD_PLAYER_DOWN)){
+		player->thrustState.y = 1;
+	}else if(player->yDirection != Y_NONE) {
+		player->yDirection = Y_NONE;
 	}
 
-	if(checkCommand(CMD_PLAYER_LEFT)){
-		thrustState.x = -1;
-		leanDirection = LEAN_LEFT;
-	}else if(checkCommand(CMD_PLAYER_RIGHT)){
-		thrustState.x = 1;
-		leanDirection = LEAN_RIGHT;
+	if(checkCommand(game, CMD_PLAYER_LEFT)){
+		player->thrustState.x = -1;
+		player->leanDirection = LEAN_LEFT;
+	}else if(checkCommand(game, CMD_PLAYER_RIGHT)){
+		player->thrustState.x = 1;
+		player->leanDirection = LEAN_RIGHT;
 	}
 	//Reset lean direction when unpressed.
-	else if(leanDirection != LEAN_NONE){
-		leanDirection = LEAN_NONE;
+	else if(player->leanDirection != LEAN_NONE){
+		player->leanDirection = LEAN_NONE;
 	}
 }
 
-void playerGameFrame() {
-	if(isDying()) {
+void playerSavePosition(GameContext *game) {
+	game->player.lastOrigin = game->player.origin;
+}
+
+void playerGameFrame(GameContext *game) {
+	PlayerContext *player = &game->player;
+
+	if(isDying(game)) {
 		//Set initial trajectory (we just do an incremental approach, no
 		// parabolic math here).
-		if(!begunDyingGame) {
+		if(!player->begunDyingGame) {
 			//Bounce towards opposite side of screen so we don't miss him.
-			dieDir = playerOrigin.x < (screenBounds.x / 2);
-			dieBounce = (double)randomMq(30, 55) / 10;
-			dieSide = (double)randomMq(65, 85) / 100;
-			begunDyingGame = true;
+			player->dieDir = player->origin.x < (screenBounds.x / 2);
+			player->dieBounce = (double)randomMq(&game->random[RANDOM_PLAYER], 30, 55) / 10;
+			player->dieSide = (double)randomMq(&game->random[RANDOM_PLAYER], 65, 85) / 100;
+			player->begunDyingGame = true;
 		}
 
-		if(dieDir) {
-			playerOrigin.x += dieSide;
+		if(player->dieDir) {
+			player->origin.x += player->dieSide;
 		}else{
-			playerOrigin.x -= dieSide;
+			player->origin.x -= player->dieSide;
 		}
 
 		//Decrease bounce thrust over time.
-		playerOrigin.y -= (dieBounce -= 0.15);
+		player->origin.y -= (player->dieBounce -= 0.15);
 
 		//Flag once bounced completely offscreen (with a little padding)
-		if(playerOrigin.y > screenBounds.y - 30){
-			playerState = PSTATE_SLEEPING;
-//			playerState = PSTATE_DEAD;
-			deathTime = 0;
-			triggerState(STATE_GAME_OVER);
+		if(player->origin.y > screenBounds.y - 30){
+			player->state = PSTATE_SLEEPING;
+//			player->state = PSTATE_DEAD;
+			player->deathTime = 0;
+			triggerState(game, STATE_GAME_OVER);
 
 			// Change sprite immediately.
-			SDL_Texture* texture = getTextureVersion("sleep-05.png", ASSET_DEFAULT);
-			animationInc = 5;
-			bodySprite = makeSprite(texture, zeroCoord(), SDL_FLIP_NONE);
+			player->animationInc = 5;
+			player->bodySprite = makeHandleSprite(ASSET_SLEEP_05, ASSET_DEFAULT);
 		}
 	}
 
-	if(!useMike || !canControl()) return;
+	if(!player->useMike || !canControl(game)) return;
 
 	//Flag for death sequence.
-	if(playerHealth <= 0) {
-		playerState = PSTATE_DYING;
-		pain = false;
+	if(player->health <= 0) {
+		player->state = PSTATE_DYING;
+		player->pain = false;
 		return;
 	}
 
 	//Recover from pain invincibility.
-	if(pain && due(lastHitTime, PAIN_RECOVER_TIME)) {
-		pain = false;
+	if(player->pain && due(game, player->lastHitTime, PAIN_RECOVER_TIME)) {
+		player->pain = false;
 	}
 
 	//Movement.
-	recogniseThrust();
-	applyMomentum();
-	thrustState = zeroCoord();
+	recogniseThrust(game);
+	applyMomentum(game);
+	player->thrustState = zeroCoord();
 
 	//Firing / auto-fire
-	if(checkCommand(CMD_PLAYER_FIRE)) {
-		pew();
-		playerShooting = true;
+	if(checkCommand(game, CMD_PLAYER_FIRE)) {
+		pew(game);
+		player->shooting = true;
 	} else {
-		playerShooting = false;
-		begunShooting = false;
+		player->shooting = false;
+		player->begunShooting = false;
 	}
 
 	//Draw player in correct position
-	playerOrigin.x += momentumState.x;
-	playerOrigin.y += momentumState.y;
+	player->origin.x += player->momentumState.x;
+	player->origin.y += player->momentumState.y;
 }
 
-void resetPlayer() {
-	begunDyingRender = false;
-	begunDyingGame = false;
-	playerState = PSTATE_NORMAL;
-	bubbleLastTime = clock();
-	playerOrigin.y = 220;
-	playerHealth = playerStrength;
-	momentumState = zeroCoord();
-	pain = false;
-	bubbleFinished = false;
-	animationInc = 0;
-	forcedFrame = malloc(sizeof(char) * 50);
-	forcedFrame = NULL;
+void resetPlayer(GameContext *game) {
+	PlayerContext *player = &game->player;
+
+	player->begunDyingRender = false;
+	player->begunDyingGame = false;
+	player->state = PSTATE_NORMAL;
+	player->bubbleLastTime = gameTime(game);
+	player->origin.y = 220;
+	player->health = player->strength;
+	player->momentumState = zeroCoord();
+	player->pain = false;
+	player->bubbleFinished = false;
+	player->animationInc = 0;
+	player->forcedFrame = ASSET_HANDLE_NONE;
 	
-	playerOrigin = makeCoord(
+	player->origin = makeCoord(
 		(screenBounds.x / 2),
 		(int)(screenBounds.y * 0.9)
 	);
 }
 
-void playerInit() {
+void playerInit(GameContext *game) {
 	momentumInc = PLAYER_MAX_SPEED / MOMENTUM_INC_DIVISOR;
 
 	//Calculate (in advance) the map boundary limitations.
@@ -467,6 +434,7 @@ void playerInit() {
 		screenBounds.y - (PLAYER_SIZE.y / 2)
 	);
 
-	resetPlayer();
-	playerAnimate();
-}
\ No newline at end of file
+	game->player.strength = PLAYER_STRENGTH;
+	resetPlayer(game);
+	playerAnimate(game);
+}
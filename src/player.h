@@ -2,6 +2,9 @@
 #define PLAYER_H
 
 #include "common.h"
+#include "assets.h"
+#include "animation.h"
+#include "renderer.h"
 
 typedef enum {
 	PSTATE_NOT_PLAYING = 1,
@@ -13,25 +16,67 @@ typedef enum {
 	PSTATE_SLEEPING = 64
 } PlayerState;
 
-extern bool isSolid();
-extern bool pain;
-extern bool isDying();
-extern bool godMode;
-extern void smile();
-extern bool atFullhealth();
-extern void restoreHealth();
-extern PlayerState playerState;
-extern bool useMike;
-extern void hitPlayer(double damage);
-extern double playerStrength;
-extern double playerHealth;
-extern Coord playerOrigin;
-extern void playerInit();
-extern void playerAnimate();
-extern void playerShadowFrame();
-extern void playerRenderFrame();
-extern void playerGameFrame();
-extern void resetPlayer();
-extern char* forcedFrame;
+typedef enum {
+	LEAN_NONE = 0,
+	LEAN_LEFT = 1,
+	LEAN_RIGHT = 2
+} LeanDirection;
+
+typedef enum {
+	Y_NONE = 0,
+	Y_UP = 1,
+	Y_DOWN = 2
+} YDirection;
+
+//TODO: Group these for clarity.
+typedef struct {
+	PlayerState state;
+	PlayerState lastState;
+	bool godMode;
+	bool useMike;		//onscreen, responds to actions etc.
+	bool hideMike;		//still there, but don't render this frame.
+	Coord origin;
+	Coord lastOrigin;		//as of the previous game step, to draw between the two.
+	double strength;
+	double health;
+	AssetHandle forcedFrame;
+	long deathTime;
+	int animationInc;
+	LeanDirection leanDirection;
+	YDirection yDirection;
+	Sprite bodySprite;
+	Coord thrustState;			//Stores direction state (-1 = left/down, 1 = up/right, 0 = stationary)
+	Coord momentumState;
+	bool begunDyingRender;
+	bool begunSmiling;
+	bool shooting;
+	bool begunShooting;
+	bool bubbleFinished;
+	long bubbleLastTime;
+	const AnimationClip *frameClip;		//what we're showing, for shadow drawing.
+	int frameIndex;
+	long lastHitTime;
+	bool pain;
+	bool flickerPain;
+	bool painShocked;
+	double dieBounce;
+	bool dieDir;
+	double dieSide;
+	bool begunDyingGame;
+} PlayerContext;
+
+extern bool isSolid(const GameContext *game);
+extern bool isDying(const GameContext *game);
+extern void smile(GameContext *game);
+extern bool atFullhealth(const GameContext *game);
+extern void restoreHealth(GameContext *game);
+extern void hitPlayer(GameContext *game, double damage);
+extern void playerInit(GameContext *game);
+extern void playerAnimate(GameContext *game);
+extern void playerShadowFrame(GameContext *game);
+extern void playerRenderFrame(GameContext *game);
+extern void playerGameFrame(GameContext *game);
+extern void playerSavePosition(GameContext *game);
+extern void resetPlayer(GameContext *game);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,66 @@
+#include <assert.h>
+#include "mysdl.h"
+#include "pool.h"
+#include "trace.h"
+#include "myc.h"
+
+void initPool(Pool *pool, const char *name, int *storage, int capacity) {
+	pool->name = name;
+	pool->capacity = capacity;
+	pool->active = storage;
+	pool->free = storage + capacity;
+	pool->position = storage + capacity * 2;
+	pool->exhausted = 0;
+	clearPool(pool);
+}
+
+//Frees every slot. Slots are then handed out lowest first, as a plain array would fill.
+void clearPool(Pool *pool) {
+	pool->count = 0;
+
+	for(int i=0; i < pool->capacity; i++) {
+		pool->free[i] = pool->capacity - 1 - i;
+		pool->position[i] = -1;
+	}
+}
+
+//Returns a free slot, or -1 if they're all in use (which is counted, and logged the first time).
+int acquireSlot(Pool *pool) {
+	if(pool->count == pool->capacity) {
+		if(pool->exhausted++ == 0) {
+			SDL_Log("The %s pool is full (%d); anything more is dropped.", pool->name, pool->capacity);
+		}
+		traceInstant("pool exhausted", pool->name, pool->exhausted);
+		return -1;
+	}
+
+	int slot = pool->free[pool->capacity - pool->count - 1];
+	pool->position[slot] = pool->count;
+	pool->active[pool->count++] = slot;
+
+	return slot;
+}
+
+//Swaps the last live slot into the released one's place, keeping the live slots packed.
+void releaseSlot(Pool *pool, int slot) {
+	assert(slot >= 0 && slot < pool->capacity);
+	if(pool->position[slot] < 0) return;
+
+	int at = pool->position[slot];
+	int last = pool->active[--pool->count];
+	pool->active[at] = last;
+	pool->position[last] = at;
+
+	pool->position[slot] = -1;
+	pool->free[pool->capacity - pool->count - 1] = slot;
+}
+
+bool isSlotActive(const Pool *pool, int slot) {
+	return slot >= 0 && slot < pool->capacity && pool->position[slot] >= 0;
+}
+
+void reportPool(const Pool *pool) {
+	if(pool->exhausted > 0) {
+		SDL_Log("The %s pool (%d) was full for %d spawns.", pool->name, pool->capacity, pool->exhausted);
+	}
+}
@@ -0,0 +1,39 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+
+//Tracks which slots of a fixed entity array are in use: a free-list to hand out slots in O(1), and
+// the live slots packed together so loops only visit those. The entities themselves stay in their
+// own arrays; the pool only deals in slot indices.
+typedef struct {
+	const char *name;
+	int capacity;
+	int count;			//live slots, packed at the front of active.
+	int *active;		//live slot indices.
+	int *free;			//stack of free slot indices (capacity - count of them).
+	int *position;		//each slot's index in active, or -1 while free.
+	int exhausted;		//acquires refused because every slot was in use.
+} Pool;
+
+//Ints of storage a pool needs for its index lists, e.g. int slots[POOL_STORAGE(MAX_ENEMIES)];
+#define POOL_STORAGE(capacity) ((capacity) * 3)
+
+//Visits every live slot, newest first. Releasing the slot being visited (or acquiring new ones,
+// which aren't visited) is fine along the way; releasing any other slot isn't.
+#define FOR_EACH_SLOT(pool, slot) \
+	for(int slotAt_ = (pool)->count - 1, slot = 0; slotAt_ >= 0 && ((slot = (pool)->active[slotAt_]), true); slotAt_--)
+
+//Visits every live slot in slot order, which (unlike the packed order above) doesn't shuffle when
+// other slots are released - so render passes use it, keeping overlapping sprites stacked as they were.
+#define FOR_EACH_SLOT_IN_ORDER(pool, slot) \
+	for(int slot = 0; slot < (pool)->capacity; slot++) if((pool)->position[slot] < 0) {} else
+
+extern void initPool(Pool *pool, const char *name, int *storage, int capacity);
+extern void clearPool(Pool *pool);
+extern int acquireSlot(Pool *pool);
+extern void releaseSlot(Pool *pool, int slot);
+extern bool isSlotActive(const Pool *pool, int slot);
+extern void reportPool(const Pool *pool);
+
+#endif
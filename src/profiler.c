@@ -0,0 +1,116 @@
+#include <assert.h>
+#include "profiler.h"
+#include "trace.h"
+#include "myc.h"
+
+//Lightweight section timers for the main loop. Each section's time is totalled over a rendered
+// frame (including any game steps run since the last one), and the totals are kept in a ring
+// buffer for the overlay drawn by showDebugStats. Sections also show up as spans in --trace output.
+//Only the thread that called initProfiler is timed (headless --threads runs games on others), but
+// every thread's sections still go to the trace.
+
+static const ProfileSectionInfo sections[PROFILE_SECTION_COUNT] = {
+	[PROFILE_INPUT] = { "input", { 120, 120, 120, 255 } },
+	[PROFILE_LEVEL] = { "level", { 255, 230, 80, 255 } },
+	[PROFILE_BACKGROUND] = { "background", { 90, 110, 200, 255 } },
+	[PROFILE_SCRIPTS] = { "scripts", { 190, 120, 255, 255 } },
+	[PROFILE_PLAYER] = { "player", { 80, 220, 120, 255 } },
+	[PROFILE_ENEMIES] = { "enemies", { 255, 70, 70, 255 } },
+	[PROFILE_ITEMS] = { "items", { 255, 170, 40, 255 } },
+	[PROFILE_SHOTS] = { "shots", { 80, 230, 255, 255 } },
+	[PROFILE_HUD] = { "hud", { 230, 230, 230, 255 } },
+	[PROFILE_ANIMATION] = { "animation", { 255, 120, 200, 255 } },
+	[PROFILE_RENDER_BACKGROUND] = { "render background", { 50, 60, 140, 255 } },
+	[PROFILE_RENDER_SHADOWS] = { "render shadows", { 70, 70, 70, 255 } },
+	[PROFILE_RENDER_ENEMIES] = { "render enemies", { 170, 40, 40, 255 } },
+	[PROFILE_RENDER_ITEMS] = { "render items", { 170, 110, 20, 255 } },
+	[PROFILE_RENDER_SHOTS] = { "render shots", { 40, 150, 170, 255 } },
+	[PROFILE_RENDER_SCRIPTS] = { "render scripts", { 120, 70, 170, 255 } },
+	[PROFILE_RENDER_PLAYER] = { "render player", { 40, 150, 80, 255 } },
+	[PROFILE_RENDER_HUD] = { "render hud", { 150, 150, 150, 255 } },
+	[PROFILE_CANVAS] = { "canvas", { 255, 255, 255, 255 } }
+};
+
+static Uint64 frequency;
+static Uint64 started[PROFILE_SECTION_COUNT];
+static Uint64 frameTotals[PROFILE_SECTION_COUNT];		//this frame so far, in counter units.
+static float history[PROFILE_HISTORY][PROFILE_SECTION_COUNT];	//milliseconds.
+static int historyInc;		//next slot to write.
+static int historyCount;
+static bool overlayShowing;
+static SDL_threadID profiledThread;
+
+void initProfiler() {
+	profiledThread = SDL_ThreadID();
+}
+
+void profileBegin(ProfileSection section) {
+	assert(section >= 0 && section < PROFILE_SECTION_COUNT);
+	traceBegin(sections[section].name);
+	if(SDL_ThreadID() == profiledThread) started[section] = SDL_GetPerformanceCounter();
+}
+
+void profileEnd(ProfileSection section) {
+	assert(section >= 0 && section < PROFILE_SECTION_COUNT);
+	if(SDL_ThreadID() == profiledThread) frameTotals[section] += SDL_GetPerformanceCounter() - started[section];
+	traceEnd(sections[section].name);
+}
+
+//Call once a frame has been presented, to file its totals.
+void profileEndFrame() {
+	if(frequency == 0) frequency = SDL_GetPerformanceFrequency();
+
+	for(int i=0; i < PROFILE_SECTION_COUNT; i++) {
+		history[historyInc][i] = (float)(frameTotals[i] * 1000.0 / frequency);
+		frameTotals[i] = 0;
+	}
+
+	historyInc = (historyInc + 1) % PROFILE_HISTORY;
+	if(historyCount < PROFILE_HISTORY) historyCount++;
+}
+
+const ProfileSectionInfo *getProfileSection(ProfileSection section) {
+	assert(section >= 0 && section < PROFILE_SECTION_COUNT);
+	return &sections[section];
+}
+
+static int compareFloats(const void *a, const void *b) {
+	float x = *(const float *)a, y = *(const float *)b;
+	return (x > y) - (x < y);
+}
+
+ProfileStats getProfileStats(ProfileSection section) {
+	assert(section >= 0 && section < PROFILE_SECTION_COUNT);
+
+	ProfileStats stats = { 0, 0, 0 };
+	if(historyCount == 0) return stats;
+
+	float sorted[PROFILE_HISTORY];
+	double total = 0;
+	for(int i=0; i < historyCount; i++) {
+		sorted[i] = history[i][section];
+		total += sorted[i];
+	}
+	qsort(sorted, historyCount, sizeof(float), compareFloats);
+
+	stats.minMs = sorted[0];
+	stats.avgMs = total / historyCount;
+	stats.p99Ms = sorted[(historyCount - 1) * 99 / 100];
+	return stats;
+}
+
+//A section's time in a recent frame (0 is the last one filed), or 0 if it's older than the history.
+double getProfileFrame(ProfileSection section, int framesAgo) {
+	assert(section >= 0 && section < PROFILE_SECTION_COUNT);
+	if(framesAgo < 0 || framesAgo >= historyCount) return 0;
+
+	return history[(historyInc - 1 - framesAgo + PROFILE_HISTORY) % PROFILE_HISTORY][section];
+}
+
+void toggleProfilerOverlay() {
+	overlayShowing = !overlayShowing;
+}
+
+bool isProfilerOverlayShowing() {
+	return overlayShowing;
+}
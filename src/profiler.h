@@ -0,0 +1,59 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include "mysdl.h"
+
+//Main loop sections we time, in the order they run (which is also the order they stack in the overlay).
+typedef enum {
+	PROFILE_INPUT,
+	PROFILE_LEVEL,
+	PROFILE_BACKGROUND,
+	PROFILE_SCRIPTS,
+	PROFILE_PLAYER,
+	PROFILE_ENEMIES,
+	PROFILE_ITEMS,
+	PROFILE_SHOTS,
+	PROFILE_HUD,
+	PROFILE_ANIMATION,
+	PROFILE_RENDER_BACKGROUND,
+	PROFILE_RENDER_SHADOWS,
+	PROFILE_RENDER_ENEMIES,
+	PROFILE_RENDER_ITEMS,
+	PROFILE_RENDER_SHOTS,
+	PROFILE_RENDER_SCRIPTS,
+	PROFILE_RENDER_PLAYER,
+	PROFILE_RENDER_HUD,
+	PROFILE_CANVAS,
+	PROFILE_SECTION_COUNT
+} ProfileSection;
+
+//Frames of history kept for the stats and graph.
+#define PROFILE_HISTORY 128
+
+typedef struct {
+	const char *name;
+	SDL_Color colour;		//in the overlay graph and key.
+} ProfileSectionInfo;
+
+//Per-frame cost of a section over the history, in milliseconds.
+typedef struct {
+	double minMs;
+	double avgMs;
+	double p99Ms;
+} ProfileStats;
+
+//Times a call against a section, e.g. PROFILE(PROFILE_ENEMIES, enemyGameFrame());
+#define PROFILE(section, call) do { profileBegin(section); call; profileEnd(section); } while(0)
+
+extern void initProfiler();
+extern void profileBegin(ProfileSection section);
+extern void profileEnd(ProfileSection section);
+extern void profileEndFrame();
+extern const ProfileSectionInfo *getProfileSection(ProfileSection section);
+extern ProfileStats getProfileStats(ProfileSection section);
+extern double getProfileFrame(ProfileSection section, int framesAgo);
+extern void toggleProfilerOverlay();
+extern bool isProfilerOverlayShowing();
+
+#endif
@@ -0,0 +1,87 @@
+#include "random.h"
+#include "myc.h"
+
+static Uint64 rotateLeft(Uint64 x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+//splitmix64, to spread a (possibly small) seed across all of xoshiro's state.
+static Uint64 splitMix(Uint64 *x) {
+	Uint64 z = (*x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+void seedRandom(Random *random, Uint64 seed) {
+	for(int i=0; i < 4; i++) {
+		random->s[i] = splitMix(&seed);
+	}
+}
+
+//Streams are seeded from the game seed and their index, so adding a stream leaves the others alone.
+void seedRandomStreams(Random streams[RANDOM_STREAM_COUNT], Uint64 seed) {
+	Uint64 mixed = seed;
+	Uint64 base = splitMix(&mixed);
+
+	for(int i=0; i < RANDOM_STREAM_COUNT; i++) {
+		seedRandom(&streams[i], base ^ (0xD1B54A32D192ED03ull * (Uint64)(i + 1)));
+	}
+}
+
+Uint64 nextRandom(Random *random) {
+	Uint64 *s = random->s;
+	Uint64 result = rotateLeft(s[1] * 5, 7) * 9;
+	Uint64 t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotateLeft(s[3], 45);
+
+	return result;
+}
+
+//Uniform in [0, bound), without modulo bias (Lemire's multiply-and-reject).
+Uint32 randomBelow(Random *random, Uint32 bound) {
+	Uint64 m = (nextRandom(random) >> 32) * (Uint64)bound;
+	Uint32 low = (Uint32)m;
+
+	if(low < bound) {
+		Uint32 threshold = -bound % bound;
+		while(low < threshold) {
+			m = (nextRandom(random) >> 32) * (Uint64)bound;
+			low = (Uint32)m;
+		}
+	}
+
+	return (Uint32)(m >> 32);
+}
+
+//Uniform in [min, max], both inclusive.
+int randomMq(Random *random, int min, int max) {
+	return min + (int)randomBelow(random, (Uint32)(max - min) + 1);
+}
+
+bool chance(Random *random, int probability) {
+	//Shortcuts for deterministic scenarios (impossible and always)
+	if(probability == 0) {
+		return false;
+	}else if (probability == 100) {
+		return true;
+	}
+
+	int roll = randomMq(random, 0, 100);			//dice roll up to 100 (to match with a percentage-based probability amount)
+	return probability >= roll;			//e.g. 99% is higher than a roll of 5, 50, and 75.
+}
+
+//Fills values with numbers in [min, max], e.g. for scattering a whole starfield at once.
+void randomFill(Random *random, int *values, int count, int min, int max) {
+	Uint32 bound = (Uint32)(max - min) + 1;
+
+	for(int i=0; i < count; i++) {
+		values[i] = min + (int)randomBelow(random, bound);
+	}
+}
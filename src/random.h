@@ -0,0 +1,33 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdbool.h>
+#include "mysdl.h"
+
+//xoshiro256** generator (http://prng.di.unimi.it/). State is explicit, so every game carries its
+// own, and nothing else (rendering, other threads) can move it on.
+typedef struct {
+	Uint64 s[4];
+} Random;
+
+//Each part of a game draws from its own stream, so e.g. a change to how the starfield is scattered
+// can't alter which enemies drop what - and a replay recorded before the change still plays out.
+typedef enum {
+	RANDOM_LEVEL,			//scripted sequences (intro and title line-ups).
+	RANDOM_ENEMIES,
+	RANDOM_ITEMS,
+	RANDOM_PLAYER,
+	RANDOM_BACKGROUND,
+	RANDOM_AUDIO,			//which sound variation plays.
+	RANDOM_STREAM_COUNT
+} RandomStream;
+
+extern void seedRandom(Random *random, Uint64 seed);
+extern void seedRandomStreams(Random streams[RANDOM_STREAM_COUNT], Uint64 seed);
+extern Uint64 nextRandom(Random *random);
+extern Uint32 randomBelow(Random *random, Uint32 bound);
+extern int randomMq(Random *random, int min, int max);
+extern bool chance(Random *random, int probability);
+extern void randomFill(Random *random, int *values, int count, int min, int max);
+
+#endif
@@ -3,7 +3,7 @@
 #include "assets.h"
 #include "common.h"
 #include "renderer.h"
-#include "player.h"
+#include "game.h"
 #include "myc.h"
 
 // Core rendering
@@ -15,6 +15,7 @@ Coord pixelGrid;								//helps aligning things to the tiled background.
 Coord screenBounds;
 static int renderScale;
 static const double PIXEL_SCALE = 1;			//pixel doubling for assets.
+static const double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180;
 
 // Fader
 const FadeMode FADE_BOTH = FADE_IN | FADE_OUT;
@@ -22,15 +23,58 @@ static SDL_Texture* blackFader;
 static SDL_Texture* whiteFader;
 static const int FADE_DURATION = 1000;
 static int fadeAlphaInc;
-static FadeMode currentFadeMode;
-static int currentFadeAlpha;
-static bool fadeWhite;
+
+//A single white pixel, tinted and stretched to draw solid rectangles.
+static SDL_Texture *solidTexture;
 
 // Screenshots
 static SDL_Texture *shotBuffer;
 static Coord shotDimensions;
 static int screenshotInc = 0;
 
+//Render frames fall between game steps; this is how far along, from 0 (the last step) to 1 (this one).
+static double interpolation = 1;
+//Anything that moves further than this in one step has been placed rather than moved, so don't draw it sweeping across.
+static const double INTERPOLATION_SNAP_DISTANCE = 48;
+
+// Sprite batch
+typedef struct {
+	SDL_Texture *texture;
+	SDL_Rect source;
+	SDL_Rect destination;
+	double angle;
+	SDL_Point rotateOrigin;
+	SDL_RendererFlip flip;
+	DrawState state;
+	RenderLayer layer;
+	int order;				//submission order, to keep sorting stable.
+	int batch;
+	SDL_FPoint corners[4];	//top-left, top-right, bottom-right, bottom-left, after rotation.
+	SDL_Rect bounds;		//screen area the corners cover.
+} QueuedSprite;
+
+//Colour and alpha modulation ride on the vertices, so sprites drawn with different modulation can
+// still share a batch - only the texture and blend mode need to match.
+typedef struct {
+	SDL_Texture *texture;
+	SDL_BlendMode blendMode;
+	SDL_Rect bounds;
+} SpriteBatch;
+
+static QueuedSprite *spriteQueue;
+static int spriteQueueCount;
+static int spriteQueueSize;
+static int *batchOrder;
+static SpriteBatch *batches;
+static int batchCount;
+static int batchSize;
+static SDL_Vertex *batchVertices;
+static int *batchIndices;
+static int batchGeometrySize;
+static RenderLayer currentLayer;
+static RenderStats frameStats;
+static RenderStats lastFrameStats;
+
 const int STATIC_SHADOW_OFFSET = 8;
 
 Coord getTextureSize(SDL_Texture *texture) {
@@ -40,16 +84,34 @@ Coord getTextureSize(SDL_Texture *texture) {
 	return makeCoord(x, y);
 }
 
+//Sprite covering a whole texture (e.g. a canvas we've rendered to), drawn with whatever
+// modulation and blending the texture has now.
 Sprite makeSprite(SDL_Texture *texture, Coord offset, SDL_RendererFlip flip) {
+	Coord size = getTextureSize(texture);
 	Sprite sprite = {
-		texture, offset, getTextureSize(texture), flip
+		texture, offset, size, flip, { 0, 0, (int)size.x, (int)size.y }
 	};
+	SDL_GetTextureColorMod(texture, &sprite.state.modulation.r, &sprite.state.modulation.g, &sprite.state.modulation.b);
+	SDL_GetTextureAlphaMod(texture, &sprite.state.modulation.a);
+	SDL_GetTextureBlendMode(texture, &sprite.state.blendMode);
 	return sprite;
 }
 
 Sprite makeSimpleSprite(char *textureName) {
-	SDL_Texture *texture = getTexture(textureName);
-	return makeSprite(texture, zeroCoord(), SDL_FLIP_NONE);
+	return makeHandleSprite(getAssetHandle(textureName), ASSET_DEFAULT);
+}
+
+//Asset sizes are recorded at load, so unlike makeSprite this needs no texture query.
+Sprite makeHandleSprite(AssetHandle handle, AssetVersion version) {
+	Sprite sprite = {
+		getTextureHandle(handle, version),
+		zeroCoord(),
+		getAssetSize(handle),
+		SDL_FLIP_NONE,
+		getAssetSource(handle, version),
+		getDrawState(handle, version)
+	};
+	return sprite;
 }
 
 bool inScreenBounds(Coord subject) {
@@ -58,6 +120,230 @@ bool inScreenBounds(Coord subject) {
 		subject.y > 0 && subject.y < screenBounds.y;
 }
 
+static bool rectsOverlap(SDL_Rect a, SDL_Rect b) {
+	return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+static SDL_Rect unionRects(SDL_Rect a, SDL_Rect b) {
+	int left = a.x < b.x ? a.x : b.x;
+	int top = a.y < b.y ? a.y : b.y;
+	int right = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+	int bottom = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+
+	SDL_Rect result = { left, top, right - left, bottom - top };
+	return result;
+}
+
+//Work out where the corners of a queued sprite land, rotating clockwise about its rotate origin
+// (as SDL_RenderCopyEx does), and the screen area they cover.
+static void transformQueuedSprite(QueuedSprite *queued) {
+	SDL_Rect d = queued->destination;
+	float pivotX = d.x + queued->rotateOrigin.x;
+	float pivotY = d.y + queued->rotateOrigin.y;
+	float xs[4] = { d.x, d.x + d.w, d.x + d.w, d.x };
+	float ys[4] = { d.y, d.y, d.y + d.h, d.y + d.h };
+
+	float sine = 0, cosine = 1;
+	if(queued->angle != 0) {
+		double radians = queued->angle * DEGREES_TO_RADIANS;
+		sine = (float)sin(radians);
+		cosine = (float)cos(radians);
+	}
+
+	float minX = 0, minY = 0, maxX = 0, maxY = 0;
+	for(int i=0; i < 4; i++) {
+		float x = xs[i] - pivotX, y = ys[i] - pivotY;
+		SDL_FPoint corner = { pivotX + x * cosine - y * sine, pivotY + x * sine + y * cosine };
+		queued->corners[i] = corner;
+
+		if(i == 0 || corner.x < minX) minX = corner.x;
+		if(i == 0 || corner.y < minY) minY = corner.y;
+		if(i == 0 || corner.x > maxX) maxX = corner.x;
+		if(i == 0 || corner.y > maxY) maxY = corner.y;
+	}
+
+	SDL_Rect bounds = { (int)floor(minX), (int)floor(minY), (int)ceil(maxX) - (int)floor(minX), (int)ceil(maxY) - (int)floor(minY) };
+	queued->bounds = bounds;
+}
+
+static void queueSprite(Sprite sprite, SDL_Rect destination, double angle, SDL_Point rotateOrigin) {
+	if(spriteQueueCount == spriteQueueSize) {
+		spriteQueueSize = spriteQueueSize == 0 ? 256 : spriteQueueSize * 2;
+		spriteQueue = realloc(spriteQueue, sizeof(QueuedSprite) * spriteQueueSize);
+		batchOrder = realloc(batchOrder, sizeof(int) * spriteQueueSize);
+	}
+
+	QueuedSprite queued = {
+		sprite.texture,
+		sprite.source,
+		destination,
+		angle,
+		rotateOrigin,
+		sprite.flip,
+		sprite.state,
+		currentLayer,
+		spriteQueueCount
+	};
+	transformQueuedSprite(&queued);
+
+	spriteQueue[spriteQueueCount++] = queued;
+	frameStats.spritesSubmitted++;
+}
+
+static int compareQueuedSprites(const void *a, const void *b) {
+	const QueuedSprite *spriteA = a;
+	const QueuedSprite *spriteB = b;
+
+	if(spriteA->layer != spriteB->layer) return spriteA->layer - spriteB->layer;
+	return spriteA->order - spriteB->order;
+}
+
+//Within a layer, a sprite joins the most recent batch using its texture (and blend mode), as long as it doesn't
+// overlap anything queued in a later batch - so moving it earlier can never change what ends up on top.
+static void assignBatches() {
+	batchCount = 0;
+	int layerStart = 0;
+
+	for(int i=0; i < spriteQueueCount; i++) {
+		QueuedSprite *queued = &spriteQueue[i];
+		if(i > 0 && queued->layer != spriteQueue[i - 1].layer) layerStart = batchCount;
+
+		queued->batch = -1;
+		for(int b = batchCount - 1; b >= layerStart; b--) {
+			if(batches[b].texture == queued->texture && batches[b].blendMode == queued->state.blendMode) {
+				queued->batch = b;
+				break;
+			}
+			if(rectsOverlap(batches[b].bounds, queued->bounds)) break;
+		}
+
+		if(queued->batch < 0) {
+			if(batchCount == batchSize) {
+				batchSize = batchSize == 0 ? 64 : batchSize * 2;
+				batches = realloc(batches, sizeof(SpriteBatch) * batchSize);
+			}
+			SpriteBatch batch = { queued->texture, queued->state.blendMode, queued->bounds };
+			batches[batchCount] = batch;
+			queued->batch = batchCount++;
+		}else{
+			batches[queued->batch].bounds = unionRects(batches[queued->batch].bounds, queued->bounds);
+		}
+	}
+
+	//Counting sort by batch, which keeps submission order within each batch.
+	int *batchStarts = calloc(batchCount + 1, sizeof(int));
+	for(int i=0; i < spriteQueueCount; i++) batchStarts[spriteQueue[i].batch + 1]++;
+	for(int b=0; b < batchCount; b++) batchStarts[b + 1] += batchStarts[b];
+	for(int i=0; i < spriteQueueCount; i++) batchOrder[batchStarts[spriteQueue[i].batch]++] = i;
+	free(batchStarts);
+}
+
+//Textures are shared between versions (and sprites), so their state is set afresh for every draw.
+static void applyDrawState(SDL_Texture *texture, DrawState state) {
+	SDL_SetTextureColorMod(texture, state.modulation.r, state.modulation.g, state.modulation.b);
+	SDL_SetTextureAlphaMod(texture, state.modulation.a);
+	SDL_SetTextureBlendMode(texture, state.blendMode);
+}
+
+static void copyQueuedSprite(QueuedSprite *queued) {
+	applyDrawState(queued->texture, queued->state);
+
+	//Fast path: no transform to apply, so a plain copy will do.
+	if(queued->angle == 0 && queued->flip == SDL_FLIP_NONE) {
+		SDL_RenderCopy(renderer, queued->texture, &queued->source, &queued->destination);
+	}else{
+		SDL_RenderCopyEx(renderer, queued->texture, &queued->source, &queued->destination, queued->angle, &queued->rotateOrigin, queued->flip);
+	}
+	frameStats.drawCalls++;
+}
+
+//Copies a sprite straight to the current render target, bypassing the queue (e.g. composing
+// onto a canvas texture). Flush first, as for anything else that talks to the renderer directly.
+void copySpriteNow(Sprite sprite, SDL_Rect destination) {
+	applyDrawState(sprite.texture, sprite.state);
+	SDL_RenderCopy(renderer, sprite.texture, &sprite.source, &destination);
+}
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+static void drawBatchGeometry(int first, int count) {
+	SDL_Texture *texture = spriteQueue[batchOrder[first]].texture;
+
+	if(count * 4 > batchGeometrySize) {
+		batchGeometrySize = count * 4;
+		batchVertices = realloc(batchVertices, sizeof(SDL_Vertex) * batchGeometrySize);
+		batchIndices = realloc(batchIndices, sizeof(int) * (batchGeometrySize / 4) * 6);
+	}
+
+	//Geometry ignores texture modulation, so each sprite's is carried on its vertices instead.
+	int textureWidth, textureHeight;
+	SDL_QueryTexture(texture, NULL, NULL, &textureWidth, &textureHeight);
+	SDL_SetTextureBlendMode(texture, spriteQueue[batchOrder[first]].state.blendMode);
+
+	for(int i=0; i < count; i++) {
+		QueuedSprite *queued = &spriteQueue[batchOrder[first + i]];
+
+		float left = queued->source.x / (float)textureWidth;
+		float top = queued->source.y / (float)textureHeight;
+		float right = (queued->source.x + queued->source.w) / (float)textureWidth;
+		float bottom = (queued->source.y + queued->source.h) / (float)textureHeight;
+		if(queued->flip & SDL_FLIP_HORIZONTAL) {
+			float swap = left; left = right; right = swap;
+		}
+		if(queued->flip & SDL_FLIP_VERTICAL) {
+			float swap = top; top = bottom; bottom = swap;
+		}
+		SDL_FPoint uvs[4] = { { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+
+		for(int c=0; c < 4; c++) {
+			SDL_Vertex vertex = { queued->corners[c], queued->state.modulation, uvs[c] };
+			batchVertices[i * 4 + c] = vertex;
+		}
+
+		int quad[6] = { 0, 1, 2, 0, 2, 3 };
+		for(int v=0; v < 6; v++) batchIndices[i * 6 + v] = i * 4 + quad[v];
+	}
+
+	SDL_RenderGeometry(renderer, texture, batchVertices, count * 4, batchIndices, count * 6);
+	frameStats.drawCalls++;
+}
+#endif
+
+//Draw everything queued so far. Anything that talks to the renderer directly (render target
+// switches, clears, full-screen copies) must flush first, so it lands in the right order.
+void flushSprites() {
+	if(spriteQueueCount == 0) return;
+
+	qsort(spriteQueue, spriteQueueCount, sizeof(QueuedSprite), compareQueuedSprites);
+	assignBatches();
+
+	for(int first=0; first < spriteQueueCount;) {
+		int batch = spriteQueue[batchOrder[first]].batch;
+		int count = 1;
+		while(first + count < spriteQueueCount && spriteQueue[batchOrder[first + count]].batch == batch) count++;
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+		if(count > 1) {
+			drawBatchGeometry(first, count);
+		}else{
+			copyQueuedSprite(&spriteQueue[batchOrder[first]]);
+		}
+#else
+		for(int i=0; i < count; i++) copyQueuedSprite(&spriteQueue[batchOrder[first + i]]);
+#endif
+		first += count;
+	}
+
+	spriteQueueCount = 0;
+}
+
+void setRenderLayer(RenderLayer layer) {
+	currentLayer = layer;
+}
+
+RenderStats getRenderStats() {
+	return lastFrameStats;
+}
+
 //Default sprite_t drawing scales with pixel grid, for easy tiling.
 void drawSprite(Sprite drawSprite, Coord origin) {
 	Coord scaledOrigin = scaleCoord(origin, renderScale);
@@ -94,7 +380,7 @@ void drawSpriteAbsRotated2(Sprite sprite, Coord origin, double angle, double sca
 		rotateOrigin.y = (int)sprite.size.y / 2;
 	};
 
-	SDL_RenderCopyEx(renderer, sprite.texture, NULL, &destination, angle, &rotateOrigin, sprite.flip);
+	queueSprite(sprite, destination, angle, rotateOrigin);
 }
 
 void drawSpriteAbsRotated(Sprite sprite, Coord origin, double angle) {
@@ -105,6 +391,16 @@ void drawSpriteAbs(Sprite sprite, Coord origin) {
 	drawSpriteAbsRotated(sprite, origin, 0);
 }
 
+//Solid rectangle from its top-left corner, e.g. for debug graphs. Queued (and batched) like any sprite.
+void drawRectAbs(Coord topLeft, Coord size, SDL_Color colour) {
+	Sprite sprite = { solidTexture, zeroCoord(), makeCoord(1, 1), SDL_FLIP_NONE, { 0, 0, 1, 1 }, { colour, SDL_BLENDMODE_BLEND } };
+	SDL_Rect destination = { (int)topLeft.x, (int)topLeft.y, (int)size.x, (int)size.y };
+	SDL_Point rotateOrigin = { 0, 0 };
+
+	if(destination.w <= 0 || destination.h <= 0) return;
+	queueSprite(sprite, destination, 0, rotateOrigin);
+}
+
 void screenshot() {
     // We do a little magic here to take screenshots with 3x scale.
     // We render one frame to a specially-scaled canvas texture, then write *that* to the file system :)
@@ -119,6 +415,7 @@ void screenshot() {
     );
 
     // Redirect renderer to the screenshot buffer.
+    flushSprites();
     SDL_SetRenderTarget(renderer, shotBuffer);
 
     // Use SDL to blit (and scale) renderBuffer contents to the screenshot buffer.
@@ -150,10 +447,17 @@ void setDrawColour(Colour colour) {
     );
 }
 void clearBackground(Colour colour) {
+	flushSprites();
 	setDrawColour(colour);
 	SDL_RenderClear(renderer);
 }
 void updateCanvas() {
+	//Draw everything still queued for this frame, and start counting afresh.
+	flushSprites();
+	lastFrameStats = frameStats;
+	memset(&frameStats, 0, sizeof(frameStats));
+	currentLayer = 0;
+
 	//Change rendering homeTarget to window.
 	SDL_SetRenderTarget(renderer, NULL);
 
@@ -171,6 +475,21 @@ void updateCanvas() {
 void shutdownRenderer() {
 	if(renderer == NULL) return;			//OK to call if not yet setup (thanks, encapsulation)
 
+	free(spriteQueue);
+	free(batchOrder);
+	free(batches);
+	free(batchVertices);
+	free(batchIndices);
+	spriteQueue = NULL;
+	batchOrder = NULL;
+	batches = NULL;
+	batchVertices = NULL;
+	batchIndices = NULL;
+	spriteQueueCount = spriteQueueSize = batchCount = batchSize = batchGeometrySize = 0;
+
+	if(solidTexture != NULL) SDL_DestroyTexture(solidTexture);
+	solidTexture = NULL;
+
 	SDL_DestroyRenderer(renderer);
 	renderer = NULL;
 }
@@ -183,24 +502,24 @@ Coord getSunPosition() {
 	);
 }
 
-Coord getParallaxOffset() {
+Coord getParallaxOffset(const GameContext *game) {
 	//IMPORTANT: We only ever want the *X axis parallax*. Omitting the
 	// Y axis causes trig enemy shots to work correctly, when
 	// parallax is enabled.
 
 	return makeCoord(
-		(screenBounds.x / 2) - playerOrigin.x,
+		(screenBounds.x / 2) - game->player.origin.x,
 		(screenBounds.y / 2)
 	);
 }
 
-Coord parallax(Coord subject, ParallaxReference reference, ParallaxLayer layer, ParallaxDimensions dimensions, ParallaxMode mode) {
+Coord parallax(const GameContext *game, Coord subject, ParallaxReference reference, ParallaxLayer layer, ParallaxDimensions dimensions, ParallaxMode mode) {
 	if(!ENABLE_PARALLAX || layer == 0) return subject;
 
 	//Use a different frame of reference depending on parameter.
 	Coord relativeOrigin = reference == PARALLAX_SUN ?
 	   getSunPosition() :
-	   getParallaxOffset();
+	   getParallaxOffset(game);
 
 	//Calculate distance between points, soften by layer divisor, use mode positive or negative to determine direction,
 	// and offset the subject coordinate accordingly.
@@ -210,24 +529,39 @@ Coord parallax(Coord subject, ParallaxReference reference, ParallaxLayer layer,
 	);
 }
 
-bool isFading() {
-	return currentFadeAlpha > 0 && currentFadeAlpha < 255;
+void setInterpolation(double alpha) {
+	interpolation = alpha < 0 ? 0 : alpha > 1 ? 1 : alpha;
 }
 
-void fadeInWhite() {
-    currentFadeMode = FADE_IN;
-    currentFadeAlpha = 255;
-    fadeWhite = true;
+//Where to draw something that was at previous on the last game step, and is at current on this one.
+Coord interpolate(Coord previous, Coord current) {
+	if(fabs(current.x - previous.x) > INTERPOLATION_SNAP_DISTANCE ||
+	   fabs(current.y - previous.y) > INTERPOLATION_SNAP_DISTANCE) return current;
+
+	return makeCoord(
+		previous.x + (current.x - previous.x) * interpolation,
+		previous.y + (current.y - previous.y) * interpolation
+	);
 }
 
-void fadeIn() {
-	currentFadeMode = FADE_IN;
-	currentFadeAlpha = 255;
+bool isFading(const GameContext *game) {
+	return game->fade.alpha > 0 && game->fade.alpha < 255;
 }
 
-void fadeOut() {
-	currentFadeMode = FADE_OUT;
-	currentFadeAlpha = 0;
+void fadeInWhite(GameContext *game) {
+    game->fade.mode = FADE_IN;
+    game->fade.alpha = 255;
+    game->fade.white = true;
+}
+
+void fadeIn(GameContext *game) {
+	game->fade.mode = FADE_IN;
+	game->fade.alpha = 255;
+}
+
+void fadeOut(GameContext *game) {
+	game->fade.mode = FADE_OUT;
+	game->fade.alpha = 0;
 }
 
 static SDL_Texture* makeFader(int r, int g, int b) {
@@ -259,41 +593,58 @@ static SDL_Texture* makeFader(int r, int g, int b) {
     return fadeOverlay;
 }
 
+static void initSolidTexture() {
+	Uint32 white = 0xffffffff;
+	solidTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 1, 1);
+	if(solidTexture == NULL) fatalError("Could not create solid texture", SDL_GetError());
+
+	SDL_UpdateTexture(solidTexture, NULL, &white, sizeof(white));
+	SDL_SetTextureBlendMode(solidTexture, SDL_BLENDMODE_BLEND);
+}
+
 static void initFader() {
-	fadeAlphaInc = (255 * RENDER_HZ) / (double)FADE_DURATION;
+	fadeAlphaInc = (255 * GAME_HZ) / (double)FADE_DURATION;
 
     blackFader = makeFader(0, 0, 0);
     whiteFader = makeFader(255, 255, 255);
 }
 
-void faderRenderFrame() {
-	switch(currentFadeMode) {
+//Fades advance with game frames, since scripts wait on them (render frames can come at any rate).
+void faderGameFrame(GameContext *game) {
+	FadeState *fade = &game->fade;
+
+	switch(fade->mode) {
 		case FADE_NONE:
 			return;
 		case FADE_IN:
 			//Halt the fader if we're <= the max value (otherwise we get a frame of opaqueness)
-			if((currentFadeAlpha - fadeAlphaInc) <= 0) {
-				currentFadeMode = FADE_NONE;
-				currentFadeAlpha = 0;
-                fadeWhite = false;
+			if((fade->alpha - fadeAlphaInc) <= 0) {
+				fade->mode = FADE_NONE;
+				fade->alpha = 0;
+                fade->white = false;
 				return;
 			}else{
-				currentFadeAlpha -= fadeAlphaInc;
+				fade->alpha -= fadeAlphaInc;
 			}
 			break;
 		case FADE_OUT:
-			if(currentFadeAlpha >= 255) {
-				currentFadeMode = FADE_NONE;
-				currentFadeAlpha = 255;
-                fadeWhite = false;
+			if(fade->alpha >= 255) {
+				fade->mode = FADE_NONE;
+				fade->alpha = 255;
+                fade->white = false;
 			}else{
-				currentFadeAlpha += 5;
+				fade->alpha += 5;
 			}
 			break;
 	}
+}
+
+void faderRenderFrame(GameContext *game) {
+	if(game->fade.mode == FADE_NONE) return;
 
-    SDL_Texture* useFader = fadeWhite ? whiteFader : blackFader;
-	SDL_SetTextureAlphaMod(useFader, currentFadeAlpha);
+    SDL_Texture* useFader = game->fade.white ? whiteFader : blackFader;
+	SDL_SetTextureAlphaMod(useFader, game->fade.alpha);
+	flushSprites();
 	SDL_RenderCopy(renderer, useFader, NULL, NULL);
 }
 
@@ -369,4 +720,5 @@ void initRenderer() {
 	SDL_SetRenderTarget(renderer, renderBuffer);
 
 	initFader();
+	initSolidTexture();
 }
\ No newline at end of file
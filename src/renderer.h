@@ -3,14 +3,39 @@
 
 #include "mysdl.h"
 #include "common.h"
+#include "assets.h"
 
 typedef struct {
 	SDL_Texture *texture;
 	Coord offset;
 	Coord size;
 	SDL_RendererFlip flip;
+	SDL_Rect source;		//region of the texture to draw (e.g. within an atlas page).
+	DrawState state;		//modulation and blending it's drawn with.
 } Sprite;
 
+//Render phases, in the order main.c draws them. The sprite batch may regroup sprites by texture
+// within a layer, but never across one.
+typedef enum {
+	RENDER_LAYER_BACKGROUND,
+	RENDER_LAYER_BACKGROUND_ENEMIES,
+	RENDER_LAYER_PLATFORMS,
+	RENDER_LAYER_SHADOWS,
+	RENDER_LAYER_ENEMIES,
+	RENDER_LAYER_ITEMS,
+	RENDER_LAYER_SHOTS,
+	RENDER_LAYER_SCRIPTS,
+	RENDER_LAYER_PLAYER,
+	RENDER_LAYER_HUD,
+	RENDER_LAYER_PERSISTENT_HUD
+} RenderLayer;
+
+//Last completed frame's batching figures.
+typedef struct {
+	int spritesSubmitted;
+	int drawCalls;
+} RenderStats;
+
 typedef enum {
 	PARALLAX_SUN,
 	PARALLAX_PAN
@@ -41,19 +66,27 @@ extern const int STATIC_SHADOW_OFFSET;
 
 extern void screenshot();
 extern void toggleFullscreen();
-extern Coord getParallaxOffset();
-extern Coord parallax(Coord subject, ParallaxReference reference, ParallaxLayer layer, ParallaxDimensions dimensions, ParallaxMode mode);
+extern Coord getParallaxOffset(const GameContext *game);
+extern Coord parallax(const GameContext *game, Coord subject, ParallaxReference reference, ParallaxLayer layer, ParallaxDimensions dimensions, ParallaxMode mode);
 extern bool inScreenBounds(Coord subject);
+extern void setInterpolation(double alpha);
+extern Coord interpolate(Coord previous, Coord current);
 extern Coord screenBounds;
 extern int scalePixels(int pixels);
 extern SDL_Renderer *renderer;
 extern Coord pixelGrid;
 extern Sprite makeSimpleSprite(char *textureName);
+extern Sprite makeHandleSprite(AssetHandle handle, AssetVersion version);
 extern Sprite makeSprite(SDL_Texture *texture, Coord offset, SDL_RendererFlip flip);
 extern void drawSpriteAbsRotated2(Sprite sprite, Coord origin, double angle, double scaleX, double scaleY);
 extern void drawSpriteAbsRotated(Sprite drawSprite, Coord origin, double angle);
 extern void drawSpriteAbs(Sprite drawSprite, Coord origin);
 extern void drawSprite(Sprite drawSprite, Coord origin);
+extern void drawRectAbs(Coord topLeft, Coord size, SDL_Color colour);
+extern void copySpriteNow(Sprite sprite, SDL_Rect destination);
+extern void setRenderLayer(RenderLayer layer);
+extern void flushSprites();
+extern RenderStats getRenderStats();
 extern void setDrawColour(Colour drawColour);
 extern void clearBackground(Colour clearColour);
 extern void updateCanvas();
@@ -61,12 +94,6 @@ extern void initRenderer();
 extern void shutdownRenderer();
 
 //Fader
-extern void faderRenderFrame();
-extern bool isFading();
-extern void fadeIn();
-extern void fadeInWhite();
-extern void fadeOut();
-
 typedef enum {
 	FADE_NONE = 0,
 	FADE_IN = 1,
@@ -74,4 +101,18 @@ typedef enum {
 } FadeMode;
 extern const FadeMode FADE_BOTH;
 
+//Where a game's fade has got to. Scripts wait on fades, so this is game state (see GameContext).
+typedef struct {
+	FadeMode mode;
+	int alpha;
+	bool white;
+} FadeState;
+
+extern void faderGameFrame(GameContext *game);
+extern void faderRenderFrame(GameContext *game);
+extern bool isFading(const GameContext *game);
+extern void fadeIn(GameContext *game);
+extern void fadeInWhite(GameContext *game);
+extern void fadeOut(GameContext *game);
+
 #endif
\ No newline at end of file
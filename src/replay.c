@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include "replay.h"
+#include "common.h"
+#include "myc.h"
+
+//Input rarely changes from one step to the next, so it's stored as runs of (input, steps) after a
+// short header. Everything is little-endian.
+
+#define REPLAY_MAGIC "MQRPLY1"
+
+typedef struct {
+	char magic[8];
+	Uint32 seed;
+	Uint32 reserved;
+} ReplayHeader;
+
+typedef struct {
+	Uint32 input;
+	Uint32 steps;
+} ReplayRun;
+
+//Recording.
+static FILE *recording;
+static char *recordingPath;
+static ReplayRun pendingRun;		//the run still going, written out once the input changes.
+
+//Playback.
+static ReplayRun *runs;
+static int runCount;
+static int runInc;
+static Uint32 runStep;
+
+static bool writeRun(ReplayRun run) {
+	ReplayRun stored = { SDL_SwapLE32(run.input), SDL_SwapLE32(run.steps) };
+	return fwrite(&stored, sizeof(stored), 1, recording) == 1;
+}
+
+void startRecording(const char *path, Uint32 seed) {
+	recording = fopen(path, "wb");
+	if(recording == NULL) {
+		fatalError("Could not create replay", path);
+		exit(1);
+	}
+	recordingPath = SDL_strdup(path);
+
+	ReplayHeader header = { REPLAY_MAGIC, SDL_SwapLE32(seed), 0 };
+	if(fwrite(&header, sizeof(header), 1, recording) != 1) {
+		fatalError("Could not write replay", path);
+		exit(1);
+	}
+
+	ReplayRun none = { 0, 0 };
+	pendingRun = none;
+}
+
+void recordInput(Uint32 input) {
+	if(recording == NULL) return;
+
+	if(pendingRun.steps > 0 && (pendingRun.input != input || pendingRun.steps == UINT32_MAX)) {
+		if(!writeRun(pendingRun)) SDL_Log("Could not write to replay %s.", recordingPath);
+		pendingRun.steps = 0;
+	}
+
+	pendingRun.input = input;
+	pendingRun.steps++;
+}
+
+//Loads a replay to play back, and returns the seed to start the game with.
+Uint32 startReplay(const char *path) {
+	size_t size;
+	Uint8 *data = SDL_LoadFile(path, &size);
+	if(data == NULL) {
+		fatalError("Could not read replay", path);
+		exit(1);
+	}
+
+	ReplayHeader header;
+	if(size < sizeof(header) || memcmp(data, REPLAY_MAGIC, sizeof(header.magic)) != 0 ||
+	   (size - sizeof(header)) % sizeof(ReplayRun) != 0) {
+		fatalError("Not a Mouse Quest replay (or it's damaged)", path);
+		exit(1);
+	}
+	memcpy(&header, data, sizeof(header));
+
+	runCount = (size - sizeof(header)) / sizeof(ReplayRun);
+	runs = malloc(sizeof(ReplayRun) * (runCount > 0 ? runCount : 1));
+	memcpy(runs, data + sizeof(header), sizeof(ReplayRun) * runCount);
+	for(int i=0; i < runCount; i++) {
+		runs[i].input = SDL_SwapLE32(runs[i].input);
+		runs[i].steps = SDL_SwapLE32(runs[i].steps);
+	}
+	runInc = 0;
+	runStep = 0;
+	SDL_free(data);
+
+	SDL_Log("Replaying %s (%d input runs).", path, runCount);
+	return SDL_SwapLE32(header.seed);
+}
+
+bool isReplaying() {
+	return runs != NULL;
+}
+
+//Fills in the next step's input, or returns false once the replay has run out.
+bool replayInput(Uint32 *input) {
+	while(runInc < runCount && runStep == runs[runInc].steps) {
+		runInc++;
+		runStep = 0;
+	}
+	if(runInc == runCount) return false;
+
+	*input = runs[runInc].input;
+	runStep++;
+	return true;
+}
+
+void shutdownReplay() {
+	if(recording != NULL) {
+		bool ok = pendingRun.steps == 0 || writeRun(pendingRun);
+		ok = fclose(recording) == 0 && ok;
+		if(!ok) SDL_Log("Could not finish writing replay %s.", recordingPath);
+		recording = NULL;
+	}
+	SDL_free(recordingPath);
+	recordingPath = NULL;
+
+	free(runs);
+	runs = NULL;
+	runCount = 0;
+}
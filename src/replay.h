@@ -0,0 +1,16 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include "mysdl.h"
+
+//Input record and playback (--record file, --replay file). A replay holds the random seed and the
+// game's input for every game step, so playing it back runs the same game, step for step.
+extern void startRecording(const char *path, Uint32 seed);
+extern Uint32 startReplay(const char *path);
+extern bool isReplaying();
+extern void recordInput(Uint32 input);
+extern bool replayInput(Uint32 *input);
+extern void shutdownReplay();
+
+#endif
@@ -0,0 +1,143 @@
+#include "scheduler.h"
+#include "common.h"
+#include "gameclock.h"
+#include "myc.h"
+
+//Main loop timing. Rather than polling timers flat out, we work out whether a game step or a
+// render falls due next and sleep until just before it, spinning only for the last stretch
+// (SDL_Delay can oversleep by a millisecond or so).
+//
+//The game itself runs in fixed steps of GAME_HZ game milliseconds. Real time (at the game clock's
+// time scale) builds up in an accumulator, and each pass runs as many whole steps as it holds, so
+// a long frame is caught up on rather than dropped, and ticks never bunch up or drift. What's left
+// over says how far to draw between the last two steps. Everything else the game times (animation
+// included) counts game steps, so only rendering runs on real time.
+
+//After a stall (a breakpoint, window drag, etc.) we'd rather lose time than fast-forward through it.
+static const int MAX_CATCH_UP_STEPS = 5;
+static const double SPIN_MILLISECONDS = 2;
+static const double TIMING_WINDOW_MILLISECONDS = 1000;
+
+static Uint64 frequency;
+static Uint64 spinMargin;
+
+//Rendering, in performance counter units.
+static Uint64 renderPeriod;
+static Uint64 nextRender;
+
+//Game steps.
+static Uint64 lastPass;
+static double accumulated;		//game milliseconds not yet stepped.
+
+//Frame timing, gathered over a window and then published.
+static Uint64 busySince;
+static Uint64 windowStart;
+static Uint64 windowBusy;
+static int windowFrames;
+static FrameTiming frameTiming;
+
+static Uint64 millisecondsToCounter(double milliseconds) {
+	return (Uint64)(milliseconds * frequency / 1000);
+}
+
+static double counterToMilliseconds(Uint64 counter) {
+	return counter * 1000.0 / frequency;
+}
+
+void initScheduler() {
+	frequency = SDL_GetPerformanceFrequency();
+	spinMargin = millisecondsToCounter(SPIN_MILLISECONDS);
+
+	//Everything is due straight away.
+	Uint64 now = SDL_GetPerformanceCounter();
+	renderPeriod = millisecondsToCounter(RENDER_HZ);
+	nextRender = now;
+	lastPass = now;
+	accumulated = GAME_HZ;
+
+	busySince = now;
+	windowStart = now;
+	windowBusy = 0;
+	windowFrames = 0;
+}
+
+static void recordFrame(Uint64 now) {
+	windowFrames++;
+	if(now - windowStart < millisecondsToCounter(TIMING_WINDOW_MILLISECONDS)) return;
+
+	Uint64 elapsed = now - windowStart;
+	frameTiming.busyMs = counterToMilliseconds(windowBusy) / windowFrames;
+	frameTiming.frameMs = counterToMilliseconds(elapsed) / windowFrames;
+	frameTiming.cpuPercent = 100.0 * windowBusy / elapsed;
+
+#ifdef DEBUG_FRAME_TIMING
+	SDL_Log("Frame: %.2fms busy of %.2fms (%.0f%% CPU).", frameTiming.busyMs, frameTiming.frameMs, frameTiming.cpuPercent);
+#endif
+
+	windowStart = now;
+	windowBusy = 0;
+	windowFrames = 0;
+}
+
+//When the accumulator will next hold a whole step, or 0 if the game clock is paused.
+static Uint64 nextGameStep(Uint64 now) {
+	if(isGameClockPaused()) return 0;
+	if(accumulated >= GAME_HZ) return now;
+
+	//Finish catching up from the last pass first, so the wait is measured from there.
+	double gameMilliseconds = accumulated + counterToMilliseconds(now - lastPass) * getTimeScale();
+	if(gameMilliseconds >= GAME_HZ) return now;
+	return now + millisecondsToCounter((GAME_HZ - gameMilliseconds) / getTimeScale()) + 1;
+}
+
+//Banks the real time since the last pass, and takes as many whole game steps out as it can.
+static int takeGameSteps(Uint64 now) {
+	accumulated += counterToMilliseconds(now - lastPass) * getTimeScale();
+	lastPass = now;
+
+	int steps = (int)(accumulated / GAME_HZ);
+	if(steps > MAX_CATCH_UP_STEPS) {
+		//Drop the whole steps we won't run, but keep the part-step so the alpha stays continuous.
+		accumulated -= (steps - MAX_CATCH_UP_STEPS) * GAME_HZ;
+		steps = MAX_CATCH_UP_STEPS;
+	}
+	accumulated -= steps * GAME_HZ;
+
+	return steps;
+}
+
+//Sleeps until a game step or render is due, and returns what to run.
+DueTicks waitForTicks() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	windowBusy += now - busySince;
+
+	//Rendering never pauses, so there's always a deadline.
+	Uint64 deadline = nextRender;
+	Uint64 gameDeadline = nextGameStep(now);
+	if(gameDeadline != 0 && gameDeadline < deadline) deadline = gameDeadline;
+
+	//Sleep off most of the wait, then spin for the rest.
+	if(deadline > now + spinMargin) {
+		SDL_Delay((Uint32)counterToMilliseconds(deadline - now - spinMargin));
+	}
+	while((now = SDL_GetPerformanceCounter()) < deadline);
+	busySince = now;
+
+	DueTicks due = { 0, takeGameSteps(now), accumulated / GAME_HZ };
+	if(due.gameSteps > 0) due.sources |= TICK_GAME;
+
+	if(now >= nextRender) {
+		due.sources |= TICK_RENDER;
+
+		//Keep to the beat, but there's no point drawing frames we missed after a stall.
+		nextRender += renderPeriod;
+		if(nextRender <= now) nextRender = now + renderPeriod;
+		recordFrame(now);
+	}
+
+	return due;
+}
+
+FrameTiming getFrameTiming() {
+	return frameTiming;
+}
@@ -0,0 +1,30 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "mysdl.h"
+
+//Tick sources the main loop runs, as flags (both can fall due together).
+typedef enum {
+	TICK_GAME = 1,
+	TICK_RENDER = 2
+} TickSource;
+
+//What the main loop should run on this pass.
+typedef struct {
+	int sources;			//TickSource flags.
+	int gameSteps;			//fixed game steps to run, oldest first (only set with TICK_GAME).
+	double alpha;			//how far game time has got between the last step and the next, from 0 to 1.
+} DueTicks;
+
+//Averages over the last second of rendered frames.
+typedef struct {
+	double busyMs;			//time spent working per frame (rather than sleeping).
+	double frameMs;			//time between frames.
+	double cpuPercent;		//share of the frame spent busy.
+} FrameTiming;
+
+extern void initScheduler();
+extern DueTicks waitForTicks();
+extern FrameTiming getFrameTiming();
+
+#endif
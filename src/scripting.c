@@ -1,8 +1,9 @@
 #include <stdbool.h>
-#include <time.h>
+#include "gameclock.h"
 #include "scripting.h"
 #include "scripts.h"
 #include "common.h"
+#include "game.h"
 
 /*
  * Every game state is configured as a kind of script. Even the main game loop is defined this way.
@@ -14,25 +15,24 @@
  * effecively have one continuous scene - these just have the one scene with a SCENE_INFINITE type,
  * that will continue looping until the game state is manually changed.
  *
- * The game state itself is kept in common.h, so any code file can easily change it.
+ * The game state itself is kept in the GameContext, so any frame function can easily change it.
  *
  * For simple states, you can use isScriptInitialised for one-time commands, otherwise use an array
  * you can switch through together with 'cue' scenes to choreograph your script more clearly.
  */
 
-ScriptStatus scriptStatus;
 Script scripts[MAX_SCRIPTS];
 
-bool sceneInitialised() {
-	return scriptStatus.sceneProgress > SCENE_UNINITIALISED;
+bool sceneInitialised(const GameContext *game) {
+	return game->script.status.sceneProgress > SCENE_UNINITIALISED;
 }
 
-Script getScript() {
-	return scripts[gameState];
+Script getScript(const GameContext *game) {
+	return scripts[game->state];
 }
 
-Scene getScene() {
-	return getScript().scenes[scriptStatus.sceneNumber];
+Scene getScene(const GameContext *game) {
+	return getScript(game).scenes[game->script.status.sceneNumber];
 }
 
 Scene newTimedStep(SceneType trigger, int milliseconds, FadeMode fadeMode) {
@@ -49,29 +49,34 @@ Scene newStateStep(GameState toState) {
 	return event;
 }
 
-void goToNextScene() {
+void goToNextScene(GameContext *game) {
+	ScriptStatus *scriptStatus = &game->script.status;
+
 	//Increment, or reset back to zero if we've completed all scenes.
 	//NB: Resetting to zero also doubles as a script cycle, and kicking off a new state change.
-	if(scriptStatus.sceneNumber < getScript().totalScenes-1){
-		scriptStatus.sceneNumber++;
+	if(scriptStatus->sceneNumber < getScript(game).totalScenes-1){
+		scriptStatus->sceneNumber++;
 	}else{
-		scriptStatus.sceneNumber = 0;
+		scriptStatus->sceneNumber = 0;
 	}
 
-	scriptStatus.sceneProgress = SCENE_UNINITIALISED;
-	scriptStatus.sceneTimer = 0;
+	scriptStatus->sceneProgress = SCENE_UNINITIALISED;
+	scriptStatus->sceneTimer = 0;
 }
 
-void resetScriptStatus() {
-	scriptStatus.sceneNumber = 0;
-	scriptStatus.sceneProgress = SCENE_UNINITIALISED;
-	scriptStatus.sceneTimer = 0;
+void resetScriptStatus(GameContext *game) {
+	ScriptStatus *scriptStatus = &game->script.status;
+
+	scriptStatus->sceneNumber = 0;
+	scriptStatus->sceneProgress = SCENE_UNINITIALISED;
+	scriptStatus->sceneTimer = 0;
 }
 
-void endOfFrameTransition() {
+void endOfFrameTransition(GameContext *game) {
 	//It's the end of frame. Leverage whether we're uninitialised to do certain things here (e.g. fade in),
 	// otherwise we ensure we flag ourselves as initialised before we move to the next scene / frame.
-	Scene scene = getScene();
+	ScriptStatus *scriptStatus = &game->script.status;
+	Scene scene = getScene(game);
 
 	switch(scene.type) {
 		case SCENE_CUE:
@@ -80,54 +85,54 @@ void endOfFrameTransition() {
 			// unusual in-between state. Note that even if the next frame is a cue frame as well,
 			// we will repeat this same check on the conclusion of that frame - since this is called
 			// every time.
-			goToNextScene();
-			scriptGameFrame();
+			goToNextScene(game);
+			scriptGameFrame(game);
 			break;
 		case SCENE_STATE:
 			//Changing to a new state? Reset our local progress, and run the first frame of the next
 			// state immediately, as with SCENE_CUE.
-			resetScriptStatus();
-			triggerState(scene.toState);
-			scriptGameFrame();
+			resetScriptStatus(game);
+			triggerState(game, scene.toState);
+			scriptGameFrame(game);
 			break;
 		case SCENE_LOOP:
-			switch(scriptStatus.sceneProgress) {
+			switch(scriptStatus->sceneProgress) {
 				//Initialised, go to fade in or loop.
 				case SCENE_UNINITIALISED:
 					//Toggle fade in.
 					if((scene.fadeMode & FADE_IN) > 0) {
-						scriptStatus.sceneProgress = SCENE_FADE_IN;
-						fadeIn();
+						scriptStatus->sceneProgress = SCENE_FADE_IN;
+						fadeIn(game);
 					//Toggle main loop. IMPORTANT: We start our frame clock now, AFTER the fade.
 					} else {
-						scriptStatus.sceneProgress = SCENE_LOOPING;
-						scriptStatus.sceneTimer = clock();
+						scriptStatus->sceneProgress = SCENE_LOOPING;
+						scriptStatus->sceneTimer = gameTime(game);
 					}
 					break;
 				//Fading and complete? Go to loop.
 				case SCENE_FADE_IN:
-					if(!isFading()) {
-						scriptStatus.sceneProgress = SCENE_LOOPING;
-						scriptStatus.sceneTimer = clock();
+					if(!isFading(game)) {
+						scriptStatus->sceneProgress = SCENE_LOOPING;
+						scriptStatus->sceneTimer = gameTime(game);
 					}
 					break;
 				//Looping and due to stop? Fade out, or go to next scene.
 				case SCENE_LOOPING:
-					if(due(scriptStatus.sceneTimer, scene.duration)) {
+					if(due(game, scriptStatus->sceneTimer, scene.duration)) {
 						//If we need to fade out first - do that.
 						if((scene.fadeMode & FADE_OUT) > 0) {
-							fadeOut();
-							scriptStatus.sceneProgress = SCENE_FADE_OUT;
+							fadeOut(game);
+							scriptStatus->sceneProgress = SCENE_FADE_OUT;
 						//Otherwise, next scene.
 						} else {
-							goToNextScene();
+							goToNextScene(game);
 						}
 					}
 					break;
 				//Stopped fade out? Go to next scene.
 				case SCENE_FADE_OUT:
-					if(!isFading()) {
-						goToNextScene();
+					if(!isFading(game)) {
+						goToNextScene(game);
 					}
 					break;
 			}
@@ -135,30 +140,30 @@ void endOfFrameTransition() {
 		case SCENE_INFINITE:
 			// Fade on infinite scripts too.
 			// TODO: Tidy this up - lots of duplication from above.
-			switch(scriptStatus.sceneProgress) {
+			switch(scriptStatus->sceneProgress) {
 				//Initialised, go to fade in or loop.
 				case SCENE_UNINITIALISED:
 					//Toggle fade in.
 					if((scene.fadeMode & FADE_IN) > 0) {
-						scriptStatus.sceneProgress = SCENE_FADE_IN;
-						fadeIn();
+						scriptStatus->sceneProgress = SCENE_FADE_IN;
+						fadeIn(game);
 						//Toggle main loop. IMPORTANT: We start our frame clock now, AFTER the fade.
 					} else {
-						scriptStatus.sceneProgress = SCENE_LOOPING;
-						scriptStatus.sceneTimer = clock();
+						scriptStatus->sceneProgress = SCENE_LOOPING;
+						scriptStatus->sceneTimer = gameTime(game);
 					}
 					break;
 					//Fading and complete? Go to loop.
 				case SCENE_FADE_IN:
-					if(!isFading()) {
-						scriptStatus.sceneProgress = SCENE_LOOPING;
-						scriptStatus.sceneTimer = clock();
+					if(!isFading(game)) {
+						scriptStatus->sceneProgress = SCENE_LOOPING;
+						scriptStatus->sceneTimer = gameTime(game);
 					}
 					break;
 			}
 
-			if(scriptStatus.sceneProgress == SCENE_UNINITIALISED) {
-				scriptStatus.sceneProgress = SCENE_INITIALISED;
+			if(scriptStatus->sceneProgress == SCENE_UNINITIALISED) {
+				scriptStatus->sceneProgress = SCENE_INITIALISED;
 			}
 
 			//Keep cycling 'till we manually trigger a state change.
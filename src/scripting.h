@@ -41,13 +41,12 @@ typedef struct {
 } Script;
 
 extern Script scripts[MAX_SCRIPTS];
-extern ScriptStatus scriptStatus;
 
-extern bool sceneInitialised();
+extern bool sceneInitialised(const GameContext *game);
 extern Scene newTimedStep(SceneType trigger, int milliseconds, FadeMode fadeMode);
 extern Scene newCueStep();
 extern Scene newStateStep(GameState toState);
-extern void endOfFrameTransition();
-extern void resetScriptStatus();
+extern void endOfFrameTransition(GameContext *game);
+extern void resetScriptStatus(GameContext *game);
 
 #endif
@@ -1,4 +1,4 @@
-#include <time.h>
+#include "gameclock.h"
 #include "renderer.h"
 #include "assets.h"
 #include "input.h"
@@ -12,16 +12,9 @@
 #include "hud.h"
 #include "sound.h"
 #include "level.h"
+#include "game.h"
 
-//Script-specific vars.
-static char intro_mikeStafeDir;
-
-static Sprite title_logoSprite;
-static Coord title_logoLocation;
-
-static bool game_showLevelMessage;
 static const double GAME_MESSAGE_DURATION = 1.5;
-static long game_messageTime;
 
 typedef enum {
 	TITLE_CUE,
@@ -66,220 +59,223 @@ typedef enum {
 	INTRO_TITLE_CUE
 } IntroCues;
 
-void scriptGameFrame() {
+void scriptGameFrame(GameContext *game) {
+	ScriptContext *script = &game->script;
+	PlayerContext *player = &game->player;
+	Random *random = &game->random[RANDOM_LEVEL];
 
-	if(!stateInitialised) {
-		resetScriptStatus();
-		stateInitialised = true;
+	if(!game->stateInitialised) {
+		resetScriptStatus(game);
+		game->stateInitialised = true;
 	}
 
-	switch(gameState) {
+	switch(game->state) {
 		case STATE_STATS:
 			break;
 
 		case STATE_LEVEL_COMPLETE:
-			switch(scriptStatus.sceneNumber){
+			switch(script->status.sceneNumber){
 				case END_SMILE_CUE:
-					smile();
+					smile(game);
 					break;
 				case END_WARP_CUE:
 					play("warp.wav");
-					forcedFrame = "mike-01.png";
+					player->forcedFrame = ASSET_MIKE_01;
 					break;
 				case END_WARP:
-					playerOrigin.y -= 4.0;
+					player->origin.y -= 4.0;
 					break;
 			}
 			break;
 
 		case STATE_GAME_OVER:
 			//Skip to titlescreen if fire button pressed.
-			if(checkCommand(CMD_PLAYER_SKIP_TO_TITLE)) {
-				triggerState(STATE_TITLE);
+			if(checkCommand(game, CMD_PLAYER_SKIP_TO_TITLE)) {
+				triggerState(game, STATE_TITLE);
 			}
 			break;
 
 		case STATE_COIN:
-			switch(scriptStatus.sceneNumber) {
+			switch(script->status.sceneNumber) {
 				case COIN_CUE:
-					resetEnemies();
-					useMike = false;
-					insertCoin();
+					resetEnemies(game);
+					player->useMike = false;
+					insertCoin(game);
 					break;
 				case COIN_PLAY:
 					break;
 				case COIN_END_CUE:
-					triggerState(STATE_GAME);
+					triggerState(game, STATE_GAME);
 					break;
 			}
 			break;
 
 		case STATE_INTRO:
 			// Insert coin if fire button is pressed.
-			if(checkCommand(CMD_PLAYER_SKIP_TO_TITLE)) {
-				triggerState(STATE_COIN);
+			if(checkCommand(game, CMD_PLAYER_SKIP_TO_TITLE)) {
+				triggerState(game, STATE_COIN);
 			}
 
-			switch(scriptStatus.sceneNumber) {
+			switch(script->status.sceneNumber) {
 				case INTRO_CUE:
-					resetPlayer();
-					resetEnemies();
-					resetBackground();
-					useMike = false;
+					resetPlayer(game);
+					resetEnemies(game);
+					resetBackground(game);
+					player->useMike = false;
 //					staticBackground = true;
-					intro_mikeStafeDir = -1;
+					script->introStrafeDir = -1;
 					play("intro-presents.wav");
 					break;
 
 				case INTRO_BATTLE_CUE:
 					// Spawn randomMq assortment of enemies.
 					// NB: 0-5 enemy index excludes the boss (6).
-					spawnEnemy(80, randomMq(40, 65), (EnemyType)randomMq(0, 5), PATTERN_NONE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
-					spawnEnemy(110, randomMq(40, 65), (EnemyType)randomMq(0, 5), PATTERN_NONE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
-					spawnEnemy(140, randomMq(40, 65), (EnemyType)randomMq(0, 5), PATTERN_NONE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
-					playerOrigin.y = screenBounds.y + 16;
-					useMike = true;
+					spawnEnemy(game, 80, randomMq(random, 40, 65), (EnemyType)randomMq(random, 0, 5), PATTERN_NONE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
+					spawnEnemy(game, 110, randomMq(random, 40, 65), (EnemyType)randomMq(random, 0, 5), PATTERN_NONE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
+					spawnEnemy(game, 140, randomMq(random, 40, 65), (EnemyType)randomMq(random, 0, 5), PATTERN_NONE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
+					player->origin.y = screenBounds.y + 16;
+					player->useMike = true;
 					playMusic("intro-battle-3.ogg", 1);
 					break;
 				case INTRO_BATTLE_MIKE_ENTER:
-					scriptCommand(CMD_PLAYER_UP);
+					scriptCommand(game, CMD_PLAYER_UP);
 					break;
 				case INTRO_BATTLE_MIKE_SMILING_CUE:
-					smile();
+					smile(game);
 					break;
 				case INTRO_BATTLE_MIKE_FIRE:
-					scriptCommand(CMD_PLAYER_FIRE);
+					scriptCommand(game, CMD_PLAYER_FIRE);
 
 					//Strafe left and right.
-					if(intro_mikeStafeDir < 0) {
-						scriptCommand(CMD_PLAYER_LEFT);
+					if(script->introStrafeDir < 0) {
+						scriptCommand(game, CMD_PLAYER_LEFT);
 					}else{
-						scriptCommand(CMD_PLAYER_RIGHT);
+						scriptCommand(game, CMD_PLAYER_RIGHT);
 					}
-					if(playerOrigin.x < (screenBounds.x/2) - 9) {
-						intro_mikeStafeDir = 1;
-					}else if(playerOrigin.x > (screenBounds.x/2) + 9){
-						intro_mikeStafeDir = -1;
+					if(player->origin.x < (screenBounds.x/2) - 9) {
+						script->introStrafeDir = 1;
+					}else if(player->origin.x > (screenBounds.x/2) + 9){
+						script->introStrafeDir = -1;
 					}
 
 					break;
 				case INTRO_BATTLE_MIKE_DEPART_CUE:
 					play("warp.wav");
-					forcedFrame = "mike-01.png";
+					player->forcedFrame = ASSET_MIKE_01;
 					break;
 				case INTRO_BATTLE_MIKE_DEPART:
-					playerOrigin.y -= 4.0;
+					player->origin.y -= 4.0;
 					break;
 			}
 			break;
 
 		case STATE_TITLE:
-			switch(scriptStatus.sceneNumber) {
+			switch(script->status.sceneNumber) {
 				case TITLE_CUE:
 					//General initialisation
-					resetPew();
-					resetPlayer();
-					resetEnemies();
-					resetBackground();
-					resetItems();
-					resetHud();
-					useMike = true;
+					resetPew(game);
+					resetPlayer(game);
+					resetEnemies(game);
+					resetBackground(game);
+					resetItems(game);
+					resetHud(game);
+					player->useMike = true;
 //					staticBackground = true;
-					game_messageTime = clock();
-					title_logoLocation = makeCoord((screenBounds.x/2) - 3, screenBounds.y/4);
-					title_logoSprite = makeSprite(getTexture("title.png"), zeroCoord(), SDL_FLIP_NONE);
-					showBackground = true;
+					script->messageTime = gameTime(game);
+					script->titleLogoLocation = makeCoord((screenBounds.x/2) - 3, screenBounds.y/4);
+					game->background.showBackground = true;
 
 					//Enemy roll call.
 					int spacer = -10;
 					EnemyType roll[] = { ENEMY_BUG, ENEMY_DISK, ENEMY_VIRUS, ENEMY_MAGNET, ENEMY_CD };
 					for(int i=0; i < sizeof(roll) / sizeof(EnemyType); i++) {
-						spawnEnemy(spacer += 40, 135, roll[i], PATTERN_CIRCLE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
+						spawnEnemy(game, spacer += 40, 135, roll[i], PATTERN_CIRCLE, COMBAT_IDLE, 0, 0, 0, HEALTH_LIGHT, 0, 0);
 					}
 
 					playMusic("title.ogg", 1);
 					break;
 				case TITLE_LOOP:
 					//Begin game when fire button is pressed.
-					if(checkCommand(CMD_PLAYER_FIRE)) {
-//						insertCoin();
-						triggerState(STATE_COIN);
+					if(checkCommand(game, CMD_PLAYER_FIRE)) {
+//						insertCoin(game);
+						triggerState(game, STATE_COIN);
 					}
 					break;
 			}
 			break;
 
 		case STATE_GAME:
-			if(!sceneInitialised()) {
-				resetPlayer();
-				resetEnemies();
-				resetLevel();
-				resetBackground();
-				resetItems();
+			if(!sceneInitialised(game)) {
+				resetPlayer(game);
+				resetEnemies(game);
+				resetLevel(game);
+				resetBackground(game);
+				resetItems(game);
 				hudReset();
-				useMike = true;
+				player->useMike = true;
 				playMusic("level-01c.ogg", -1);
-				runLevel();
+				runLevel(game);
 			}
 			//Skip to titlescreen if fire button pressed.
-			if(checkCommand(CMD_PLAYER_SKIP_TO_TITLE)) {
-				triggerState(STATE_TITLE);
+			if(checkCommand(game, CMD_PLAYER_SKIP_TO_TITLE)) {
+				triggerState(game, STATE_TITLE);
 			}
 			break;
 	}
 
-	endOfFrameTransition();
+	endOfFrameTransition(game);
 }
 
-void superFrame() {
-	for(int i = 0; i < playerOrigin.y + 10; i += 8) {
-		SDL_Texture *superTex = getTextureVersion("mike-01.png", ASSET_SUPER);
-		Sprite superSprite = makeSprite(superTex, zeroCoord(), SDL_FLIP_NONE);
-		drawSpriteAbs(superSprite, deriveCoord(playerOrigin, 0, i));
+void superFrame(const GameContext *game) {
+	Sprite superSprite = makeHandleSprite(ASSET_MIKE_01, ASSET_SUPER);
+	for(int i = 0; i < game->player.origin.y + 10; i += 8) {
+		drawSpriteAbs(superSprite, deriveCoord(game->player.origin, 0, i));
 	}
 }
 
-void scriptRenderFrame() {
+void scriptRenderFrame(GameContext *game) {
+	ScriptContext *script = &game->script;
+
 
 	//Only ever ensure we process a scripted render frame if the script itself has been initialised.
 	// e.g. If we got here from a user-initiated state change which has not yet been initialised, then skip
 	// rendering until this has taken place. We may rely on game-specific stuff to do our rendering, such as
 	// logo loading.
 
-	if(!stateInitialised) return;
+	if(!game->stateInitialised) return;
 
-	switch(gameState) {
+	switch(game->state) {
 		case STATE_GAME_OVER: {
-			switch(scriptStatus.sceneNumber) {
+			switch(script->status.sceneNumber) {
 				case 0: {
-					Sprite gameOver = makeSprite(getTexture("game-over.png"), zeroCoord(), SDL_FLIP_NONE);
+					Sprite gameOver = makeHandleSprite(ASSET_GAME_OVER, ASSET_DEFAULT);
 					drawSpriteAbs(gameOver, makeCoord(screenBounds.x/2 - 3, 98));
 					break;
 				}
 				case 1:
-					triggerState(STATE_TITLE);
+					triggerState(game, STATE_TITLE);
 					break;
 			}
 			break;
 		}
 		case STATE_LEVEL_COMPLETE:
-			switch(scriptStatus.sceneNumber) {
+			switch(script->status.sceneNumber) {
 				case END_WARP:
-					superFrame();
+					superFrame(game);
 					break;
 			}
 			break;
 		case STATE_INTRO:
-			switch(scriptStatus.sceneNumber) {
+			switch(script->status.sceneNumber) {
 				//Show "Les Miskin presents"
 				case INTRO_LOGO: {
-					Sprite presents = makeSprite(getTexture("lm-presents.png"), zeroCoord(), SDL_FLIP_NONE);
+					Sprite presents = makeHandleSprite(ASSET_LM_PRESENTS, ASSET_DEFAULT);
 					drawSpriteAbs(presents, /*step*/makeCoord(screenBounds.x/2 - 3, 98));
 					break;
 				}
 				//Add special blue trailing shadows to Mike as he flies off.
 				case INTRO_BATTLE_MIKE_DEPART: {
-					superFrame();
+					superFrame(game);
 					break;
 				}
 			}
@@ -287,23 +283,23 @@ void scriptRenderFrame() {
 			break;
 
 		case STATE_TITLE:
-			switch(scriptStatus.sceneNumber) {
+			switch(script->status.sceneNumber) {
 				case TITLE_LOOP:
 					//Draw the game logo.
 
-					drawSpriteAbs(title_logoSprite, title_logoLocation);
+					drawSpriteAbs(makeHandleSprite(ASSET_TITLE, ASSET_DEFAULT), script->titleLogoLocation);
 					break;
 			}
 			break;
 
 		case STATE_GAME:
 			//Show level entry message.
-			if(game_showLevelMessage) {
-				if(!timer(&game_messageTime, toMilliseconds(GAME_MESSAGE_DURATION))) {
-					Sprite levelSprite = makeSprite(getTexture("level-1.png"), zeroCoord(), SDL_FLIP_NONE);
+			if(script->showLevelMessage) {
+				if(!timer(game, &script->messageTime, toMilliseconds(GAME_MESSAGE_DURATION))) {
+					Sprite levelSprite = makeHandleSprite(ASSET_LEVEL_1, ASSET_DEFAULT);
 					drawSpriteAbs(levelSprite, makeCoord((screenBounds.x / 2) - 3, 100));
 				} else {
-					game_showLevelMessage = false;
+					script->showLevelMessage = false;
 				}
 			}
 			break;
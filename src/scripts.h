@@ -1,8 +1,19 @@
 #ifndef SCRIPTS_H
 #define SCRIPTS_H
 
-extern void scriptGameFrame();
-extern void scriptRenderFrame();
+#include "scripting.h"
+
+//Scene progress, plus the script-specific vars a few of the states keep between frames.
+typedef struct {
+	ScriptStatus status;
+	char introStrafeDir;
+	Coord titleLogoLocation;
+	bool showLevelMessage;
+	long messageTime;
+} ScriptContext;
+
+extern void scriptGameFrame(GameContext *game);
+extern void scriptRenderFrame(GameContext *game);
 extern void initScripts();
 
 #endif
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include "trace.h"
+#include "mysdl.h"
+#include "myc.h"
+
+//Events are appended to a buffer owned by the thread recording them, so recording never takes a
+// lock: a thread claims a buffer slot once (atomically), then only it ever writes there. Buffers
+// grow in chunks, and everything is written out as JSON on shutdown, once other threads are done.
+
+#define MAX_TRACE_THREADS 32
+#define TRACE_CHUNK_EVENTS 16384
+
+typedef struct {
+	const char *name;
+	const char *argName;		//NULL if the event has no argument.
+	int value;
+	char phase;					//'B'egin, 'E'nd or 'i'nstant, as in the trace-event format.
+	Uint64 time;
+} TraceEvent;
+
+typedef struct TraceChunk {
+	TraceEvent events[TRACE_CHUNK_EVENTS];
+	int count;
+	struct TraceChunk *next;
+} TraceChunk;
+
+typedef struct {
+	TraceChunk *first;
+	TraceChunk *last;
+} TraceBuffer;
+
+static bool tracing;
+static char *tracePath;
+static Uint64 frequency;
+static Uint64 traceStart;
+static TraceBuffer buffers[MAX_TRACE_THREADS];
+static SDL_atomic_t bufferCount;
+static _Thread_local TraceBuffer *threadBuffer;
+
+static TraceBuffer *getThreadBuffer();
+
+//Call once, from the main thread, before any other threads start.
+void startTrace(const char *path) {
+	tracePath = SDL_strdup(path);
+	frequency = SDL_GetPerformanceFrequency();
+	traceStart = SDL_GetPerformanceCounter();
+	SDL_AtomicSet(&bufferCount, 0);
+	tracing = true;
+
+	//Claim the first buffer, so the main thread is always thread 0 in the trace.
+	getThreadBuffer();
+}
+
+bool isTracing() {
+	return tracing;
+}
+
+//This thread's buffer, claiming one the first time. Threads past the limit go unrecorded.
+static TraceBuffer *getThreadBuffer() {
+	if(threadBuffer != NULL) return threadBuffer;
+
+	int slot = SDL_AtomicAdd(&bufferCount, 1);
+	if(slot >= MAX_TRACE_THREADS) return NULL;
+
+	threadBuffer = &buffers[slot];
+	return threadBuffer;
+}
+
+static void record(const char *name, char phase, const char *argName, int value) {
+	if(!tracing) return;
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	TraceBuffer *buffer = getThreadBuffer();
+	if(buffer == NULL) return;
+
+	if(buffer->last == NULL || buffer->last->count == TRACE_CHUNK_EVENTS) {
+		TraceChunk *chunk = malloc(sizeof(TraceChunk));
+		if(chunk == NULL) return;
+		chunk->count = 0;
+		chunk->next = NULL;
+
+		if(buffer->last == NULL) {
+			buffer->first = chunk;
+		}else{
+			buffer->last->next = chunk;
+		}
+		buffer->last = chunk;
+	}
+
+	TraceEvent event = { name, argName, value, phase, now };
+	buffer->last->events[buffer->last->count++] = event;
+}
+
+void traceBegin(const char *name) {
+	record(name, 'B', NULL, 0);
+}
+
+void traceEnd(const char *name) {
+	record(name, 'E', NULL, 0);
+}
+
+//Marks a moment (a spawn, a state change) on the timeline, optionally with a value to show with it.
+void traceInstant(const char *name, const char *argName, int value) {
+	record(name, 'i', argName, value);
+}
+
+//Names come from our own literals, but escape them anyway so the file always parses.
+static void writeString(FILE *file, const char *text) {
+	fputc('"', file);
+	for(; *text != '\0'; text++) {
+		if(*text == '"' || *text == '\\') fputc('\\', file);
+		if((unsigned char)*text >= 0x20) fputc(*text, file);
+	}
+	fputc('"', file);
+}
+
+static void writeEvent(FILE *file, const TraceEvent *event, int thread) {
+	fputs(",\n", file);
+	fputs("{\"name\":", file);
+	writeString(file, event->name);
+	fprintf(file, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+			event->phase, (event->time - traceStart) * 1000000.0 / frequency, thread);
+
+	//Instants are scoped to their thread, rather than drawn across the whole process.
+	if(event->phase == 'i') fputs(",\"s\":\"t\"", file);
+	if(event->argName != NULL) {
+		fputs(",\"args\":{", file);
+		writeString(file, event->argName);
+		fprintf(file, ":%d}", event->value);
+	}
+	fputc('}', file);
+}
+
+static void writeTrace() {
+	FILE *file = fopen(tracePath, "w");
+	if(file == NULL) {
+		SDL_Log("Could not write trace to %s.", tracePath);
+		return;
+	}
+
+	int threads = SDL_AtomicGet(&bufferCount);
+	if(threads > MAX_TRACE_THREADS) threads = MAX_TRACE_THREADS;
+
+	long written = 0;
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+	for(int t=0; t < threads; t++) {
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+				t == 0 ? "\n" : ",\n", t, t == 0 ? "main" : "worker", t);
+	}
+	for(int t=0; t < threads; t++) {
+		for(TraceChunk *chunk = buffers[t].first; chunk != NULL; chunk = chunk->next) {
+			for(int i=0; i < chunk->count; i++) {
+				writeEvent(file, &chunk->events[i], t);
+				written++;
+			}
+		}
+	}
+	fputs("\n]}\n", file);
+
+	if(fclose(file) != 0) {
+		SDL_Log("Could not finish writing trace to %s.", tracePath);
+	}else{
+		SDL_Log("Wrote %ld trace events to %s.", written, tracePath);
+	}
+}
+
+//Writes the trace out. Other threads must have finished recording by now.
+void shutdownTrace() {
+	if(!tracing) return;
+	tracing = false;
+
+	writeTrace();
+
+	for(int t=0; t < MAX_TRACE_THREADS; t++) {
+		TraceChunk *chunk = buffers[t].first;
+		while(chunk != NULL) {
+			TraceChunk *next = chunk->next;
+			free(chunk);
+			chunk = next;
+		}
+		buffers[t].first = buffers[t].last = NULL;
+	}
+	SDL_free(tracePath);
+	tracePath = NULL;
+}
@@ -0,0 +1,15 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+
+//Chrome trace-event recording (--trace out.json), for opening a run in chrome://tracing or Perfetto.
+// Event names must be string literals (or otherwise outlive the run), since only the pointer is kept.
+extern void startTrace(const char *path);
+extern void shutdownTrace();
+extern bool isTracing();
+extern void traceBegin(const char *name);
+extern void traceEnd(const char *name);
+extern void traceInstant(const char *name, const char *argName, int value);
+
+#endif
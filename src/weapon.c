@@ -1,339 +1,404 @@
 #include <time.h>
+#include <math.h>
 #include "renderer.h"
 #include "player.h"
 #include "assets.h"
+#include "animation.h"
 #include "enemy.h"
 #include "mysdl.h"
 #include "weapon.h"
 #include "input.h"
 #include "sound.h"
 #include "hud.h"
+#include "game.h"
 #include "myc.h"
 
-#define MAX_SHOTS 20
-
-typedef enum {
-	NORTH,
-	NORTH_EAST,
-	EAST,
-	SOUTH_EAST,
-	SOUTH,
-	SOUTH_WEST,
-	WEST,
-	NORTH_WEST,
-} ShotDir;
+#define MAX_WEAPON_EMITTERS 16
 
+//Where one of a weapon's shots starts from and where it heads (see weapons.csv).
+typedef struct {
+	int volley;
+	Coord offset;			//from the player's origin.
+	Coord velocity;			//pixels per game step.
+	double angle;			//worked out once from the velocity, as the shot's sprite rotation.
+	const AnimationClip *clip;
+} WeaponEmitter;
+
+//A continuous ray from the player, cast every game step while fire's held.
 typedef struct {
-	double speed;
-	Coord coord;
-	int animFrame;
-	ShotDir direction;
-	double angle;
-} Shot;
-
-typedef enum {
-	SPEED_NORMAL = 1000 / 12,
-	SPEED_FAST = 1000 / 14,
-} WeaponSpeed;
-
-typedef enum {
-	PATTERN_MINI = 0,
-	PATTERN_MINI_2 = 1,
-	PATTERN_SINGLE = 2,
-	PATTERN_DUAL = 3,
-	PATTERN_TRIAD = 4,
-	PATTERN_FAN = 5,
-} WeaponPattern;
+	Coord offset;			//from the player's origin.
+	Coord direction;		//unit length.
+	double angle;			//as a shot's, for the sprites drawn along it.
+	double damage;			//per volley, to each enemy it strikes.
+	bool piercing;			//strikes everything along it, rather than stopping at the first.
+	const AnimationClip *clip;
+} WeaponBeam;
 
 typedef struct {
-	WeaponSpeed speed;
-	WeaponPattern pattern;
+	double rate;			//milliseconds between volleys, as timer() takes it.
+	int volleyCount;
+	int emitterCount;
+	WeaponEmitter emitters[MAX_WEAPON_EMITTERS];
+	bool hasBeam;
+	WeaponBeam beam;
 } Weapon;
 
-bool canFireInLevel = false;
-int weaponInc = 0;
+//Loaded once at startup, and only read from after, so every game can share them (see --threads).
 static Weapon weapons[MAX_WEAPONS];
-//static const int SHOT_HZ = 1000 / 11 ;
-static const double SHOT_SPEED = 7;
+static int weaponCount;
+static char *WEAPONS_FILE = "weapons.csv";
 static const double SHOT_DAMAGE = 0.7;
-static Shot shots[MAX_SHOTS];
-static int shotInc = 0;
-static Sprite shotSprite;
-static long lastShotTime;
-static int maxFrames = 2;
-
-static short minigunLastSide = 0;
-
-//Used for checking whether Shot is valid in array.
-static bool invalidShot(Shot *shot) {
-	return
-			shot->speed == 0 ||				//was never set (i.e. when all are NULL at start of game)
-			!inScreenBounds(shot->coord);	//if out of range in any screen boundary (important for diag and fan patterns).
-}
+static const double BEAM_REACH = 340;		//the screen's diagonal, so it always gets to the edge.
 
-static Shot nullShot() {
-	Shot shot = { };
-	return shot;
+//Whether a live shot has left the screen (and should be let go of).
+static bool invalidShot(const Shot *shot) {
+	return !inScreenBounds(shot->coord);	//if out of range in any screen boundary (important for diag and fan patterns).
 }
 
-static void spawnPew(int xOffset, int yOffset, ShotDir direction) {
-	//Set angle based on direction
-	double angle = 0;
-	switch(direction) {
-		case NORTH_EAST:
-			angle = 45;
-			break;
-		case EAST:
-			angle = 90;
-			break;
-		case SOUTH_EAST:
-			angle = 135;
-			break;
-		case SOUTH:
-			angle = 180;
-			break;
-		case SOUTH_WEST:
-			angle = 215;
-			break;
-		case WEST:
-			angle = 270;
-			break;
-		case NORTH_WEST:
-			angle = 315;
-			break;
-	}
+static void spawnPew(GameContext *game, const WeaponEmitter *emitter) {
+	WeaponContext *weapon = &game->weapon;
+	int slot = acquireSlot(&weapon->shotPool);
+	if(slot < 0) return;
 
-	//Make the shot.
+	//Make the shot, already facing where it's headed.
 	Shot shot = {
-		SHOT_SPEED,
-		deriveCoord(playerOrigin, xOffset, yOffset),
-		1,
-		direction,
-		angle
+		addCoords(game->player.origin, emitter->offset),
+		emitter->velocity,
+		emitter->angle,
+		emitter->clip,
+		1
 	};
-
-    //Ensure we stick within the bounds of our Shot array.
-    shotInc = shotInc+1 == MAX_SHOTS ? 0 : shotInc + 1;
+	shot.lastCoord = shot.coord;
 
     //Add to the shot list.
-	shots[shotInc] = shot;
+	weapon->shots[slot] = shot;
 }
 
-bool atMaxWeapon() {
-	return weaponInc + 1 == MAX_WEAPONS;
+bool atMaxWeapon(const GameContext *game) {
+	return game->weapon.weaponInc + 1 == MAX_WEAPONS;
 }
 
-void changeWeapon(int newWeapon) {
+void changeWeapon(GameContext *game, int newWeapon) {
 	//This is the 'official' place to change the weapon, since we trigger things like the HUD sweep here.
 
 	//Don't change if the same.
-	if(newWeapon == weaponInc) return;
+	if(newWeapon == game->weapon.weaponInc) return;
 
-	weaponInc = newWeapon;
+	game->weapon.weaponInc = newWeapon;
 }
 
-void upgradeWeapon() {
-	if(atMaxWeapon()) return;
-	changeWeapon(weaponInc+1);
+void upgradeWeapon(GameContext *game) {
+	if(atMaxWeapon(game)) return;
+	changeWeapon(game, game->weapon.weaponInc+1);
 }
 
-void pew() {
+void pew(GameContext *game) {
+	WeaponContext *weapon = &game->weapon;
+	const Weapon *current = &weapons[weapon->weaponInc];
+	bool canFire = weapon->canFireInLevel || game->state == STATE_INTRO;
+
+	//Beams stay on for as long as fire's held, whatever the rate (pewGameFrame casts them).
+	if(canFire && current->hasBeam) weapon->beaming = true;
+
 	//Rate-limiter, and preventing initial shots post-menu.
-	if(!timer(&lastShotTime, weapons[weaponInc].speed))
+	if(!timer(game, &weapon->lastShotTime, current->rate))
 		return;
-	if(!canFireInLevel && gameState != STATE_INTRO)
+	if(!canFire)
 		return;
 
 //	SDL_HapticRumblePlay(haptic, 0.4, 100);
 	play("Laser_Shoot18.wav");
 
-	//The different shot patterns, based on our current weapon.
-	switch(weapons[weaponInc].pattern) {
-		case PATTERN_SINGLE:
-			spawnPew(-1, -5, NORTH);
-			break;
-		case PATTERN_DUAL:
-			spawnPew(2, -5, NORTH);
-			spawnPew(-4, -5, NORTH);
-			break;
-		case PATTERN_TRIAD:
-			spawnPew(-1, -5, NORTH);
-			spawnPew(-3, -2, NORTH_EAST);
-			spawnPew(1, -2, NORTH_WEST);
-			break;
-		case PATTERN_MINI:
-			if(minigunLastSide == 0) {
-				spawnPew(-2, -5, NORTH);
-				minigunLastSide = 1;
-			}else{
-				spawnPew(2, -5, NORTH);
-				minigunLastSide = 0;
-			}
-			break;
-		case PATTERN_MINI_2:
-			switch(minigunLastSide) {
-				case 0:
-					spawnPew(-6, -5, NORTH);
-					minigunLastSide = 1;
-					break;
-				case 1:
-					spawnPew(0, -5, NORTH);
-					minigunLastSide = 2;
-					break;
-				case 2:
-					spawnPew(6, -5, NORTH);
-					minigunLastSide = 3;
-					break;
-				case 3:
-					spawnPew(0, -5, NORTH);
-					minigunLastSide = 0;
-					break;
-			}
-			break;
-		case PATTERN_FAN:
-            spawnPew(-1, -5, NORTH);
-            spawnPew(-1, -2, NORTH_EAST);
-            spawnPew(-1, 0, EAST);
-            spawnPew(-1, 2, SOUTH_EAST);
-            spawnPew(-1, 2, SOUTH);
-            spawnPew(1, 2, SOUTH_WEST);
-            spawnPew(5, 0, WEST);
-            spawnPew(1, -2, NORTH_WEST);
-			break;
+	//Fire every emitter in this volley, then move on to the next (for weapons that alternate).
+	int volley = weapon->nextVolley % current->volleyCount;
+	for(int e=0; e < current->emitterCount; e++) {
+		if(current->emitters[e].volley == volley) spawnPew(game, &current->emitters[e]);
 	}
+	weapon->nextVolley = volley + 1;
+	weapon->beamStrikes = current->hasBeam;
 }
 
-void pewGameFrame() {
-	for(int i=0; i < MAX_SHOTS; i++) {
-		//Skip zeroed shots.
-		if (invalidShot(&shots[i])) continue;
-
-		//Toggle hit animation on enemies if within range.
-		for(int p=0; p < MAX_ENEMIES; p++) {
-			//Skip if the enemy is already dying.
-            if(invalidEnemy(&enemies[p]) || enemies[p].dying) continue;
-
-			//If he's within our projectile bounds.
-			Rect enemyBound;
-			if(enemies[p].type == ENEMY_BOSS) {  //HACK!
-				enemyBound = makeBounds(enemies[p].parallax, 72, 32);
-			}else{
-				enemyBound = makeSquareBounds(enemies[p].parallax, ENEMY_BOUND);
-			}
+int countShots(const GameContext *game) {
+	return game->weapon.shotPool.count;
+}
+
+void pewSavePositions(GameContext *game) {
+	Shot *shots = game->weapon.shots;
+	FOR_EACH_SLOT(&game->weapon.shotPool, i) {
+		shots[i].lastCoord = shots[i].coord;
+	}
+}
 
-			if(inBounds(shots[i].coord, enemyBound) && !enemies[p].nonInteractive) {
-				hitEnemy(&enemies[p], SHOT_DAMAGE, false);
+//Drops enemies that are gone, dying or can't be hit from the list, returning how many are left.
+static int beamTargets(const GameContext *game, int *slots, int count) {
+	int kept = 0;
+	for(int n=0; n < count; n++) {
+		int p = slots[n];
+		if(!isSlotActive(&game->enemy.enemyPool, p) || invalidEnemy(game, p) || game->enemy.motion.dying[p] || game->enemy.enemies[p].nonInteractive) continue;
+		slots[kept++] = p;
+	}
+	return kept;
+}
 
-				//Set shot as null, and cancel out of this loop (since this shot is now finished with).
-				shots[i] = nullShot();
-				break;
+//Finds how far the beam gets, striking what it meets if it's due to. Only enemies filed under the
+// cells it crosses are tested, against their collision boxes.
+static void castBeam(GameContext *game, const WeaponBeam *beam) {
+	WeaponContext *weapon = &game->weapon;
+	Grid *grid = &game->enemy.grid;
+	const EnemyMotion *motion = &game->enemy.motion;
+	Coord origin = addCoords(game->player.origin, beam->offset);
+
+	RayHit hits[MAX_ENEMIES];
+	int hitCount = 0;
+
+	if(beam->piercing) {
+		//Everything along it, so every cell it crosses (each enemy listed once, however many it's under).
+		int nearby[MAX_ENEMIES];
+		int nearbyCount = beamTargets(game, nearby, slotsAlongRay(grid, origin, beam->direction, BEAM_REACH, nearby));
+		hitCount = raycastEnemies(motion, nearby, nearbyCount, origin, beam->direction, BEAM_REACH, hits, MAX_ENEMIES);
+	}else{
+		//A cell at a time from the player, until something's met within the cells so far.
+		GridRay ray = startGridRay(origin, beam->direction, BEAM_REACH);
+		int nearby[MAX_ENEMIES];
+		int nearbyCount;
+
+		while((nearbyCount = nextRayCell(grid, &ray, nearby)) >= 0) {
+			RayHit hit;
+			nearbyCount = beamTargets(game, nearby, nearbyCount);
+			if(raycastEnemies(motion, nearby, nearbyCount, origin, beam->direction, BEAM_REACH, &hit, 1) > 0 &&
+			   (hitCount == 0 || hit.distance < hits[0].distance)) {
+				hits[0] = hit;
+				hitCount = 1;
 			}
+
+			if(hitCount > 0 && hits[0].distance <= ray.reached) break;
 		}
+	}
 
-		//If we left the above loop early (e.g. hit something) continue onto the next shot.
-		if(invalidShot(&shots[i])) {
+	if(weapon->beamStrikes) {
+		for(int h=0; h < hitCount; h++) hitEnemy(game, hits[h].slot, beam->damage, false);
+	}
+
+	weapon->beamOrigin = origin;
+	weapon->beamLength = hitCount > 0 && !beam->piercing ? hits[0].distance : BEAM_REACH;
+}
+
+void pewGameFrame(GameContext *game) {
+	Shot *shots = game->weapon.shots;
+	const Enemy *enemies = game->enemy.enemies;
+	const EnemyMotion *motion = &game->enemy.motion;
+
+	FOR_EACH_SLOT(&game->weapon.shotPool, i) {
+		//Let go of shots that have left the screen.
+		if (invalidShot(&shots[i])) {
+			releaseSlot(&game->weapon.shotPool, i);
 			continue;
 		}
 
-		//If we haven't hit anything - adjust shot for velocity and heading.
-		switch(shots[i].direction) {
-			case NORTH:
-				shots[i].coord = deriveCoord(shots[i].coord, 0, -shots[i].speed);
-				break;
-			case SOUTH:
-				shots[i].coord = deriveCoord(shots[i].coord, 0, shots[i].speed);
-				shots[i].angle = 180;
-				break;
-			case EAST:
-				shots[i].coord = deriveCoord(shots[i].coord, +shots[i].speed, 0);
-				shots[i].angle = 90;
-				break;
-			case WEST:
-				shots[i].coord = deriveCoord(shots[i].coord, -shots[i].speed, 0);
-				shots[i].angle = 270;
-				break;
-			case NORTH_EAST:
-				shots[i].coord = deriveCoord(shots[i].coord, shots[i].speed, -shots[i].speed);
-				shots[i].angle = 45;
-				break;
-			case NORTH_WEST:
-				shots[i].coord = deriveCoord(shots[i].coord, -shots[i].speed, -shots[i].speed);
-				shots[i].angle = 315;
-				break;
-			case SOUTH_EAST:
-				shots[i].angle = 135;
-				shots[i].coord = deriveCoord(shots[i].coord, shots[i].speed, shots[i].speed);
-				break;
-			case SOUTH_WEST:
-				shots[i].angle = 225;
-				shots[i].coord = deriveCoord(shots[i].coord, -shots[i].speed, shots[i].speed);
+		//Toggle hit animation on enemies if within range (only those filed under the cells the shot's
+		// solid pixels cover can be). The bolt's pixels are tested unrotated - it's small enough for
+		// the turn on sideways and diagonal shots not to matter.
+		const Mask *shotMask = clipFrameMask(shots[i].clip, shots[i].animFrame);
+		int nearby[MAX_ENEMIES];
+		int nearbyCount = slotsNear(&game->enemy.grid, maskBounds(shotMask, shots[i].coord), nearby);
+
+		for(int n=0; n < nearbyCount; n++) {
+			int p = nearby[n];
+
+			//Skip if the enemy is gone, or already dying.
+            if(!isSlotActive(&game->enemy.enemyPool, p) || invalidEnemy(game, p) || motion->dying[p]) continue;
+
+			//If its solid pixels meet the shot's (which rules out boxes that don't overlap first).
+			if(!enemies[p].nonInteractive && masksOverlap(shotMask, shots[i].coord, enemyMask(game, p), motion->parallax[p])) {
+				hitEnemy(game, p, SHOT_DAMAGE, false);
+
+				//Let the shot go, and cancel out of this loop (since this shot is now finished with).
+				releaseSlot(&game->weapon.shotPool, i);
 				break;
+			}
 		}
 	}
-}
 
-void pewShadowFrame() {
-	//Draw the shadows first (so we don't shadow on top of other shots)
-	for(int i=0; i < MAX_SHOTS; i++) {
-		//Skip zeroed.
-		if (invalidShot(&shots[i])) continue;
+	//Everything still flying carries on along its velocity.
+	FOR_EACH_SLOT(&game->weapon.shotPool, i) {
+		shots[i].coord = addCoords(shots[i].coord, shots[i].velocity);
+	}
 
-		//Choose frame.
-		char frameFile[20];
-		sprintf(frameFile, "shot-neon-%02d.png", shots[i].animFrame);
-		SDL_Texture *shotShadowTexture = getTextureVersion(frameFile, ASSET_SHADOW);
+	//The beam's only on for steps fire was held in.
+	const Weapon *current = &weapons[game->weapon.weaponInc];
+	game->weapon.beamLength = 0;
+	if(game->weapon.beaming && current->hasBeam) castBeam(game, &current->beam);
+	game->weapon.beaming = false;
+	game->weapon.beamStrikes = false;
+}
+
+void pewShadowFrame(GameContext *game) {
+	const Shot *shots = game->weapon.shots;
 
+	//Draw the shadows first (so we don't shadow on top of other shots)
+	FOR_EACH_SLOT_IN_ORDER(&game->weapon.shotPool, i) {
 		//Shadow.
-		Sprite shotShadow = makeSprite(shotShadowTexture, zeroCoord(), SDL_FLIP_NONE);
-		Coord shadowCoord = parallax(shots[i].coord, PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
+		const Sprite *shotShadow = clipFrame(shots[i].clip, shots[i].animFrame, ASSET_SHADOW);
+		Coord shadowCoord = parallax(game, interpolate(shots[i].lastCoord, shots[i].coord), PARALLAX_SUN, PARALLAX_LAYER_SHADOW, PARALLAX_X, PARALLAX_SUBTRACTIVE);
 		shadowCoord.y += STATIC_SHADOW_OFFSET;
-		drawSpriteAbsRotated(shotShadow, shadowCoord, shots[i].angle);
+		drawSpriteAbsRotated(*shotShadow, shadowCoord, shots[i].angle);
 	}
 }
 
-void pewRenderFrame() {
-	//We loop through the projectile array, drawing any shots that are still initialised.
-	for(int i=0; i < MAX_SHOTS; i++) {
-		//Skip zeroed.
-		if(invalidShot(&shots[i])) continue;
+//Beams are drawn as their clip's sprites laid end to end along them, off the screen edge or up to
+// the enemy that stopped them.
+static void drawBeam(const GameContext *game) {
+	const WeaponContext *weapon = &game->weapon;
+	const Weapon *current = &weapons[weapon->weaponInc];
+	if(weapon->beamLength <= 0 || !current->hasBeam) return;
+
+	const WeaponBeam *beam = &current->beam;
+	const Sprite *sprite = clipFrame(beam->clip, weapon->beamFrame % beam->clip->frameCount + 1, ASSET_DEFAULT);
+	double spacing = sprite->size.y;
+
+	for(double along = spacing / 2; along < weapon->beamLength; along += spacing) {
+		Coord at = deriveCoord(weapon->beamOrigin, beam->direction.x * along, beam->direction.y * along);
+		if(!inScreenBounds(at)) break;
+		drawSpriteAbsRotated(*sprite, at, beam->angle);
+	}
+}
 
-		//Choose frame.
-		char frameFile[20];
-		sprintf(frameFile, "shot-neon-%02d.png", shots[i].animFrame);
-		SDL_Texture *shotTexture = getTexture(frameFile);
+void pewRenderFrame(GameContext *game) {
+	const Shot *shots = game->weapon.shots;
 
+	//We loop through the live shots, drawing each.
+	FOR_EACH_SLOT_IN_ORDER(&game->weapon.shotPool, i) {
 		//Shot itself.
-		shotSprite = makeSprite(shotTexture, zeroCoord(), SDL_FLIP_NONE);
-		drawSpriteAbsRotated(shotSprite, shots[i].coord, shots[i].angle);
+		const Sprite *shotSprite = clipFrame(shots[i].clip, shots[i].animFrame, ASSET_DEFAULT);
+		drawSpriteAbsRotated(*shotSprite, interpolate(shots[i].lastCoord, shots[i].coord), shots[i].angle);
 	}
+
+	drawBeam(game);
 }
 
-void pewAnimateFrame(){
-	for(int i=0; i < MAX_SHOTS; i++) {
-		if(invalidShot(&shots[i])) continue;
-		if(shots[i].animFrame == maxFrames) shots[i].animFrame = 0;
+void pewAnimateFrame(GameContext *game){
+	Shot *shots = game->weapon.shots;
+
+	FOR_EACH_SLOT(&game->weapon.shotPool, i) {
+		if(shots[i].animFrame == shots[i].clip->frameCount) shots[i].animFrame = 0;
 		shots[i].animFrame++;
 	}
+
+	game->weapon.beamFrame++;
+}
+
+//Sprite rotation for a heading: clockwise degrees from north, as the shot art points.
+static double facingAngle(Coord velocity) {
+	double angle = atan2(velocity.x, -velocity.y) * 360 / RADIAN_CIRCLE;
+	return angle < 0 ? angle + 360 : angle;
+}
+
+static void badWeaponLine(const char *line) {
+	fatalError("Unrecognised weapon definition", line);
+	exit(1);
 }
 
-void pewInit() {
-	Weapon w1 = { SPEED_NORMAL, PATTERN_DUAL };
-//	Weapon w1 = { SPEED_FAST, PATTERN_MINI };
-	Weapon w2 = { SPEED_FAST, PATTERN_DUAL };
-	Weapon w3 = { SPEED_FAST, PATTERN_TRIAD };
-	Weapon w4 = { SPEED_FAST, PATTERN_FAN };
+static void readWeapon(const char *line) {
+	if(weaponCount == MAX_WEAPONS) badWeaponLine(line);
 
-	weapons[0] = w1;
-	weapons[1] = w2;
-	weapons[2] = w3;
-	weapons[3] = w4;
+	Weapon weapon = { };
+	if(sscanf(line, "WEAPON,%lf", &weapon.rate) != 1 || weapon.rate <= 0) badWeaponLine(line);
+
+	weapons[weaponCount++] = weapon;
+}
+
+static void readEmitter(const char *line) {
+	if(weaponCount == 0) badWeaponLine(line);
+	Weapon *weapon = &weapons[weaponCount - 1];
+	if(weapon->emitterCount == MAX_WEAPON_EMITTERS) badWeaponLine(line);
+
+	WeaponEmitter emitter;
+	char clipName[32];
+	int read = sscanf(line, "SHOT,%d,%lf,%lf,%lf,%lf,%31[^,\r\n]", &emitter.volley,
+			&emitter.offset.x, &emitter.offset.y, &emitter.velocity.x, &emitter.velocity.y, clipName);
+	if(read != 6 || emitter.volley < 0) badWeaponLine(line);
+
+	emitter.clip = findClip(clipName);
+	if(emitter.clip == NULL) badWeaponLine(line);
+	emitter.angle = facingAngle(emitter.velocity);
+
+	weapon->emitters[weapon->emitterCount++] = emitter;
+	if(emitter.volley >= weapon->volleyCount) weapon->volleyCount = emitter.volley + 1;
+}
+
+static void readBeam(const char *line) {
+	if(weaponCount == 0) badWeaponLine(line);
+	Weapon *weapon = &weapons[weaponCount - 1];
+	if(weapon->hasBeam) badWeaponLine(line);
+
+	WeaponBeam beam;
+	int piercing;
+	char clipName[32];
+	int read = sscanf(line, "BEAM,%lf,%lf,%lf,%lf,%lf,%d,%31[^,\r\n]", &beam.offset.x, &beam.offset.y,
+			&beam.direction.x, &beam.direction.y, &beam.damage, &piercing, clipName);
+	if(read != 7) badWeaponLine(line);
+
+	double length = hypot(beam.direction.x, beam.direction.y);
+	if(length == 0) badWeaponLine(line);
+
+	beam.clip = findClip(clipName);
+	if(beam.clip == NULL) badWeaponLine(line);
+	beam.direction.x /= length;
+	beam.direction.y /= length;
+	beam.angle = facingAngle(beam.direction);
+	beam.piercing = piercing != 0;
+
+	weapon->beam = beam;
+	weapon->hasBeam = true;
+	if(weapon->volleyCount == 0) weapon->volleyCount = 1;
+}
+
+//Reads weapons.csv into the weapon table. Needs the animation clips ready to name shot sprites.
+void loadWeapons() {
+	char *data = loadDataFile(WEAPONS_FILE);
+
+	for(char *line = strtok(data, "\r\n"); line != NULL; line = strtok(NULL, "\r\n")) {
+		// Skip commented-out lines.
+		if(line[0] == '#') continue;
+
+		if(strncmp(line, "WEAPON,", 7) == 0) {
+			readWeapon(line);
+		}else if(strncmp(line, "SHOT,", 5) == 0) {
+			readEmitter(line);
+		}else if(strncmp(line, "BEAM,", 5) == 0) {
+			readBeam(line);
+		}else{
+			badWeaponLine(line);
+		}
+	}
+
+	SDL_free(data);
+
+	//Every upgrade step needs something to fire.
+	bool complete = weaponCount == MAX_WEAPONS;
+	for(int w=0; w < weaponCount; w++) {
+		if(weapons[w].emitterCount == 0 && !weapons[w].hasBeam) complete = false;
+	}
+	if(!complete) {
+		fatalError("Every weapon needs defining, with at least one shot or beam", WEAPONS_FILE);
+		exit(1);
+	}
+}
 
-	resetPew();
+void pewInit(GameContext *game) {
+	initPool(&game->weapon.shotPool, "player shot", game->weapon.shotSlots, MAX_SHOTS);
+	resetPew(game);
 }
 
-void resetPew() {
-	for(int i=0; i < shotInc; i++) shots[i] = nullShot();
-	weaponInc = 0;
-	shotInc = 0;
-	canFireInLevel = false;
+void resetPew(GameContext *game) {
+	WeaponContext *weapon = &game->weapon;
+
+	clearPool(&weapon->shotPool);
+	weapon->weaponInc = 0;
+	weapon->nextVolley = 0;
+	weapon->beaming = false;
+	weapon->beamStrikes = false;
+	weapon->beamLength = 0;
+	weapon->beamFrame = 0;
+	weapon->canFireInLevel = false;
 }
\ No newline at end of file
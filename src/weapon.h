@@ -1,19 +1,50 @@
 #ifndef WEAPON_H
 #define WEAPON_H
 
+#include "common.h"
+#include "pool.h"
+#include "animation.h"
+
 #define MAX_WEAPONS 4
+#define MAX_SHOTS 64
+
+typedef struct {
+	Coord coord;
+	Coord velocity;			//pixels per game step, fixed when fired.
+	double angle;			//sprite rotation to face along the velocity (clockwise from north).
+	const AnimationClip *clip;
+	int animFrame;
+	Coord lastCoord;		//coord as of the previous game step.
+} Shot;
+
+//The player's weapon and shots in flight.
+typedef struct {
+	Shot shots[MAX_SHOTS];
+	Pool shotPool;
+	int shotSlots[POOL_STORAGE(MAX_SHOTS)];
+	int weaponInc;
+	bool canFireInLevel;
+	long lastShotTime;
+	int nextVolley;			//which of the weapon's volleys fires next.
+	bool beaming;			//fire's held on a beam weapon this step.
+	bool beamStrikes;		//and the beam's due to hurt what it meets (on the weapon's rate).
+	Coord beamOrigin;
+	double beamLength;		//as far as it got last step, or 0 while it's off.
+	int beamFrame;			//counts up, for whichever clip the beam has.
+} WeaponContext;
 
-extern bool canFireInLevel;
-extern int weaponInc;
-extern void changeWeapon(int newWeapon);
-extern bool atMaxWeapon();
-extern void upgradeWeapon();
-extern void pewGameFrame();
-extern void pewShadowFrame();
-extern void pewRenderFrame();
-extern void pewAnimateFrame();
-extern void pew();
-extern void pewInit();
-extern void resetPew();
+extern void changeWeapon(GameContext *game, int newWeapon);
+extern bool atMaxWeapon(const GameContext *game);
+extern void upgradeWeapon(GameContext *game);
+extern void pewGameFrame(GameContext *game);
+extern void pewSavePositions(GameContext *game);
+extern void pewShadowFrame(GameContext *game);
+extern void pewRenderFrame(GameContext *game);
+extern void pewAnimateFrame(GameContext *game);
+extern void pew(GameContext *game);
+extern void pewInit(GameContext *game);
+extern void loadWeapons();
+extern int countShots(const GameContext *game);
+extern void resetPew(GameContext *game);
 
-#endif
\ No newline at end of file
+#endif